@@ -0,0 +1,46 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/room_factory.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace room_explorer;
+
+/**
+ * Compiles room template JSON into a template pack, which GameEngine maps in place of parsing the JSON.
+ * Usage: template_pack_compiler template_path pack_path
+ */
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: template_pack_compiler template_path pack_path" << std::endl;
+    return 1;
+  }
+
+  std::ifstream template_file(argv[1]);
+  if (!template_file) {
+    std::cerr << "Cannot read " << argv[1] << std::endl;
+    return 1;
+  }
+  json template_json;
+  template_file >> template_json;
+  RoomFactory factory = template_json;
+
+  std::ofstream pack_file(argv[2], std::ios::binary);
+  factory.WritePack(pack_file);
+  if (!pack_file) {
+    std::cerr << "Cannot write " << argv[2] << std::endl;
+    return 1;
+  }
+
+  WallCleanupReport report{factory.GetWallCleanupReport()};
+  std::cout << "Compiled " << factory.RoomTemplateCount() << " templates into " << argv[2] << std::endl;
+  std::cout << "Kept " << report.OutputCount() << " of " << report.input_count_ << " walls. Removed "
+            << report.duplicate_count_ << " duplicate, " << report.merged_count_ << " joined, "
+            << report.degenerate_count_ << " degenerate and " << report.boundary_count_ << " boundary walls."
+            << std::endl;
+  return 0;
+}
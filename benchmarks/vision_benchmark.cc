@@ -0,0 +1,72 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/game_engine.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace room_explorer;
+
+namespace {
+
+// Default Benchmark Settings ==========================================================================================
+const char* kDefaultTemplatePath = "resources/room_templates/tight_map.json";
+
+const size_t kDefaultHalfResolution = 960; // Roughly 1920 strips, a full HD frame at 1 pixel per strip
+const size_t kDefaultFrameCount = 100;
+
+const float kHalfVisionField = 1.3f;
+const float kVisibleDistance = 550;
+const float kFrameRotation = 0.01f; // View is rotated every frame so that frames do not trace the same rays
+// End of Default Benchmark Settings ===================================================================================
+
+} // namespace
+
+/**
+ * Times GameEngine::GetVision over a number of frames on a given room template.
+ * Usage: rooms_explorer_benchmark [template_path] [half_resolution] [frame_count] [vision_threads] [schedule]
+ *    Schedule is "wavefront" or "packet".
+ */
+int main(int argc, char** argv) {
+  std::string template_path{argc > 1 ? argv[1] : kDefaultTemplatePath};
+  size_t half_resolution{argc > 2 ? std::strtoul(argv[2], nullptr, 10) : kDefaultHalfResolution};
+  size_t frame_count{argc > 3 ? std::strtoul(argv[3], nullptr, 10) : kDefaultFrameCount};
+  size_t vision_threads{argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1};
+  std::string schedule{argc > 5 ? argv[5] : "wavefront"};
+
+  GameEngine engine(template_path);
+  engine.SetVisionThreadCount(vision_threads);
+  engine.SetVisionSchedule(schedule == "packet" ? kPacketSchedule : kWavefrontSchedule);
+
+  size_t total_resolution{2 * half_resolution + 1};
+  float resolution_angle{2 * kHalfVisionField / total_resolution};
+  float resolution_cos{std::cos(resolution_angle)};
+  float resolution_sin{std::sin(resolution_angle)};
+
+  size_t total_hits{0}; // Accumulated so the work cannot be optimized away
+  FrameHitBuffer frame_hits; // Reused across frames, like the app does
+
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t frame = 0; frame < frame_count; ++frame) {
+    engine.GetVision(resolution_cos, resolution_sin, half_resolution, kVisibleDistance, frame_hits);
+    total_hits += frame_hits.HitCount();
+    engine.RotateDirection(std::cos(kFrameRotation), std::sin(kFrameRotation));
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double total_ms{std::chrono::duration<double, std::milli>(end - begin).count()};
+
+  std::cout << "template:    " << template_path << std::endl;
+  std::cout << "strips:      " << total_resolution << std::endl;
+  std::cout << "frames:      " << frame_count << std::endl;
+  std::cout << "threads:     " << engine.GetVisionThreadCount() << std::endl;
+  std::cout << "schedule:    " << (engine.GetVisionSchedule() == kPacketSchedule ? "packet" : "wavefront") << std::endl;
+  std::cout << "hits:        " << total_hits << std::endl;
+  std::cout << "ms / frame:  " << total_ms / frame_count << std::endl;
+
+  return 0;
+}
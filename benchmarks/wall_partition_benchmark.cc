@@ -0,0 +1,118 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/room.h>
+#include <core/room_factory.h>
+#include <core/wall_bsp.h>
+#include <core/wall_grid.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace room_explorer;
+
+namespace {
+
+// Default Benchmark Settings ==========================================================================================
+const char* kDefaultTemplatePath = "resources/room_templates/tight_map.json";
+const size_t kDefaultRayCount = 200000;
+
+const float kVisibleDistance = 550;
+const unsigned kSeed = 17; // Every partition traces the same rays
+// End of Default Benchmark Settings ===================================================================================
+
+struct Ray {
+  glm::vec2 pos_;
+  glm::vec2 dir_;
+  float exit_distance_;
+};
+
+/**
+ * Times a way of adding every wall hit of the rays, and accumulates the hits so the work cannot be optimized away.
+ */
+template <typename AddHits>
+void TimePartition(const std::string& name, const std::vector<Ray>& rays, AddHits add_hits) {
+  size_t total_hits{0};
+  auto begin = std::chrono::steady_clock::now();
+  for (const Ray& ray : rays) {
+    HitPackage package;
+    add_hits(ray, package);
+    total_hits += package.HitCount();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  double total_ns{std::chrono::duration<double, std::nano>(end - begin).count()};
+  std::cout << name << " hits: " << total_hits << "  ns / ray: " << total_ns / rays.size() << std::endl;
+}
+
+} // namespace
+
+/**
+ * Times the walls of every template of a map through a plain loop, the wall grid and the wall tree, on the same rays.
+ * Usage: wall_partition_benchmark [template_path] [ray_count]
+ */
+int main(int argc, char** argv) {
+  std::string template_path{argc > 1 ? argv[1] : kDefaultTemplatePath};
+  size_t ray_count{argc > 2 ? std::strtoul(argv[2], nullptr, 10) : kDefaultRayCount};
+
+  std::ifstream template_file(template_path);
+  json template_json;
+  template_file >> template_json;
+  RoomFactory factory = template_json;
+  const RoomBounds& bounds{factory.GetBounds()};
+
+  std::mt19937 generator(kSeed);
+  std::uniform_real_distribution<float> x_distribution(0, bounds.width_);
+  std::uniform_real_distribution<float> y_distribution(0, bounds.height_);
+  std::uniform_real_distribution<float> angle_distribution(0, 6.2831853f);
+
+  for (const std::string& id : factory.GetAvailableIds()) {
+    Room* room{factory.GenerateRoom(id)};
+    const std::vector<Wall>& walls{room->GetWalls()};
+    WallGrid grid(walls, bounds);
+    WallBsp bsp(walls, bounds);
+
+    // Rays start within the room and stop at its edge, as they do when following portals
+    std::vector<Ray> rays;
+    for (size_t i = 0; i < ray_count; ++i) {
+      glm::vec2 pos(x_distribution(generator), y_distribution(generator));
+      float theta{angle_distribution(generator)};
+      glm::vec2 dir(std::cos(theta), std::sin(theta));
+      rays.push_back({pos, dir, room->GetPrimaryWallHit(pos, dir).hit_distance_});
+    }
+
+    std::cout << "room: " << id << "  walls: " << walls.size() << "  bsp nodes: " << bsp.NodeCount()
+              << "  bsp fragments: " << bsp.FragmentCount() << std::endl;
+
+    TimePartition("  loop   ", rays, [&walls](const Ray& ray, HitPackage& package) {
+      for (const Wall& wall : walls) {
+        Hit hit{wall.GetWallHit(ray.pos_, ray.dir_)};
+        if (!hit.IsNoHit() && hit.WithinDistance(kVisibleDistance)) {
+          package.AddHit(hit);
+        }
+      }
+    });
+    TimePartition("  grid   ", rays, [&grid](const Ray& ray, HitPackage& package) {
+      grid.AddWallHits(ray.pos_, ray.dir_, kVisibleDistance, ray.exit_distance_, package);
+    });
+    TimePartition("  bsp    ", rays, [&bsp](const Ray& ray, HitPackage& package) {
+      bsp.AddWallHits(ray.pos_, ray.dir_, kVisibleDistance, ray.exit_distance_, package);
+    });
+    TimePartition("  nearest", rays, [&bsp](const Ray& ray, HitPackage& package) {
+      Hit hit{bsp.NearestWallHit(ray.pos_, ray.dir_, kVisibleDistance)};
+      if (!hit.IsNoHit()) {
+        package.AddHit(hit);
+      }
+    });
+
+  }
+
+  return 0;
+}
@@ -0,0 +1,44 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_ALIAS_TABLE_H
+#define NONEUCLIDEAN_RAY_CASTER_ALIAS_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Samples an index with chance proportional to its weight, in constant time, by Vose's alias method.
+ *    Each column keeps its own index for part of its height, and hands the rest to an alias.
+ */
+class AliasTable {
+public:
+  // Constructors =============================================================
+  AliasTable();
+
+  /**
+   * @param weights Finite, non-negative weight of each index. If none is positive, every index is as likely.
+   */
+  explicit AliasTable(const std::vector<float>& weights);
+  // End of Constructors ======================================================
+
+  /**
+   * @param bits Uniformly distributed bits. High half picks the column, low half whether to take its alias.
+   * @return Sampled index. Never one of zero weight, unless every weight is zero.
+   */
+  size_t Sample(uint64_t bits) const;
+
+  size_t Size() const;
+
+private:
+  std::vector<uint64_t> thresholds_; // Low half of the bits under which the column keeps its index. 2^32 always keeps.
+  std::vector<uint32_t> aliases_;
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_ALIAS_TABLE_H
@@ -0,0 +1,71 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_FRAME_HIT_BUFFER_H
+#define NONEUCLIDEAN_RAY_CASTER_FRAME_HIT_BUFFER_H
+
+#include <core/hit_package.h>
+#include <core/hits.h>
+
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * All the hits of a single frame, stored contiguously strip after strip.
+ *    Hits of each strip are sorted by distance, nearest first.
+ *    Strip i owns hits [offset i, offset i + 1), so that the whole frame lives in two flat arrays.
+ * Owned by the caller and meant to be reused every frame.
+ *    Clearing keeps the memory, so once the buffer has grown to fit a frame, later frames allocate nothing.
+ */
+class FrameHitBuffer {
+private:
+  std::vector<Hit> hits_;
+  std::vector<size_t> offsets_; // One more than the number of strips. Always begins with 0.
+
+public:
+  FrameHitBuffer();
+
+  // Frame Building ================================================================================
+  /**
+   * Removes every strip, keeping the allocated memory.
+   */
+  void Clear();
+
+  /**
+   * Reserves memory ahead of time.
+   * @param strip_count Expected number of strips.
+   * @param hit_count Expected number of hits across all strips.
+   */
+  void Reserve(size_t strip_count, size_t hit_count);
+
+  /**
+   * Appends the hits of the package as the next strip, in order of distance.
+   * @param package Package holding every hit of the strip.
+   */
+  void AppendStrip(const HitPackage& package);
+  // End of Frame Building =========================================================================
+
+  // Getters =======================================================================================
+  size_t StripCount() const;
+  size_t HitCount() const;
+
+  size_t StripHitCount(size_t strip) const;
+
+  /**
+   * @param strip Index of the strip, from left-most.
+   * @return Pointer to the nearest hit of the strip.
+   */
+  const Hit* StripBegin(size_t strip) const;
+  /**
+   * @param strip Index of the strip, from left-most.
+   * @return Pointer one past the furthest hit of the strip.
+   */
+  const Hit* StripEnd(size_t strip) const;
+  // End of Getters ================================================================================
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_FRAME_HIT_BUFFER_H
@@ -6,13 +6,31 @@
 #define NONEUCLIDEAN_RAY_CASTER_GAME_ENGINE_H
 
 #define WALL_MARGIN 0.01f
+#define VISION_STRIP_GRAIN 8 // Strips handed to a vision thread at once. Small, so that stealing can balance
+#define VISION_PACKET_WIDTH 8 // Neighbouring strips followed together through rooms. At most Room::kMaxPacketWidth
+#define VISION_WAVEFRONT_SLICES 4 // Slices of strips per vision thread, each cast by a wavefront of its own
+#define DEFAULT_MAX_PORTAL_DEPTH 64 // Portals a vision ray may pass through, unless set otherwise
 
+#include <core/frame_hit_buffer.h>
 #include <core/room.h>
+#include <core/thread_pool.h>
+#include <core/vision_wavefront.h>
 
-#include <cinder/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
 
 namespace room_explorer {
 
+/**
+ * Order in which GetVision follows its rays through the rooms. Both give the same hits.
+ */
+enum VisionSchedule {
+  kPacketSchedule, // Ray by ray, neighbouring strips together in packets of VISION_PACKET_WIDTH
+  kWavefrontSchedule // Room by room, every ray standing in a room traced through it before any ray moves on
+};
+
 /**
  * Holds the pointer to current room, and player position and orientation.
  * Need to be able to call ray-hits and send package of ray-hits to outter sources
@@ -28,6 +46,32 @@ class GameEngine {
   glm::vec2 view_direction_;
   // End of Player orientation Variables ==============================
 
+  // Vision Threading Variables =======================================
+  std::unique_ptr<WorkStealingPool> vision_pool_; // Null when vision is cast on the calling thread alone
+  VisionSchedule vision_schedule_;
+  std::vector<VisionWavefront> vision_wavefronts_; // One per slice of strips, kept between frames
+  // End of Vision Threading Variables ================================
+
+  // Vision Budget Variables ==========================================
+  size_t max_portal_depth_;
+  size_t max_rooms_per_frame_; // 0 if unlimited. Shared out evenly among the strips of a frame.
+  // End of Vision Budget Variables ===================================
+
+  // Strip Table Variables ============================================
+  // Rotation of each strip away from the view direction, computed once per resolution and step angle.
+  //  Strip i is rotated by (i - half_resolution) steps, clockwise for positive steps, as FastRotation does.
+  std::vector<float> strip_cos_; // Cosine of the rotation, and so also the fish-eye scale of the strip
+  std::vector<float> strip_sin_;
+  float table_cos_, table_sin_; // Step angle the tables were computed for. Resolution is their size.
+  // End of Strip Table Variables =====================================
+
+  // Vision Scratch Variables =========================================
+  // Kept between frames, so that casting a frame does not allocate them again.
+  //  The vector overload of GetVision still allocates the copy it returns.
+  std::vector<glm::vec2> strip_directions_;
+  std::vector<HitPackage> strip_packages_;
+  // End of Vision Scratch Variables ==================================
+
 public:
  /**
   * Generate a new Game Engine from given room-template path.
@@ -35,7 +79,7 @@ public:
   * If Initial entry position is also given set current position as such.
   *     Otherwise, position is placed in the center of the room.
   * @param room_template_path Path to json file describing the factory
-  *     that will handle generation of the entire map.
+  *     that will handle generation of the entire map, or to the same templates compiled into a pack.
   */
   GameEngine(const std::string& room_template_path);
 
@@ -48,9 +92,64 @@ public:
     * @param half_resolution Number of rays in each direction of main direction.
     * @param range_distance Maximum distance which the ray can detect intersection with an element.
     * @return Summary of all the hits in the given range.
+    *         Copied out of the scratch of the engine, so every frame allocates it anew.
+    *         Use the FrameHitBuffer overload to render without allocating.
     */
   std::vector<HitPackage> GetVision(float cos, float sin, size_t half_resolution, float range_distance);
 
+  /**
+   * Same vision as above, written into a caller-owned frame buffer instead of a vector of packages.
+   *    Strips are laid out from left-most to right-most, with hits of each strip ordered by distance.
+   *    Buffer is cleared first. Reusing the same buffer every frame avoids re-allocating it.
+   * @param cos Cosine of the angle of each angle between rays.
+   * @param sin Sine of the angle of each angle between rays.
+   * @param half_resolution Number of rays in each direction of main direction.
+   * @param range_distance Maximum distance which the ray can detect intersection with an element.
+   * @param frame Buffer to be filled with every hit of the frame.
+   */
+  void GetVision(float cos, float sin, size_t half_resolution, float range_distance, FrameHitBuffer& frame);
+
+  /**
+   * Sets number of threads that GetVision spreads its strips over.
+   *    Threads are kept alive between frames, and balance uneven strips by stealing work from each other.
+   * @param thread_count Total number of threads casting rays, including the calling thread.
+   *                     0 or 1 casts every ray on the calling thread.
+   */
+  void SetVisionThreadCount(size_t thread_count);
+
+  /**
+   * @return Total number of threads casting rays in GetVision, including the calling thread.
+   */
+  size_t GetVisionThreadCount() const;
+
+  /**
+   * Sets number of portals a single vision ray may pass through.
+   *    Ray stops at the portal once the depth is reached, and the portal becomes its furthest hit.
+   * @param max_portal_depth Maximum number of portals passed by each ray.
+   */
+  void SetMaxPortalDepth(size_t max_portal_depth);
+
+  /**
+   * Sets number of rooms all the rays of a single frame may enter through portals, together.
+   *    Every strip gets an equal share, as a portal depth of its own on top of the max portal depth.
+   *    Rooms left over go one each to strips spread evenly across the view, so a budget below the strip count
+   *    still lets that many strips through a portal.
+   *    Strips never draw on a shared count, so which rays are cut short never depends on how threads are timed.
+   * @param max_rooms_per_frame Maximum number of rooms entered per frame. 0 for unlimited.
+   */
+  void SetMaxRoomsPerFrame(size_t max_rooms_per_frame);
+
+  /**
+   * Sets the order in which GetVision follows its rays through the rooms. Wavefront by default.
+   * @param vision_schedule Schedule used from the next frame on.
+   */
+  void SetVisionSchedule(VisionSchedule vision_schedule);
+
+  /**
+   * @return Order in which GetVision follows its rays through the rooms.
+   */
+  VisionSchedule GetVisionSchedule() const;
+
   /**
    * Rotation the view direction by given angle.
    * @param cos Cosine of the angle of rotation
@@ -82,6 +181,25 @@ private:
    * Clamp the current position within the room with a small margin.
    */
   void ClampWithinRoom();
+
+  /**
+   * Recomputes the strip tables if the step angle or the resolution differ from those they were computed for.
+   *    Each rotation is computed directly from its angle, so strips far from the view direction do not drift.
+   * @param cos Cosine of the angle of each angle between rays.
+   * @param sin Sine of the angle of each angle between rays.
+   * @param half_resolution Number of rays in each direction of main direction.
+   */
+  void UpdateStripTables(float cos, float sin, size_t half_resolution);
+
+  /**
+   * Casts every strip of the vision into the strip packages, on the vision threads if there are any.
+   *    Ray directions are the view direction rotated by the strip tables, so that each strip can be cast independently.
+   * @param cos Cosine of the angle of each angle between rays.
+   * @param sin Sine of the angle of each angle between rays.
+   * @param half_resolution Number of rays in each direction of main direction.
+   * @param range_distance Maximum distance which the ray can detect intersection with an element.
+   */
+  void CastStrips(float cos, float sin, size_t half_resolution, float range_distance);
 };
 
 }
@@ -8,7 +8,10 @@
 #include <core/hits.h>
 #include <core/util.h>
 
-#include <cinder/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include <map>
+#include <vector>
 
 namespace room_explorer {
 
@@ -16,16 +19,82 @@ namespace room_explorer {
  * Summary of all the hits intersected by a ray in a single direction.
  * Allows merging of two hit-packages.
  * Allow simple shifting and scaling of distances of all the hits in the package.
+ *
+ * Hits are kept in a flat array sorted by distance, with at most one hit per distance.
+ *    The first kInlineCapacity hits are stored inside the package itself,
+ *    so that a typical ray never allocates. Only larger packages spill onto the heap.
+ *
+ * Shifting and scaling are lazy. Package only composes a pending scale * distance + shift,
+ *    which is applied to the stored hits once they are read, added to, or merged into another package.
  */
 class HitPackage {
+public:
+  static const size_t kInlineCapacity = 16; // Hits held without allocating
+
 private:
-  std::map<float, Hit> hits_;
+  // Mutable, as reading a package applies the pending transform first
+  mutable size_t hit_count_;
+  mutable Hit inline_hits_[kInlineCapacity];
+  mutable std::vector<Hit> overflow_hits_; // Holds every hit instead, once more than kInlineCapacity are needed
+
+  // Pending transform. Actual distance of a stored hit is scale_ * distance + shift_.
+  mutable float scale_;
+  mutable float shift_;
+
+  /**
+   * @return Pointer to the first hit, wherever the hits currently live.
+   */
+  Hit* Data() const;
+
+  /**
+   * Ensures storage for at least the given number of hits, moving hits onto the heap if needed.
+   * @param capacity Number of hits that must fit.
+   */
+  void Reserve(size_t capacity);
+
+  /**
+   * Removes neighbouring hits which ended up at the same distance after a distance change.
+   *    Of each group, the hit with strictly highest priority is kept,
+   *    with ties going to the hit that would have been added first.
+   * @param prefer_later Whether hits later in the array would have been added first.
+   */
+  void CollapseEqualDistances(bool prefer_later) const;
+
+  /**
+   * Applies the pending transform onto the stored hits, and resets it.
+   */
+  void ApplyTransform() const;
+
+  /**
+   * Finds the hit the pending transform would keep, out of the hits that end up at the same distance.
+   *    Does not apply the transform, so that a package can be merged without being modified.
+   * @param end Number of hits, in transformed order, before the group. Set to where the group begins.
+   * @return Kept hit, with transformed distance.
+   */
+  Hit TakeTransformedGroup(size_t& end) const;
 
 public:
+  HitPackage();
+
   // Getters =======================================================
   size_t HitCount() const;
 
-  const std::map<float, Hit>& GetHits() const;
+  /**
+   * Hits ordered by distance, nearest first. Allows range-for over the package.
+   * @return Pointer to the nearest hit.
+   */
+  const Hit* begin() const;
+  /**
+   * @return Pointer one past the furthest hit.
+   */
+  const Hit* end() const;
+
+  /**
+   * Copy of all the hits, keyed by their distance.
+   *    Allocates for every hit. Prefer iterating the package directly.
+   * @return Map of distance to hit.
+   */
+  std::map<float, Hit> GetHits() const;
   // End of Getters ================================================
 
   // Package Addition Methods ==========================================================================================
@@ -42,15 +111,29 @@ public:
    * Merges two hit packages into the current package.
    * If a hit already exist at the given distance, hit with higher priority will take over.
    *    Hit from this package is prioritized over the hits from other.
+   * Done as a single linear merge of both sorted packages.
    * @param package Constant reference of the package to be merged into this package.
    */
   void Merge(const HitPackage& package);
+
+  /**
+   * Removes every hit. Heap storage is kept, so that refilling the package as large does not allocate again.
+   */
+  void Clear();
   // End of Package Addition Methods ===================================================================================
 
 
   // Distance Manipulator ==============================================================================================
+  /**
+   * Adds shift to the distance of every hit. Constant time, the shift is applied lazily.
+   * @param shift Distance to be added.
+   */
   void ShiftHits(float shift);
 
+  /**
+   * Multiplies the distance of every hit by scale. Constant time, the scale is applied lazily.
+   * @param scale Factor to multiply distances by.
+   */
   void ScaleDistances(float scale);
   // End of Distance Manipulator =======================================================================================
 };
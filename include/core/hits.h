@@ -7,7 +7,7 @@
 
 #include <core/util.h>
 
-#include <cinder/gl/gl.h>
+#include <glm/glm.hpp>
 
 namespace room_explorer {
 
@@ -0,0 +1,97 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_PINNED_TEMPLATES_H
+#define NONEUCLIDEAN_RAY_CASTER_PINNED_TEMPLATES_H
+
+#include <core/room_key.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Templates pinned to keys of rooms generated from an explicit template.
+ * Looked up without a lock, as every room generated from a key looks up its pin, from any vision thread.
+ *    Keys live in an open addressing table, probed linearly and kept at most half full.
+ *    Slots are only ever filled, never emptied, so a slot is complete once its template is seen.
+ *    Growing publishes a larger copy. Replaced tables are kept until unpinning, so lookups never see one freed.
+ * Pins are added under a lock, which lookups never take.
+ */
+class PinnedTemplates {
+public:
+  static const size_t kNoTemplate = SIZE_MAX;
+
+  // Constructors =============================================================
+  PinnedTemplates();
+
+  PinnedTemplates(const PinnedTemplates&) = delete;
+  PinnedTemplates& operator=(const PinnedTemplates&) = delete;
+  // End of Constructors ======================================================
+
+  // Pin Methods ==============================================================
+  /**
+   * Lock-free. Sees every pin added before the room asking was shared with the calling thread.
+   * @return Template pinned to the key. kNoTemplate if none.
+   */
+  size_t Find(RoomKey key) const;
+
+  /**
+   * Pins the template to the key, unless the key already has one.
+   *    Safe alongside Find and other calls to Pin.
+   * @return Template pinned to the key, which is the first ever pinned to it.
+   */
+  size_t Pin(RoomKey key, size_t template_index);
+
+  /**
+   * Drops the pins of the keys, and frees every table replaced so far.
+   *    Not safe alongside any other call, as lookups may still be reading the tables freed.
+   */
+  void Unpin(const std::vector<RoomKey>& keys);
+
+  /**
+   * @return Number of keys pinned.
+   */
+  size_t Size() const;
+  // End of Pin Methods =======================================================
+
+private:
+  struct Slot {
+    std::atomic<RoomKey> key_;
+    std::atomic<size_t> template_; // kNoTemplate while the slot is empty. Written last, once the key is in.
+  };
+
+  struct Table {
+    size_t mask_; // Capacity minus one. Capacity is a power of two.
+    std::unique_ptr<Slot[]> slots_;
+
+    explicit Table(size_t capacity);
+  };
+
+  static const size_t kFirstCapacity = 16;
+
+  std::atomic<const Table*> table_; // Current table, null until the first pin
+  std::vector<std::unique_ptr<Table>> tables_; // Current table last, preceded by those it replaced
+  std::atomic<size_t> size_;
+  std::mutex pin_mutex_;
+
+  /**
+   * Fills the first empty slot of the key. Only while holding the lock, or before the table is published.
+   */
+  static void Insert(Table& table, RoomKey key, size_t template_index);
+
+  /**
+   * Publishes a table of given capacity, holding every pin of the current one.
+   */
+  void Rebuild(size_t capacity, const std::vector<RoomKey>& dropped_keys);
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_PINNED_TEMPLATES_H
@@ -0,0 +1,61 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_PREDICATES_H
+#define NONEUCLIDEAN_RAY_CASTER_PREDICATES_H
+
+#include <glm/glm.hpp>
+
+namespace room_explorer {
+
+/*
+ * Exact signs of the 2D cross products that decide every ray-wall intersection.
+ *  Each cross product is expanded into products of the float coordinates themselves, which are exact in double.
+ *  Their sum is first evaluated in double, and its sign is trusted if it exceeds the bound on rounding of the sum.
+ *      Only near-degenerate inputs, whose sum falls within that bound, are summed again exactly.
+ *  Signs are therefore those of the real numbers the floats represent,
+ *      and the same configuration gets the same answer whichever predicate, or order of points, asks.
+ *  Products are exact because a float holds 24 significant bits, so a product of two holds at most 48,
+ *      which the 53 bit mantissa of a double holds without rounding.
+ *      Its exponent is at most twice that of a float, far within the range of double, so it neither underflows
+ *      nor overflows, even for subnormal coordinates.
+ * Ray directions are the exception. Built from a sine and a cosine, they carry rounding which no exact test can undo,
+ *  so that a ray aimed at an end-point would graze past it. Sides of a ray take that rounding into account instead.
+ */
+
+// Relative error a ray direction is assumed to carry, same as the default epsilon of FloatApproximation
+const float kDirectionEpsilon = .0000005f;
+
+// Geometric Predicates ================================================================================================
+/**
+ * Sign of the cross product of two vectors.
+ * @return 1 if vec_b is counterclockwise from vec_a, -1 if clockwise, 0 if parallel or either is zero.
+ */
+int CrossSign(const glm::vec2& vec_a, const glm::vec2& vec_b);
+
+/**
+ * Sign of the turn from point_a through point_b to point_c, (b - a) x (c - a).
+ * @return 1 if counterclockwise, -1 if clockwise, 0 if collinear, including if any two points are the same.
+ */
+int Orientation(const glm::vec2& point_a, const glm::vec2& point_b, const glm::vec2& point_c);
+
+/**
+ * Side of a line through line_pos along line_dir that the point lies on, line_dir x (point - line_pos).
+ *      Same as the orientation of line_pos, line_pos + line_dir, point, without rounding line_pos + line_dir.
+ * @return 1 if left of the line, -1 if right, 0 if on it. Always 0 for a zero direction.
+ */
+int SideOfLine(const glm::vec2& point, const glm::vec2& line_pos, const glm::vec2& line_dir);
+
+/**
+ * Side of a ray that the point lies on, as SideOfLine, except that points within the rounding of the direction count
+ *      as on the ray. Band is kDirectionEpsilon relative to the terms of the cross product, so it scales with the room.
+ *      Far wider than the rounding of the double sum, which the band alone therefore settles without an exact sum.
+ * @return 1 if left of the ray, -1 if right, 0 if on it up to the rounding of the direction.
+ */
+int SideOfRay(const glm::vec2& point, const glm::vec2& ray_pos, const glm::vec2& ray_dir);
+// End of Geometric Predicates =========================================================================================
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_PREDICATES_H
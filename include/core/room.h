@@ -13,14 +13,22 @@
 #include <exceptions/invalid_direction_exception.h>
 
 #include <core/hit_package.h>
+#include <core/room_arena.h>
+#include <core/room_bounds.h>
+#include <core/room_key.h>
 #include <core/wall.h>
+#include <core/wall_bsp.h>
+#include <core/wall_grid.h>
 
+#include <atomic>
+#include <cstdint>
 #include <set>
 
 namespace room_explorer {
 
 // Studs ==================
 class RoomFactory;
+class VisionWavefront;
 // end of Studs ===========
 
 enum Direction {
@@ -40,6 +48,76 @@ enum Direction {
  */
 Direction operator!(const Direction& direction);
 
+/**
+ * Checks if the direction is one of the four cardinal directions.
+ * @param direction Direction being checked.
+ * @return False if direction is undefined, or not a valid direction at all.
+ */
+bool IsCardinal(const Direction& direction);
+
+/**
+ * Limit on how far a ray is followed through portals.
+ *    Ray stops at the portal once the limit is reached, leaving the portal as its furthest hit.
+ *    Each ray has a budget of its own, so that where a ray stops never depends on other rays.
+ * Rooms a frame may enter are shared out among its rays up front, as further portal depth limits.
+ *    Every ray gets the same share, and the remainder goes one room each to rays spread evenly across the frame.
+ */
+struct PortalBudget {
+  size_t max_portal_depth{SIZE_MAX}; // Portals a single ray may pass through
+  size_t frame_rooms{SIZE_MAX}; // Rooms the rays of the frame may enter between them. SIZE_MAX if unlimited.
+  size_t frame_ray_count{1}; // Rays of the frame the rooms are shared out among
+  size_t first_ray{0}; // Index within the frame of the first ray given to the call
+
+  /**
+   * @param ray Index of the ray among those given to the call.
+   * @return Number of portals the ray may pass through.
+   */
+  size_t RayPortalDepth(size_t ray) const;
+
+  /**
+   * Checks whether the ray may pass another portal.
+   * @param ray Index of the ray among those given to the call.
+   * @param depth Number of portals the ray has already passed.
+   * @return True if the ray may enter the next room.
+   */
+  bool AllowsPortal(size_t ray, size_t depth) const;
+};
+
+/**
+ * Link of a room to an adjacent room, read and set by rays cast on several threads at once.
+ *    Set only once, from kNoRoom to the id of a room, so that a room published by one thread is seen by every other.
+ *    Copied as a plain id, so that rooms stay copyable.
+ */
+class RoomLink {
+public:
+  RoomLink();
+  RoomLink(const RoomLink& other);
+  RoomLink& operator=(const RoomLink& other);
+
+  /**
+   * @return Id of the adjacent room, kNoRoom if not yet linked.
+   *    Everything written to a room before it was published is seen once its id is.
+   */
+  RoomId Load() const;
+
+  /**
+   * Sets the link without publishing it. Only for rooms no other thread can reach.
+   */
+  void Store(RoomId id);
+
+  /**
+   * Links the adjacent room, unless another thread has done so first.
+   *    Everything written to the room beforehand is published along with its id.
+   * @param id Id of the adjacent room.
+   * @param linked Set to the id linked by the thread that came first, if the link was already set.
+   * @return True if the link was set to the id.
+   */
+  bool Publish(RoomId id, RoomId& linked);
+
+private:
+  std::atomic<RoomId> id_;
+};
+
 /**
  * Individual room of the map.
  *  Handles internal geometric interactions with a ray.
@@ -49,13 +127,22 @@ Direction operator!(const Direction& direction);
  */
 class Room {
 private:
-  const RoomFactory* factory;
-
+  // Hot Members. Read by every ray passing through the room =====================
   //! The coordinate (0, 0) is the SW Corner. The map basically emulates cartesian coordinates.
-  Room* north_;
-  Room* south_;
-  Room* east_;
-  Room* west_;
+  RoomLink links_[4]; // Adjacent rooms in the arena, indexed by Direction
+  const WallArray* walls_{nullptr}; // Walls of the template the room was generated from
+  const WallGrid* wall_grid_{nullptr}; // Walls of the template bucketed into cells
+  const WallBsp* wall_bsp_{nullptr}; // Walls of the template as a tree. Null unless the template asks for it.
+  RoomBounds bounds_; // Dimensions of the factory, cached for ray casting
+  // End of Hot Members ==========================================================
+
+  // Cold Members. Only read when a room is generated ============================
+  const RoomFactory* factory{nullptr};
+  RoomArena* arena_{nullptr}; // Arena of the factory, owning this room and every room it links to
+  RoomId id_{kNoRoom}; // kNoRoom while the room is not generated, or once it is evicted
+  RoomKey key_{0}; // Place of the room in the map. Picks its template, and that of rooms generated next to it.
+  bool fitted_{false}; // Whether the template was fitted to the neighbours. Rooms next to each other alternate.
+  // End of Cold Members =========================================================
 
   float GetNSDoorBegin() const;
   float GetEWDoorBegin() const;
@@ -63,9 +150,9 @@ private:
   float GetNSDoorEnd() const;
   float GetEWDoorEnd() const;
 
-  const std::set<Wall>* walls_;
-
 public:
+  static const size_t kMaxPacketWidth = 16; // Rays followed together by a single packet
+
   // Public Room Member Functions ===============================================
 
   // Room Connectivity Functions ===================================
@@ -73,6 +160,11 @@ public:
    * Retrieves the adjacent room in the given direction.
    * If the current room is not yet linked with any adjacent room, generate a new room from factory,
    *    link it with this room, and return the pointer to the newly generated room.
+   * Template of the generated room depends only on the key of this room, the direction and the seed of the factory,
+   *    so a room evicted and generated again is the same room.
+   * Safe to call from several threads at once, without a lock.
+   *    Threads finding the room not yet linked each generate one, and the first to link its room wins.
+   *    Rooms of the others go back to the arena, for their ids to be reused.
    * @param direction Direction in which the room should be retrieved, or if necessary generated in.
    * @return    Pointer to the adjacent room in the given direction.
    *            Will never be a nullptr. Always a room-pointer that is linked to this room as well.
@@ -84,6 +176,8 @@ public:
    * If the current room is not yet linked with any adjacent room, generate a new room from factory from id,
    *    link it with this room, and return the pointer to the newly generated room.
    * If id is not valid, return nullptr.
+   * Safe to call from several threads at once, as above.
+   *    Threads racing with different ids get the room of whichever links first.
    * @param direction Direction in which the room should be retrieved, or if necessary generated in.
    * @return    Pointer to the adjacent room in the given direction.
    *            If room not yet connected, generate new from from id.
@@ -138,6 +232,23 @@ public:
    */
   glm::vec2 GetTail(Direction direction, bool of_portal) const;
 
+  /**
+   * Same as GetHead, but reports an invalid direction instead of throwing InvalidDirectionException.
+   * @param direction Direction of portal/room-wall.
+   * @param of_portal Whether head if that of portal or room-wall of given direction.
+   * @param head Set to the head, if direction is valid. Left untouched otherwise.
+   * @return False if direction is not a cardinal direction.
+   */
+  bool TryGetHead(Direction direction, bool of_portal, glm::vec2& head) const;
+  /**
+   * Same as GetTail, but reports an invalid direction instead of throwing InvalidDirectionException.
+   * @param direction Direction of portal/room-wall.
+   * @param of_portal Whether tail if that of portal or room-wall of given direction.
+   * @param tail Set to the tail, if direction is valid. Left untouched otherwise.
+   * @return False if direction is not a cardinal direction.
+   */
+  bool TryGetTail(Direction direction, bool of_portal, glm::vec2& tail) const;
+
   // End of getters ===============
 
   /**
@@ -179,6 +290,17 @@ public:
    */
   Direction GetSideHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir, bool point_inclusive = true) const;
 
+  /**
+   * Same as GetSideHit, but never throws. Meant for the ray hot path,
+   *    where rays starting on an edge or running along one are routine rather than exceptional.
+   * @param ray_pos Position where the ray begins.
+   * @param ray_dir Direction of the ray.
+   * @param point_inclusive Determines whether wall from which the way might be on should be considered as hit.
+   * @return Direction of the first valid wall that the ray hits.
+   *            kUndefined wherever GetSideHit would throw InvalidDirectionException.
+   */
+  Direction TryGetSideHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir, bool point_inclusive = true) const;
+
   /**
    * Distance that ray must travel from its initial position to intersect with the wall in the given direction.
    *    Validity of this path is not checked. Wall is assumed to be infinitely extended.
@@ -248,13 +370,36 @@ public:
   /**
    * Retrieves HitPackage of all the walls and portal/room-wall in the path of the ray.
    *    Will extend to the adjacent rooms if ray passes through the portal.
+   *    Rooms are followed one after another in a loop, so that long ranges never deepen the call stack.
    * @param ray_pos Initial position of the ray.
    * @param ray_dir Direction of the ray.
+   * @param visible_range Maximum distance of a hit from the initial position.
+   * @param point_inclusive Whether the wall on which the ray begins should be considered a hit.
    * @return HitPackage of all the elements intersected by the ray in the given direction of this room.
    *            Will include the package of the adjacent room if appropriate.
    */
   HitPackage GetVisible(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range, bool point_inclusive = true);
 
+  /**
+   * Same as above, but following the ray through no more portals than the budget allows.
+   * @param budget Limits on portals a ray may pass. The ray is the first of the call.
+   */
+  HitPackage GetVisible(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                        const PortalBudget& budget, bool point_inclusive = true);
+
+  /**
+   * Same as above for a packet of rays sharing their initial position, such as neighbouring strips of a view.
+   *    Rays crossing the same rooms are followed together, room by room. Each room is entered once for all of them,
+   *    and rays leaving through the same side look up the adjacent room once.
+   *    Rays leaving through different sides, or stopping, split off into packets of their own.
+   * Every package is the same as GetVisible would give for its ray alone.
+   * @param ray_dirs Directions of the rays.
+   * @param ray_count Number of rays. Followed kMaxPacketWidth at a time.
+   * @param packages Set to the package of each ray, in the same order.
+   */
+  void GetVisible(const glm::vec2& ray_pos, const glm::vec2* ray_dirs, size_t ray_count, float visible_range,
+                  const PortalBudget& budget, HitPackage* packages, bool point_inclusive = true);
+
   /**
    * Package of all the Hits, including all walls and cardinal wall.
    * Contain only up until the given range
@@ -276,9 +421,21 @@ public:
   size_t GetWallCount() const;
 
   /**
-   * @return Set of all the walls in the current room.
+   * @return All the walls in the current room, in the order the template holds them.
+   */
+  const std::vector<Wall>& GetWalls() const;
+
+  /**
+   * @return Key of the place of the room in the map, kept when the room is evicted and generated again.
    */
-  const std::set<Wall>& GetWalls() const;
+  RoomKey GetKey() const;
+
+  /**
+   * Key of the room next to the room of given key. Stepping back the opposite direction gives the key back.
+   * @param key Key of the room.
+   * @param direction Cardinal direction of the adjacent room.
+   */
+  static RoomKey NeighbourKey(RoomKey key, const Direction& direction);
 
   // End of Room Element Functions ==========
 
@@ -288,31 +445,42 @@ private:
   // Private Room Member Functions ===============================================================
 
   /**
-   * Retrieves pointer to adjacent room in the given direction.
+   * Retrieves link to adjacent room in the given direction.
    * @param direction Direction of the retrieved adjacent room.
-   * @return Reference to the pointer to adjacent room.
-   *         Allow direct alteration to the member pointer that is being retrieved.
+   * @return Reference to the link to adjacent room. kNoRoom if not yet linked.
+   *         Allow direct alteration to the member link that is being retrieved.
    */
-  Room*& GetLinkedRoomPointer(const Direction& direction);
+  RoomLink& GetLink(const Direction& direction);
   /**
    * Retrieves pointer to adjacent room in the given direction.
    * @param direction Direction of the retrieved adjacent room.
-   * @return Pointer to adjacent room.
+   * @return Pointer to adjacent room. Null if not yet linked.
    */
   Room*  GetLinkedRoomPointer(const Direction& direction) const;
 
   /**
    * Link the current room with the given room in the direction relative to the current room.
    *    Only link of both rooms have not yet defined the adjacent room in the given direction yet.
+   *    Other room is linked back first, then published by this room's link, so that it is seen linked both ways.
    * @param direction     Direction relative to the current room.
    *                The opposite direction will be linked in the other room.
    * @param room_p  Pointer to the other room being linked.
-   *                It should not have been linked in the opposite direction yet.
+   *                It should not have been linked in the opposite direction yet, nor be reachable by other threads.
    * @return If the linkage was able to be completed properly.
    *                Link only occurs if both rooms are not already linked in the given direction.
+   *                Fails as well if another thread linked this room in the given direction first.
    */
   bool LinkRoom(const Direction& direction, Room* room_p);
 
+  /**
+   * Links a newly generated room in the given direction, or gives it back to the arena if another thread
+   *    linked a room there first.
+   * @param direction Direction relative to the current room.
+   * @param room_p Room just generated, not yet reachable by other threads.
+   * @return Room linked in the given direction, whichever thread linked it.
+   */
+  Room* LinkGeneratedRoom(const Direction& direction, Room* room_p);
+
   /**
    * Retrieves point considered the "head" of segment that defines the portal in a given direction.
    *    Head is considered the more clock-wise point of a given segment, relative to the inside of the room.
@@ -369,12 +537,90 @@ private:
   bool OnRoomEdge(bool strictly_within_width, bool strictly_within_height,
                   bool width_edge, bool height_edge) const;
 
+  /**
+   * Fused room-exit kernel.
+   *    A single slab test against the cached bounds yields the side, distance, portal or room-wall,
+   *    and texture index of the exit at once.
+   *    Handles rays starting strictly inside, and point-exclusive rays entering across a single edge,
+   *    such as rays coming in through a portal. Every other ray is left to the edge rules of GetSideHit.
+   * @param ray_pos Initial position of the ray.
+   * @param ray_dir Direction of the ray.
+   * @param wall_inclusive Whether or not the point on which the initial position is on should be included.
+   * @param hit Set to the hit of the exit, if handled.
+   * @param direction Set to the side of the exit, if handled.
+   * @param on_edge Set to whether the ray starts on or outside an edge.
+   *                    Strictly inside, inclusive and exclusive hits are the same hit.
+   * @return False if the ray is not handled by the kernel.
+   */
+  bool TryGetExitHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir, bool wall_inclusive,
+                     Hit& hit, Direction& direction, bool& on_edge) const;
+
+  /**
+   * Primary wall hit through GetSideHit and the per-direction helpers.
+   *    Handles every ray, including those starting on an edge, which the exit kernel does not.
+   * @param ray_pos Initial position of the ray.
+   * @param ray_dir Direction of the ray.
+   * @param direction Reference to the direction variable which will be updated to direction of possible primary hit.
+   * @param wall_inclusive Whether or not the point on which the initial position is on should be included.
+   * @return Hit of either room-wall or portal.
+   */
+  Hit GetEdgePrimaryWallHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir,
+                            Direction& direction, bool wall_inclusive) const;
+
+  /**
+   * Adds the room-wall or portal hits of the ray into the package, within range.
+   *    Exclusive primary hit is always considered. Inclusive one only if point inclusive and different.
+   * @param ray_pos Initial position of the ray.
+   * @param ray_dir Direction of the ray.
+   * @param visible_range Maximum distance of a hit.
+   * @param point_inclusive Whether the wall on which the ray begins should be considered a hit.
+   * @param direction Set to the direction of the exclusive primary hit.
+   * @param package Package to which the hits are added.
+   * @return Exclusive primary hit, whether within range or not. The only hit that can be a portal.
+   */
+  Hit AddPrimaryWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                         bool point_inclusive, Direction& direction, HitPackage& package) const;
+
+  /**
+   * Adds the hits of the ray with walls of the template, through the tree if the template has one, else the grid.
+   *    Every wall is tested, whichever door the ray came in through. Walls are see-through, so none hides another.
+   *    Walls behind the entry edge lie behind the ray, and those on the edge are removed at load by CleanUpWalls.
+   * @param exit_distance Distance of the exclusive primary hit. Walls cannot be hit past it.
+   */
+  void AddTemplateWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                           float exit_distance, HitPackage& package) const;
+
+  /**
+   * Follows the ray through this room alone, as a single step of GetVisible.
+   * @param entry_pos Position at which the ray enters the room, or begins.
+   * @param room_range Visible range left to the ray.
+   * @param traveled Distance traveled up to the entry. Hits added to the package are shifted by it.
+   * @param package Package of the whole ray, the hits of this room merged into it.
+   * @param exit_hit Set to the exclusive primary hit, through which the ray leaves the room.
+   * @param direction Set to the side of the exit hit.
+   * @return True if the ray leaves through a portal within range.
+   */
+  bool TraceRoom(const glm::vec2& entry_pos, const glm::vec2& ray_dir, float room_range, float traveled,
+                 bool point_inclusive, HitPackage& package,
+                 Hit& exit_hit, Direction& direction) const;
+
+  /**
+   * Finds where a ray leaving this room through a portal enters the adjacent room.
+   * @param direction Side of the portal.
+   * @param texture_shift Texture index of the portal hit, its distance from the portal head.
+   * @param entry_pos Set to the position on the opposite edge of the adjacent room.
+   * @return False if the direction is not cardinal.
+   */
+  bool TryGetEntryPosition(Direction direction, float texture_shift, glm::vec2& entry_pos) const;
+
   // End of Private Member Functions ===========================
 
 
   // Friend Classes/Functions =====================================================
   //! Factory needs to be able to initialize private members of room object
   friend class RoomFactory;
+  //! Wavefront steps rays through rooms itself, a room at a time
+  friend class VisionWavefront;
   // End of Friends ====================
 };
 
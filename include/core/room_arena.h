@@ -0,0 +1,110 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_ROOM_ARENA_H
+#define NONEUCLIDEAN_RAY_CASTER_ROOM_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace room_explorer {
+
+// Stud for Room =====================================
+class Room;
+// End of Stud for Room ==============================
+
+/**
+ * Index of a room within the arena of its factory. Rooms refer to their neighbours by id rather than by pointer.
+ */
+typedef uint32_t RoomId;
+const RoomId kNoRoom = UINT32_MAX;
+
+/**
+ * Owner of every room generated by a factory.
+ * Rooms live in chunks allocated in bulk, each chunk twice as large as the one before.
+ *    Chunks never move once allocated, so rooms and pointers to them stay valid until the arena is destroyed.
+ *    Chunk directory is a fixed array, so looking up a room never races with a chunk being added.
+ * Released rooms leave their id to the next room allocated, so a bounded map reuses the same chunks.
+ *    Released ids are stacked through a link per id, tagged against an id being popped and pushed back meanwhile.
+ * Allocating and releasing take no lock, as rooms are generated from every vision thread.
+ * Destroying the arena destroys every room in it, which is how rooms of a map are freed.
+ */
+class RoomArena {
+public:
+  static const size_t kFirstChunkBits = 8;
+  static const size_t kFirstChunkSize = size_t{1} << kFirstChunkBits; // Rooms in the first chunk
+  static const size_t kMaxChunks = 32 - kFirstChunkBits; // Enough chunks for every 32 bit id
+
+  // Constructors =============================================================
+  RoomArena();
+  ~RoomArena();
+
+  // Arena owns its rooms, which refer back to it
+  RoomArena(const RoomArena&) = delete;
+  RoomArena& operator=(const RoomArena&) = delete;
+  // End of Constructors ======================================================
+
+  // Arena Methods ============================================================
+  /**
+   * Constructs a new room in the id of a released room if there is one,
+   *    otherwise allocating the next chunk if the current one is full.
+   *    Safe to call from several threads at once, without a lock.
+   * @return Id of the new room.
+   */
+  RoomId Allocate();
+
+  /**
+   * @param id Id of a room returned by Allocate.
+   * @return Room of the id.
+   */
+  Room& Get(RoomId id) const;
+
+  /**
+   * Resets the room of the id to a default room, and leaves the id to a later allocation.
+   *    Links to the room must have been cut beforehand.
+   *    Safe to call from several threads at once, without a lock.
+   * @param id Id of a room returned by Allocate, not yet released.
+   */
+  void Release(RoomId id);
+
+  /**
+   * @return Number of rooms allocated and not released.
+   */
+  size_t RoomCount() const;
+
+  /**
+   * @return Number of ids handed out so far, released or not. Every id below it can be looked up.
+   */
+  size_t SlotCount() const;
+  // End of Arena Methods =====================================================
+
+private:
+  struct Chunk; // Rooms of a chunk, and the link of each to the id released before it
+
+  std::atomic<Chunk*> chunks_[kMaxChunks]; // Installed by whichever thread first needs them
+  std::atomic<size_t> slot_count_;
+  std::atomic<size_t> room_count_;
+  std::atomic<uint64_t> released_top_; // Tag in the high half, last released id in the low half.
+                                       //  Reused last released first, while their chunk is still warm.
+
+  /**
+   * @return Chunk of given index, allocating it if no thread has yet.
+   */
+  Chunk& InstallChunk(size_t chunk);
+
+  /**
+   * @return Link of the id to the id released before it.
+   */
+  std::atomic<RoomId>& ReleasedLink(RoomId id) const;
+
+  /**
+   * Splits an id into its chunk and its index within the chunk.
+   */
+  static void Locate(RoomId id, size_t& chunk, size_t& index);
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_ROOM_ARENA_H
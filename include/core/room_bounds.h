@@ -0,0 +1,30 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_ROOM_BOUNDS_H
+#define NONEUCLIDEAN_RAY_CASTER_ROOM_BOUNDS_H
+
+namespace room_explorer {
+
+/**
+ * Dimensions shared by every room of a factory.
+ *    Computed once by the factory and copied into each room,
+ *    so that casting a ray reads them directly rather than asking the factory for each one.
+ */
+struct RoomBounds {
+  float width_{};
+  float height_{};
+
+  float ns_door_begin_{}, ns_door_end_{};
+  float ew_door_begin_{}, ew_door_end_{};
+
+  // Tolerances under which FloatApproximation considers a position to be on an edge.
+  //  Absolute around 0, and relative to the room size around the far edges.
+  float edge_epsilon_{};
+  float width_tolerance_{}, height_tolerance_{};
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_ROOM_BOUNDS_H
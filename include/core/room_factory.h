@@ -9,14 +9,36 @@
 #include <core/room.h>
 #endif  // NONEUCLIDEAN_RAY_CASTER_ROOM_H
 
+#include <core/alias_table.h>
+#include <core/pinned_templates.h>
+#include <core/room_arena.h>
+#include <core/room_bounds.h>
+#include <core/room_key.h>
+#include <core/template_adjacency.h>
+#include <core/template_pack.h>
 #include <core/wall.h>
+#include <core/wall_bsp.h>
+#include <core/wall_array.h>
+#include <core/wall_cleanup.h>
+#include <core/wall_grid.h>
 
 #include <exceptions/room_explorer_exception.h>
 
 #include <nlohmann/json.hpp>
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using json = nlohmann::json;
 
@@ -41,7 +63,15 @@ public:
   */
  struct RoomTemplate {
   private:
-   std::set<Wall> walls_;
+   WallArray walls_; // Contiguous, in the order left by the cleanup
+   WallGrid wall_grid_; // Same walls, bucketed into cells the ray walks through
+   bool uses_bsp_{false}; // Set by "wall_partition" : "bsp" in the template
+   WallBsp wall_bsp_; // Same walls, split into a tree visited front to back. Only built if uses_bsp_.
+   WallCleanupReport cleanup_report_; // Walls removed from those given, before the partitions are built
+
+   float weight_{1}; // How often the template is chosen, against the weights of the others
+   bool open_sides_[TemplateAdjacency::kSideCount]{true, true, true, true}; // Indexed by Direction
+   std::map<size_t, std::vector<std::string>> neighbour_ids_; // Ids allowed on each ruled side, by Direction
   public:
    // Getters ==========================================================================================================
    size_t GetWallCount() const;
@@ -50,6 +80,7 @@ public:
    // Friends :) =======================================================================================================
    // JSON loader ==================================================================
    friend void from_json(const json&, RoomTemplate& );
+   friend void from_json(const json&, RoomFactory& ); // Builds the wall partitions once room dimensions are known
    // End of JSON loader ===========================================================
 
    // Room Factory. Allow only Factory full access to privates of template =========
@@ -64,15 +95,91 @@ private:
   float kRoomWidth_;
   float kNSDoorWidth_, kEWDoorWidth_;
   float kNSDoorBegin_, kEWDoorBegin_;
+  RoomBounds kBounds_; // Same dimensions, handed to every generated room
 
   std::map<std::string, RoomTemplate> kRoomTemplates_;
   std::set<std::string> kIds_;
+  std::vector<std::string> kIdList_; // Same ids in the same order, indexed as templates are in the tables below
   size_t kTemplateCounts_;
 
+  std::vector<float> kTemplateWeights_;
+  AliasTable kTemplateAlias_; // Weighted choice of templates of rooms chosen freely
+  TemplateAdjacency kAdjacency_; // Templates allowed next to each other, for rooms fitted to their neighbours
+
+  uint64_t kSeed_; // Seed of the map. Same seed, same rooms in the same places.
+  size_t kRoomCapacity_; // Rooms kept before distant ones are evicted. 0 if unbounded.
+
   glm::vec2 kEntryPosition_;
   // End of Effectively Constant Fields ================================================================================
 
+  // Owner of every generated room. Held by pointer, so that rooms keep their arena when the factory is moved.
+  std::unique_ptr<RoomArena> arena_;
+
+  // Generation state shared by every room of the factory. Held by pointer, as the arena is.
+  struct GenerationState {
+    std::atomic<uint64_t> draw_count_{0}; // Draws of RandomId and rooms generated on their own, each a fresh key
+    PinnedTemplates pinned_templates_; // Keys of rooms generated from an explicit template, looked up without a lock.
+                                       //  Dropped once no room linked to the player can lead back.
+  };
+  std::unique_ptr<GenerationState> generation_;
+
+  // Templates indexed by LoadJsonLazily, whose walls are read on first use. Held by pointer, as the arena is.
+  struct LazyTemplates {
+    std::string text_; // JSON the templates were indexed in. Dropped once every template is materialized.
+    std::vector<std::pair<size_t, size_t>> ranges_; // Byte range of the JSON of each template, by template index
+    std::vector<RoomTemplate*> templates_; // Every field but the walls and their partitions is loaded up front
+    std::unique_ptr<std::atomic<bool>[]> materialized_;
+    size_t materialized_count_{0};
+    std::mutex materialize_mutex_;
+    RoomBounds bounds_;
+
+    std::atomic<bool> stopping_{false};
+    std::thread background_; // Started by MaterializeInBackground. Joined before the templates go.
+
+    ~LazyTemplates();
+  };
+  std::unique_ptr<LazyTemplates> lazy_;
+
+  /**
+   * Generates a room of the template of given index, with given key, in the arena.
+   */
+  Room* BuildRoom(size_t template_index, RoomKey key, bool fitted) const;
+
+  /**
+   * Template of given index, materialized first if it was loaded lazily.
+   */
+  const RoomTemplate& GetTemplate(size_t template_index) const;
+
+  /**
+   * Reads the walls of the template of given index from the indexed JSON, and builds their partition.
+   * Safe to call from several threads at once. Does nothing if already done.
+   */
+  static void Materialize(LazyTemplates& lazy, size_t template_index);
+
+  /**
+   * Cleans up the walls of the template, then builds their partitions over the room. See CleanUpWalls.
+   */
+  static void BuildWallPartitions(RoomTemplate& room_template, const RoomBounds& bounds);
+
+  /**
+   * Index of the template of the room of given key. See TemplateIdOf.
+   */
+  size_t TemplateIndexOf(RoomKey key, bool fitted) const;
+
+  // Template Loading ==================================================================================================
+  // Shared by the JSON and pack loaders. Dimensions come first, and templates are compiled once all are added.
+  void SetDimensions(float width, float height, float ns_door_width, float ew_door_width);
+  void SetMapFields(const json& json); // Dimensions, entry position, seed and capacity, as named in the JSON
+  static void SetTemplateFields(const json& json, RoomTemplate& room_template); // Every field of a template but walls
+  void AddTemplate(const std::string& id, RoomTemplate room_template);
+  void CompileTemplates();
+  // End of Template Loading ===========================================================================================
+
 public:
+  // Constructors ======================================================================================================
+  RoomFactory();
+  // End of Constructors ===============================================================================================
+
   // Getters ===========================================================================================================
 
   // Geometric Map Characteristics Getters =====================================================
@@ -89,15 +196,52 @@ public:
   float GetEWPortalEnd() const;
 
   const glm::vec2& GetEntryPosition() const;
+
+  const RoomBounds& GetBounds() const;
   // End of Geometric Map Characteristics Getters ==============================================
 
 
   // Template Characteristics Getters ==========================================================
   size_t RoomTemplateCount() const;
   const std::set<std::string>& GetAvailableIds() const;
+
+  /**
+   * Draws the next id of a sequence determined by the seed. Safe to call from several threads at once.
+   */
   const std::string& RandomId() const;
+
+  /**
+   * Id of the template of the room of given key.
+   *    Template a room was explicitly generated from if any, otherwise chosen by hash of the seed and the key,
+   *    with chance proportional to its weight.
+   * Rooms alternate between chosen freely and fitted, so that the neighbours of a fitted room are all chosen freely,
+   *    and their templates known from their keys alone. A fitted room only takes templates allowed next to all of them.
+   *    Should no template be allowed next to all, the rules of its neighbours are applied in the order of Direction,
+   *    each unless it would leave no template.
+   * @param key Key of the room.
+   * @param fitted Whether the room is fitted to its neighbours.
+   */
+  const std::string& TemplateIdOf(RoomKey key, bool fitted = false) const;
   // End of Template Characteristics Getters ===================================================
 
+  uint64_t GetSeed() const;
+  size_t GetRoomCapacity() const;
+
+  /**
+   * @return Number of rooms generated and not evicted.
+   */
+  size_t GeneratedRoomCount() const;
+
+  /**
+   * @return Number of keys holding the template they were explicitly generated with.
+   */
+  size_t PinnedKeyCount() const;
+
+  /**
+   * Walls removed from every template as it was loaded. Materializes templates loaded lazily.
+   */
+  WallCleanupReport GetWallCleanupReport() const;
+
   // End of Getters ====================================================================================================
 
 
@@ -105,7 +249,7 @@ public:
   bool ContainsRoomId(const std::string& id) const;
 
   /**
-   * Generate room of given id.
+   * Generate room of given id, owned by the arena of the factory, at a fresh key.
    * If the id is not recognized, return pointer to nullptr.
    * @param id ID of the room template.
    * @return Room generated from the template of given id.
@@ -113,15 +257,73 @@ public:
    */
   Room* GenerateRoom(const std::string& id) const;
 
+  /**
+   * Generate room of given id at given key. The key keeps the id, should the room be evicted and generated again.
+   *    A key keeps the first id it was generated with. Generating it again with another id gives the first one.
+   * @param fitted Whether the room stands where rooms are fitted to their neighbours. See TemplateIdOf.
+   * @return Room generated from the template of given id. If id does not exist, return nullptr.
+   */
+  Room* GenerateRoom(const std::string& id, RoomKey key, bool fitted = false) const;
+
+  /**
+   * Generate the room of given key, from the template of the key.
+   * @param fitted Whether the room is fitted to its neighbours. See TemplateIdOf.
+   */
+  Room* GenerateRoomAt(RoomKey key, bool fitted) const;
+
   /**
    * Generate random room from available template.
    * @return Return pointer to a newly generated room from random id.
    */
   Room* GenerateRandomRoom() const;
+
+  /**
+   * Evicts the rooms farthest from the center once more than the room capacity are generated,
+   *    keeping half the capacity, closest first through the links.
+   * Links of kept rooms to evicted ones are cut, so those are generated again, identically, when entered.
+   * Evicted rooms not linked to the center in any way can never be entered again, and their keys forget their ids.
+   * Rooms generated from the factory must not be in use elsewhere while evicting, and evicted rooms not at all.
+   * @param center Room the player is in. Always kept.
+   * @return Number of evicted rooms.
+   */
+  size_t EvictDistantRooms(const Room* center);
   // End of Template Methods ===========================================================================================
 
+  // Template Pack ===================================================================================================
+  /**
+   * Loads every template of the pack into a factory that has none yet, as from_json would load their JSON.
+   */
+  void LoadPack(const TemplatePack& pack);
+
+  /**
+   * Writes the templates of the factory as a pack. See TemplatePack.
+   */
+  void WritePack(std::ostream& out) const;
+  // End of Template Pack ==============================================================================================
+
+  // Lazy JSON Loader ==================================================================================================
+  /**
+   * Loads the map of given JSON into a factory that has no templates yet, as from_json would,
+   *    but leaves the walls of each template in the JSON until a room of the template is first generated.
+   * The JSON is read in a single pass, which keeps every other field and where the JSON of each template lies,
+   *    without building the whole document.
+   */
+  void LoadJsonLazily(std::istream& in);
+
+  /**
+   * Materializes every template loaded lazily on a thread of its own, so that rooms generated later find them ready.
+   */
+  void MaterializeInBackground();
+
+  /**
+   * @return Whether the walls of the template of given id are loaded. Always true unless loaded lazily.
+   */
+  bool IsMaterialized(const std::string& id) const;
+  // End of Lazy JSON Loader ===========================================================================================
+
   // JSON Loader =======================================================================================================
   friend void from_json(const json& json, RoomFactory& room_factory);
+  friend void from_json(const json& json, RoomTemplate& room_template);
   // End of JSON Loader ================================================================================================
 };
 
@@ -0,0 +1,30 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_ROOM_KEY_H
+#define NONEUCLIDEAN_RAY_CASTER_ROOM_KEY_H
+
+#include <cstdint>
+
+namespace room_explorer {
+
+/**
+ * Key of the place of a room in the map, derived from the key of the room it was entered from.
+ *    Unlike its id in the arena, a room keeps its key when it is evicted and generated again.
+ */
+typedef uint64_t RoomKey;
+
+/**
+ * Scrambles every bit of the key into every other. A bijection, undone by UnmixKey.
+ */
+RoomKey MixKey(RoomKey key);
+
+/**
+ * @return Key k such that MixKey(k) is the given key.
+ */
+RoomKey UnmixKey(RoomKey key);
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_ROOM_KEY_H
@@ -0,0 +1,91 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_TEMPLATE_ADJACENCY_H
+#define NONEUCLIDEAN_RAY_CASTER_TEMPLATE_ADJACENCY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Which templates may sit on each side of each template, compiled into one bitset per template and side.
+ *    Sides are indexed as Direction is, so opposite sides are paired: north and south, east and west.
+ *    Templates are indexed in the order of the factory ids.
+ */
+class TemplateAdjacency {
+public:
+  static const size_t kSideCount = 4;
+
+  /**
+   * Rules a template declares on its own sides.
+   */
+  struct TemplateSides {
+    bool open_[kSideCount]{true, true, true, true}; // Whether the door of the side may be walked through
+    bool ruled_[kSideCount]{false, false, false, false}; // Whether only the allowed templates may sit on the side
+    std::vector<size_t> allowed_[kSideCount];
+  };
+
+  // Constructors =============================================================
+  TemplateAdjacency();
+
+  /**
+   * Two templates may sit side by side only if each allows the other, and the doors between them are both open
+   *    or both closed.
+   * @param sides Rules of every template.
+   */
+  explicit TemplateAdjacency(const std::vector<TemplateSides>& sides);
+  // End of Constructors ======================================================
+
+  // Getters ==================================================================
+  size_t TemplateCount() const;
+
+  /**
+   * @return Number of 64 bit words in a mask of templates.
+   */
+  size_t WordCount() const;
+
+  /**
+   * @return Whether the other template may sit on given side of the template.
+   */
+  bool Allows(size_t index, size_t side, size_t other_index) const;
+
+  /**
+   * @return Mask of every template.
+   */
+  std::vector<uint64_t> FullMask() const;
+  // End of Getters ===========================================================
+
+  /**
+   * Keeps in the mask only the templates which may sit on given side of the template.
+   * @return False, leaving the mask as it was, if no template of the mask may.
+   */
+  bool Restrict(std::vector<uint64_t>& mask, size_t index, size_t side) const;
+
+  /**
+   * Picks a template that may sit on given sides of given templates, with chance proportional to its weight,
+   *    or uniformly if none of those left has any weight.
+   *    Sides restrict the templates in turn, each skipped if it would leave none, as Restrict does.
+   *    Allocates nothing. Costs a pass over the mask words per side, then two over the templates left.
+   * @param indices Templates next to the one picked.
+   * @param sides Side of each of those templates the one picked would sit on.
+   * @param weights Weight of every template.
+   * @param bits Uniformly distributed bits.
+   */
+  size_t PickFitted(const size_t (&indices)[kSideCount], const size_t (&sides)[kSideCount],
+                    const std::vector<float>& weights, uint64_t bits) const;
+
+private:
+  size_t template_count_;
+  size_t word_count_;
+  std::vector<uint64_t> masks_; // Word w of the mask of side s of template t at (t * kSideCount + s) * word_count_ + w
+
+  const uint64_t* Mask(size_t index, size_t side) const;
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_TEMPLATE_ADJACENCY_H
@@ -0,0 +1,133 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_TEMPLATE_PACK_H
+#define NONEUCLIDEAN_RAY_CASTER_TEMPLATE_PACK_H
+
+#include <exceptions/room_explorer_exception.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Map-wide fields of a pack, at its very start.
+ */
+struct TemplatePackHeader {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t byte_order_; // kByteOrderMark as written. Packs of the other byte order read it reversed and are refused.
+
+  float room_width_, room_height_;
+  float ns_door_width_, ew_door_width_;
+  float entry_x_, entry_y_;
+  uint64_t seed_;
+  uint64_t room_capacity_;
+
+  uint32_t template_count_;
+  uint32_t wall_count_; // Of every template together
+  uint32_t neighbour_count_; // Of every rule of every template together
+  uint32_t string_size_;
+};
+
+/**
+ * Fields of one template, in the order of the ids.
+ */
+struct TemplatePackEntry {
+  uint32_t id_offset_, id_length_; // Within the strings of the pack
+  uint32_t first_wall_, wall_count_; // Within the wall arrays of the pack
+  float weight_;
+  uint32_t flags_; // kUsesBspFlag, and open and ruled flags of each side
+  uint32_t first_neighbour_[4], neighbour_count_[4]; // Templates allowed on each ruled side, indexed by Direction
+};
+
+/**
+ * Everything a pack holds, as the compiler gathers it before writing.
+ */
+struct TemplatePackContents {
+  TemplatePackHeader header_; // Magic, version and counts are filled in when written
+  std::vector<TemplatePackEntry> entries_;
+  std::vector<float> head_x_, head_y_, tail_x_, tail_y_;
+  std::vector<uint32_t> neighbours_;
+  std::string strings_;
+};
+
+/**
+ * Room templates compiled ahead of time into a single binary file, read in place once mapped into memory.
+ * Layout, with every array tightly packed and 4 byte aligned:
+ *    header | entries[template_count] | head_x, head_y, tail_x, tail_y [wall_count each]
+ *           | neighbours[neighbour_count] | strings[string_size]
+ * Walls are kept as arrays of each coordinate, so that loading a template reads them straight from the mapping.
+ */
+class TemplatePack {
+public:
+  static const char kMagic[8];
+  static const uint32_t kVersion = 1;
+  static const uint32_t kByteOrderMark = 0x01020304;
+
+  static const uint32_t kUsesBspFlag = 1;
+  static uint32_t OpenSideFlag(size_t side);
+  static uint32_t RuledSideFlag(size_t side);
+
+  // Constructors =============================================================
+  /**
+   * Maps the pack at given path into memory, and checks that every part of it lies within the file.
+   *    Throws InvalidTemplatePackException if it cannot be read or is not a pack of this version.
+   */
+  explicit TemplatePack(const std::string& path);
+  ~TemplatePack();
+
+  // Pack owns its mapping
+  TemplatePack(const TemplatePack&) = delete;
+  TemplatePack& operator=(const TemplatePack&) = delete;
+  // End of Constructors ======================================================
+
+  /**
+   * @return Whether the file at given path starts as a pack does, as opposed to template JSON.
+   */
+  static bool IsPack(const std::string& path);
+
+  /**
+   * Writes the contents as a pack.
+   */
+  static void Write(const TemplatePackContents& contents, std::ostream& out);
+
+  // Getters ==================================================================
+  const TemplatePackHeader& GetHeader() const;
+  const TemplatePackEntry& GetEntry(size_t index) const;
+  std::string GetId(size_t index) const;
+
+  const float* GetHeadX() const;
+  const float* GetHeadY() const;
+  const float* GetTailX() const;
+  const float* GetTailY() const;
+  const uint32_t* GetNeighbours() const;
+  // End of Getters ===========================================================
+
+private:
+  const char* data_{nullptr};
+  size_t size_{0};
+  std::vector<char> buffer_; // Holds the file where it cannot be mapped
+
+  const TemplatePackEntry* entries_{nullptr};
+  const float* head_x_{nullptr};
+  const float* head_y_{nullptr};
+  const float* tail_x_{nullptr};
+  const float* tail_y_{nullptr};
+  const uint32_t* neighbours_{nullptr};
+  const char* strings_{nullptr};
+
+  /**
+   * Locates every array of the mapped pack, and throws unless each of them, and each range within, fits the file.
+   */
+  void Validate();
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_TEMPLATE_PACK_H
@@ -0,0 +1,118 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_THREAD_POOL_H
+#define NONEUCLIDEAN_RAY_CASTER_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Persistent pool of worker threads that splits index ranges across per-thread work queues.
+ * Each thread works through its own queue from the front, and once it runs out,
+ *    steals from the back of another thread's queue.
+ *    This keeps neighbouring indices on the same thread while still balancing uneven work,
+ *    such as strips that pass through many portals next to strips that hit a near wall.
+ * The calling thread also takes part in the work, so a pool of n threads uses n + 1 cores.
+ * Queues keep their storage between jobs, so that running the same job again allocates nothing.
+ */
+class WorkStealingPool {
+public:
+  /**
+   * Spawns the worker threads. They sleep until work is given.
+   * @param thread_count Number of workers, not counting the calling thread.
+   */
+  explicit WorkStealingPool(size_t thread_count);
+
+  /**
+   * Wakes and joins all the worker threads.
+   */
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  size_t ThreadCount() const;
+
+  /**
+   * Runs task over every index in [0, count), in chunks of at most grain indices.
+   * Blocks until every chunk is done.
+   *    If any chunk throws, the first exception is re-thrown here once all the chunks have finished.
+   * Not re-entrant. Only a single thread may call this at a time.
+   * @param count Number of indices.
+   * @param grain Maximum number of indices handed to a thread at once. 0 is treated as 1.
+   * @param task Called with [begin, end) of each chunk. Held by reference, so it is never copied.
+   */
+  template<typename Task>
+  void ParallelFor(size_t count, size_t grain, const Task& task) {
+    // std::function holds a reference inline, where a lambda with many captures would be allocated
+    RunJob(count, grain, std::function<void(size_t, size_t)>(std::cref(task)));
+  }
+
+private:
+  /**
+   * Queue of [begin, end) index ranges owned by a single thread.
+   *    Ranges are only added before a job starts, so the queue is a vector taken from at both ends.
+   */
+  struct WorkQueue {
+    std::mutex mutex_;
+    std::vector<std::pair<size_t, size_t>> ranges_;
+    size_t front_{0}, back_{0}; // Ranges [front_, back_) are left to take
+  };
+
+  std::vector<std::thread> workers_;
+  // One queue per worker, with the last queue belonging to the calling thread.
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+
+  // Shared State of the Current Job ======================================
+  std::mutex state_mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+
+  std::atomic<const std::function<void(size_t, size_t)>*> task_;
+  size_t generation_; // Incremented for each job, so that sleeping workers know new work arrived
+  bool stopping_;
+
+  std::atomic<size_t> remaining_chunks_;
+  std::exception_ptr first_exception_;
+  // End of Shared State of the Current Job ===============================
+
+  /**
+   * Runs the job of ParallelFor, once its task is wrapped.
+   */
+  void RunJob(size_t count, size_t grain, const std::function<void(size_t, size_t)>& task);
+
+  /**
+   * Loop of each worker thread. Sleeps until a new job or shutdown.
+   * @param queue_index Index of the worker's own queue.
+   */
+  void WorkerLoop(size_t queue_index);
+
+  /**
+   * Runs chunks from the own queue, then from other queues, until no chunk is left anywhere.
+   * @param queue_index Index of the calling thread's own queue.
+   */
+  void RunChunks(size_t queue_index);
+
+  /**
+   * Takes a chunk from the front of the own queue, or failing that, from the back of another queue.
+   * @param queue_index Index of the calling thread's own queue.
+   * @param range Updated to the taken chunk.
+   * @return False if every queue is empty.
+   */
+  bool TakeChunk(size_t queue_index, std::pair<size_t, size_t>& range);
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_THREAD_POOL_H
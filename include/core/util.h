@@ -5,7 +5,10 @@
 #ifndef NONEUCLIDEAN_RAY_CASTER_UTIL_H
 #define NONEUCLIDEAN_RAY_CASTER_UTIL_H
 
-#include <cinder/gl/gl.h>
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <limits>
 
 // TODO look into quaternions
 namespace room_explorer {
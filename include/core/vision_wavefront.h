@@ -0,0 +1,94 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_VISION_WAVEFRONT_H
+#define NONEUCLIDEAN_RAY_CASTER_VISION_WAVEFRONT_H
+
+#include <core/hit_package.h>
+#include <core/room.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Casts many rays from a single position room by room, rather than ray by ray.
+ *    Rays advance in waves. Each wave traces every ray standing in a room through that room, before any ray moves on.
+ *    Rooms of a wave are visited grouped by template, so that the walls of a template stay in cache
+ *    while every ray in any of its rooms is traced.
+ *    Rays leaving through a portal are queued on the room they enter, for the next wave.
+ * Each package is the same as Room::GetVisible gives for its ray alone.
+ * Queues, and the table finding the queue of a room, are kept between casts.
+ *    Once they have grown to the rooms and rays of a view, casting it again allocates nothing.
+ *    A wavefront must not be used by several threads at once.
+ */
+class VisionWavefront {
+public:
+  /**
+   * Casts every ray from the room.
+   * @param room Room the rays begin in.
+   * @param ray_pos Initial position of every ray.
+   * @param ray_dirs Directions of the rays.
+   * @param ray_count Number of rays.
+   * @param visible_range Maximum distance of a hit from the initial position.
+   * @param budget Limits on portals each ray may pass.
+   * @param packages Set to the package of each ray, in the same order.
+   * @param point_inclusive Whether the wall on which the rays begin should be considered a hit.
+   */
+  void Cast(Room* room, const glm::vec2& ray_pos, const glm::vec2* ray_dirs, size_t ray_count, float visible_range,
+            const PortalBudget& budget, HitPackage* packages, bool point_inclusive = true);
+
+private:
+  // Ray standing in a room, as it entered it
+  struct WaveRay {
+    size_t ray_; // Index into the directions and packages
+    glm::vec2 entry_pos_;
+    float traveled_;
+  };
+
+  // Rays of a wave standing in the same room
+  struct RoomQueue {
+    Room* room_;
+    std::vector<WaveRay> rays_;
+  };
+
+  // Queue of a room in the next wave. Only slots stamped with the current wave are in use.
+  struct QueueSlot {
+    const Room* room_;
+    size_t wave_;
+    size_t queue_; // Index into next_wave_
+  };
+
+  static const size_t kFirstQueueSlots = 64; // Power of two, as every size of the table
+
+  // Queues of the current wave and of the next. Only the first counts are in use, the rest keep their capacity.
+  std::vector<RoomQueue> wave_, next_wave_;
+  size_t wave_count_{0}, next_wave_count_{0};
+  std::vector<QueueSlot> queue_slots_; // Open addressing table, probed linearly. Emptied by moving to a new stamp.
+  size_t wave_stamp_{0}; // Stamp of the next wave, never 0 once casting
+  std::vector<size_t> order_; // Queues of the current wave, in the order they are traced
+
+  /**
+   * Finds the queue of the room in the next wave, adding an empty one if the room has none yet.
+   * @return Index of the queue in next_wave_.
+   */
+  size_t NextWaveQueue(Room* room);
+
+  /**
+   * Doubles the table of queue slots, moving over the slots of the next wave.
+   */
+  void GrowQueueSlots();
+
+  /**
+   * @return Hash of the room, to be masked down to a slot of the table.
+   */
+  static size_t SlotOf(const Room* room);
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_VISION_WAVEFRONT_H
@@ -8,7 +8,7 @@
 #include <core/hits.h>
 #include <core/util.h>
 
-#include "cinder/gl/gl.h"
+#include <glm/glm.hpp>
 
 #include <nlohmann/json.hpp>
 
@@ -101,6 +101,15 @@ public:
    * @return Hit summary of ray-intersection with the wall.
    */
   Hit GetWallHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir) const;
+
+  /**
+   * Same hit as GetWallHit of the wall from head to tail, given what it would otherwise compute for every hit.
+   * @param wall_dir Tail - head.
+   * @param wall_length Length of wall_dir.
+   * @param ray_length Length of ray_dir.
+   */
+  static Hit GetSegmentHit(const glm::vec2& head, const glm::vec2& tail, const glm::vec2& wall_dir, float wall_length,
+                           const glm::vec2& ray_pos, const glm::vec2& ray_dir, float ray_length);
   // End of Geometric Functions ===============================================
 
   // Comparison Overloading ===================================================
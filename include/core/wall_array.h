@@ -0,0 +1,133 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_WALL_ARRAY_H
+#define NONEUCLIDEAN_RAY_CASTER_WALL_ARRAY_H
+
+#include <core/hits.h>
+#include <core/wall.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <set>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace room_explorer {
+
+/**
+ * Allocator handing out memory aligned to a cache line, so that arrays of walls start on a line of their own.
+ */
+template <typename T>
+struct CacheAlignedAllocator {
+  typedef T value_type;
+  static const size_t kAlignment = 64;
+
+  CacheAlignedAllocator() = default;
+  template <typename U>
+  CacheAlignedAllocator(const CacheAlignedAllocator<U>&) {}
+
+  T* allocate(size_t count) {
+    void* memory{nullptr};
+#ifdef _WIN32
+    memory = _aligned_malloc(count * sizeof(T), kAlignment);
+#else
+    if (posix_memalign(&memory, kAlignment, count * sizeof(T)) != 0) {
+      memory = nullptr;
+    }
+#endif
+    if (memory == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(memory);
+  }
+
+  void deallocate(T* memory, size_t) {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const CacheAlignedAllocator<T>&, const CacheAlignedAllocator<U>&) {
+  return true;
+}
+template <typename T, typename U>
+bool operator!=(const CacheAlignedAllocator<T>&, const CacheAlignedAllocator<U>&) {
+  return false;
+}
+
+/**
+ * Walls laid out as one contiguous array per field, with what never changes after load computed once.
+ * Each array starts on a cache line, and is padded with zeros to a multiple of kPaddingWidth walls,
+ *    so that a kernel may read whole blocks of walls at once.
+ * Hits are exactly those of Wall::GetWallHit. End points still decide every hit, with the same exact predicates.
+ *    Only the direction and length of each wall, and the length of the ray, are no longer computed for every hit.
+ * Walls are also kept whole, in the same order, for callers reading them one by one.
+ */
+class WallArray {
+public:
+  typedef std::vector<float, CacheAlignedAllocator<float>> FloatArray;
+
+  static const size_t kPaddingWidth = 16;
+
+  // Constructors =============================================================
+  WallArray() = default;
+
+  /**
+   * @param walls Walls in the order they are to be indexed in.
+   */
+  explicit WallArray(const std::vector<Wall>& walls);
+
+  /**
+   * Walls are indexed in the iteration order of the set.
+   */
+  explicit WallArray(const std::set<Wall>& walls);
+  // End of Constructors ======================================================
+
+  // Getters ==================================================================
+  size_t Size() const;
+  size_t PaddedSize() const;
+
+  const std::vector<Wall>& GetWalls() const;
+
+  // Start of each array. Every array holds PaddedSize() values.
+  const float* HeadX() const;
+  const float* HeadY() const;
+  const float* TailX() const;
+  const float* TailY() const;
+  const float* DirectionX() const; // Tail - head
+  const float* DirectionY() const;
+  const float* Length() const; // Length of the direction
+  // End of Getters ===========================================================
+
+  // Geometric Functions ======================================================
+  /**
+   * Same hit as Wall::GetWallHit of the wall of given index.
+   * @param ray_length Length of ray_dir. Computed once for every wall the ray is tested against.
+   */
+  Hit GetWallHit(size_t index, const glm::vec2& ray_pos, const glm::vec2& ray_dir, float ray_length) const;
+  // End of Geometric Functions ===============================================
+
+private:
+  std::vector<Wall> walls_;
+
+  FloatArray head_x_, head_y_;
+  FloatArray tail_x_, tail_y_;
+  FloatArray direction_x_, direction_y_;
+  FloatArray length_;
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_WALL_ARRAY_H
@@ -0,0 +1,118 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_WALL_BATCH_H
+#define NONEUCLIDEAN_RAY_CASTER_WALL_BATCH_H
+
+#include <core/hit_package.h>
+#include <core/wall.h>
+#include <core/wall_array.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Instruction sets that the batch wall kernel can run on.
+ *    The best one supported by the running CPU is picked on start-up.
+ */
+enum WallKernel {
+  kScalarKernel,
+  kSSE2Kernel,
+  kAVX2Kernel,
+  kAVX512Kernel
+};
+
+/**
+ * Structure-of-arrays copy of the walls of a room template, for testing a ray against many walls at once.
+ * A vectorized kernel first rules out, 16 walls at a time, every wall the ray clearly cannot hit.
+ *    The rejection is conservative, with a margin far larger than the epsilon of the scalar geometry,
+ *    so that a wall is only skipped if Wall::GetWallHit would have returned no hit anyway.
+ * The few remaining walls are then resolved by the same geometry as Wall::GetWallHit,
+ *    so the hits are exactly the same as looping over every wall.
+ */
+class WallBatch {
+public:
+  static const size_t kBlockWidth = 16; // Walls tested by a single kernel call
+
+  // Constructors =============================================================
+  WallBatch() = default;
+
+  /**
+   * Copies the walls into padded arrays.
+   *    Walls keep the iteration order of the set, so that ties between hits resolve the same way.
+   * @param walls Walls of a room template.
+   */
+  explicit WallBatch(const std::set<Wall>& walls);
+
+  /**
+   * Copies the walls into padded arrays, keeping the order of the vector.
+   * @param walls Walls in the order they should be tested in.
+   */
+  explicit WallBatch(const std::vector<Wall>& walls);
+  // End of Constructors ======================================================
+
+  // Getters ==================================================================
+  size_t WallCount() const;
+
+  const std::vector<Wall>& GetWalls() const;
+  // End of Getters ===========================================================
+
+  // Batch Geometry ===========================================================
+  /**
+   * Finds which walls of a block of kBlockWidth walls the ray may hit.
+   *    Lanes beyond the last wall are never set.
+   * @param block_begin Index of the first wall of the block. Must be a multiple of kBlockWidth.
+   * @param ray_pos Initial position of the ray.
+   * @param ray_dir Direction of the ray. Need not be normalized.
+   * @return Bit i is set if wall block_begin + i may be hit.
+   */
+  uint32_t CandidateMask(size_t block_begin, const glm::vec2& ray_pos, const glm::vec2& ray_dir) const;
+
+  /**
+   * Adds hits of the ray with every wall within the visible range into the package.
+   *    Same result as adding Wall::GetWallHit of every wall in order.
+   * @param ray_pos Initial position of the ray.
+   * @param ray_dir Direction of the ray. Need not be normalized.
+   * @param visible_range Maximum distance of a hit to be added.
+   * @param package Package to add hits into.
+   */
+  void AddWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                   HitPackage& package) const;
+  // End of Batch Geometry ====================================================
+
+  // Kernel Selection =========================================================
+  /**
+   * @return Kernel currently used by every batch.
+   */
+  static WallKernel GetActiveKernel();
+
+  /**
+   * Checks if the running CPU is able to run the kernel.
+   * @param kernel Kernel being checked.
+   * @return True if supported. Scalar kernel is always supported.
+   */
+  static bool KernelSupported(WallKernel kernel);
+
+  /**
+   * Overrides the kernel chosen on start-up. Meant for tests and benchmarks.
+   *    Must not be called while rays are being cast.
+   * @param kernel Kernel to use from now on.
+   * @return False, leaving kernel unchanged, if the CPU does not support the kernel.
+   */
+  static bool SetActiveKernel(WallKernel kernel);
+  // End of Kernel Selection ==================================================
+
+private:
+  // Padded to a multiple of kBlockWidth, so that every block reads whole
+  WallArray walls_;
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_WALL_BATCH_H
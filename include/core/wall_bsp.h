@@ -0,0 +1,141 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_WALL_BSP_H
+#define NONEUCLIDEAN_RAY_CASTER_WALL_BSP_H
+
+#include <core/hit_package.h>
+#include <core/hits.h>
+#include <core/room_bounds.h>
+#include <core/wall.h>
+#include <core/wall_array.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Binary space partition of the walls of a room template, for visiting walls front to back along a ray.
+ * Each node splits the plane along the line of one of the walls.
+ *    Walls straddling the line are split into fragments, one on each side.
+ *    Fragments keep the index of the wall they came from, and hits are always those of the original wall,
+ *    so that texture indices run along the whole wall.
+ * Rays visit the side of each line they start on, then walls on the line, then the other side.
+ *    Sides are widened by a small margin, so that rounding can never skip a wall the ray hits.
+ */
+class WallBsp {
+public:
+  static const uint32_t kNoNode = UINT32_MAX;
+  static const size_t kSplitterCandidates = 8; // Walls tried as the splitter of each node
+
+  // Constructors =============================================================
+  WallBsp();
+
+  /**
+   * Compiles the tree.
+   * @param walls Walls of a room template.
+   * @param bounds Dimensions of the room.
+   */
+  WallBsp(const std::vector<Wall>& walls, const RoomBounds& bounds);
+
+  /**
+   * Walls are kept in the iteration order of the set.
+   */
+  WallBsp(const std::set<Wall>& walls, const RoomBounds& bounds);
+  // End of Constructors ======================================================
+
+  // Getters ==================================================================
+  size_t WallCount() const;
+  size_t NodeCount() const;
+  size_t FragmentCount() const; // Walls of every node, counting each piece of a split wall
+
+  /**
+   * @return Walls in the order the tree was built from.
+   */
+  const std::vector<Wall>& GetWalls() const;
+  // End of Getters ===========================================================
+
+  // Tree Geometry ============================================================
+  /**
+   * Adds hits of the ray with every wall within the visible range into the package, nearest walls first.
+   *    Same hits as adding Wall::GetWallHit of every wall,
+   *    except that between walls hit at exactly the same distance, the first one visited is kept.
+   * @param ray_pos Initial position of the ray.
+   * @param ray_dir Direction of the ray. Need not be normalized.
+   * @param visible_range Maximum distance of a hit to be added.
+   * @param exit_distance Distance at which the ray leaves the room through an opaque wall or a portal.
+   *                      Walls within the room cannot be hit past it, so the traversal stops there.
+   *                      Ignored if some wall reaches outside of the room.
+   * @param package Package to add hits into.
+   */
+  void AddWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range, float exit_distance,
+                   HitPackage& package) const;
+
+  /**
+   * Finds the nearest wall hit, skipping every part of the tree behind it.
+   *    Same as the first hit of a package holding the hits of every wall.
+   * @param ray_pos Initial position of the ray.
+   * @param ray_dir Direction of the ray. Need not be normalized.
+   * @param visible_range Maximum distance of the hit.
+   * @return Nearest hit. Invalid hit if no wall is hit within range.
+   */
+  Hit NearestWallHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range) const;
+  // End of Tree Geometry =====================================================
+
+private:
+  struct Node {
+    glm::vec2 point_; // Point on the splitting line
+    glm::vec2 normal_; // Unit normal of the line, pointing to the front side. Zero for a leaf.
+    uint32_t front_;
+    uint32_t back_;
+    uint32_t walls_begin_; // Walls on the line, or every wall of a leaf, in node_walls_
+    uint32_t walls_end_;
+  };
+
+  struct Fragment {
+    glm::vec2 head_;
+    glm::vec2 tail_;
+    uint32_t wall_;
+  };
+
+  /**
+   * Ray as seen by a traversal, with the state kept across nodes.
+   */
+  struct Traversal;
+
+  WallArray walls_; // Given order
+  std::vector<Node> nodes_; // Root is the first node, if any
+  std::vector<uint32_t> node_walls_;
+  size_t fragment_count_;
+
+  bool walls_inside_room_;
+  glm::vec2 room_size_;
+  float margin_; // Distance within which a wall counts as on a line, and by which sides are widened
+
+  /**
+   * Builds the subtree over the fragments.
+   * @return Index of the subtree root. kNoNode if there are no fragments.
+   */
+  uint32_t Build(std::vector<Fragment>& fragments);
+
+  /**
+   * Visits the subtree front to back over the part of the ray in [t_min, t_max], as multiples of the direction.
+   * @return False once the traversal has stopped early.
+   */
+  bool Visit(uint32_t node_index, float t_min, float t_max, Traversal& traversal) const;
+
+  /**
+   * Tests the walls of the node, each wall only the first time it is met.
+   * @return False once the traversal has stopped early.
+   */
+  bool VisitWalls(const Node& node, Traversal& traversal) const;
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_WALL_BSP_H
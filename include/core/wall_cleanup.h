@@ -0,0 +1,54 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_WALL_CLEANUP_H
+#define NONEUCLIDEAN_RAY_CASTER_WALL_CLEANUP_H
+
+#include <core/room_bounds.h>
+#include <core/wall.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Walls removed from a template by CleanUpWalls, by reason.
+ */
+struct WallCleanupReport {
+  size_t input_count_{0}; // Walls given
+  size_t degenerate_count_{0}; // Shorter than the tolerance
+  size_t boundary_count_{0}; // Lying on the room edge, away from the doors
+  size_t duplicate_count_{0}; // Covered by another wall on the same line
+  size_t merged_count_{0}; // Joined onto another wall on the same line, touching or overlapping it
+
+  /**
+   * @return Walls left after the cleanup.
+   */
+  size_t OutputCount() const;
+
+  WallCleanupReport& operator+=(const WallCleanupReport& report);
+};
+
+/**
+ * Fraction of the larger room dimension within which points are taken to be the same, or on the same line.
+ */
+const float kWallCleanupTolerance = .00001f;
+
+/**
+ * Removes walls that change no hit a ray could see, and joins walls that make up a single segment.
+ *    Walls of no length are dropped, and so are walls on the room edge that cover no door, as the edge hides them.
+ *    Walls on the same line that touch or overlap become a single wall spanning them all.
+ *    Joined walls take the direction of the longest of them, so texture index runs along the whole joined wall.
+ * Result depends only on the walls given, not on their order.
+ * @param walls Walls of a template.
+ * @param bounds Room the walls are in.
+ * @param report Counts of the walls removed.
+ * @return Walls left, in a fixed order.
+ */
+std::vector<Wall> CleanUpWalls(const std::vector<Wall>& walls, const RoomBounds& bounds, WallCleanupReport& report);
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_WALL_CLEANUP_H
@@ -0,0 +1,121 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_WALL_GRID_H
+#define NONEUCLIDEAN_RAY_CASTER_WALL_GRID_H
+
+#include <core/hit_package.h>
+#include <core/room_bounds.h>
+#include <core/wall.h>
+#include <core/wall_array.h>
+#include <core/wall_batch.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace room_explorer {
+
+/**
+ * Uniform grid over a room template, for testing a ray only against the walls near its path.
+ * Walls are sorted by the cell holding their middle, and laid out in that order for the batch kernel,
+ *    so that each block of kBlockWidth walls covers a small patch of the room.
+ * Each cell keeps the blocks with a wall passing through it.
+ *    Walls are registered in every cell they come within a small margin of,
+ *    so that rounding of the cell walk can never skip a wall the ray hits.
+ * A ray walks the cells it crosses with a DDA, marking the blocks of every visited cell.
+ *    Only marked blocks go through the batch kernel and Wall::GetWallHit.
+ *    Resulting hits are added in set order, so they are exactly the same as looping over every wall.
+ * Smaller templates keep a single cell and skip the walk altogether.
+ *    The batch kernel rules out a block of walls faster than the walk can, so the grid only pays off with many blocks.
+ */
+class WallGrid {
+public:
+  static const size_t kMaxCellsPerSide = 64;
+  static const size_t kMinGridWalls = 64 * WallBatch::kBlockWidth; // Fewer walls keep a single cell
+  static const size_t kWallsPerCell = WallBatch::kBlockWidth; // Target when picking the grid resolution
+
+  // Constructors =============================================================
+  WallGrid();
+
+  /**
+   * Builds the grid over the room, and over any wall reaching outside of it.
+   * @param walls Walls of a room template.
+   * @param bounds Dimensions of the room.
+   */
+  WallGrid(const std::vector<Wall>& walls, const RoomBounds& bounds);
+
+  /**
+   * Walls are kept in the iteration order of the set.
+   */
+  WallGrid(const std::set<Wall>& walls, const RoomBounds& bounds);
+  // End of Constructors ======================================================
+
+  // Getters ==================================================================
+  size_t WallCount() const;
+  size_t CellsX() const;
+  size_t CellsY() const;
+
+  /**
+   * @return Walls in the order the grid was built from.
+   */
+  const std::vector<Wall>& GetWalls() const;
+
+  /**
+   * @return True if every wall lies within the room, so nothing can be hit past the room exit.
+   */
+  bool WallsInsideRoom() const;
+  // End of Getters ===========================================================
+
+  // Grid Geometry ============================================================
+  /**
+   * Adds hits of the ray with every wall within the visible range into the package.
+   *    Same result as adding Wall::GetWallHit of every wall in order.
+   * @param ray_pos Initial position of the ray.
+   * @param ray_dir Direction of the ray. Need not be normalized.
+   * @param visible_range Maximum distance of a hit to be added.
+   * @param exit_distance Distance at which the ray leaves the room through an opaque wall or a portal.
+   *                      Walls within the room cannot be hit past it, so the walk stops there.
+   *                      Ignored if some wall reaches outside of the room.
+   * @param package Package to add hits into.
+   */
+  void AddWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range, float exit_distance,
+                   HitPackage& package) const;
+  // End of Grid Geometry =====================================================
+
+private:
+  WallArray walls_; // Given order
+  WallBatch batch_; // Same walls, sorted by cell
+  std::vector<uint32_t> set_indices_; // Index in walls_ of each wall of batch_
+
+  bool walls_inside_room_;
+  glm::vec2 room_size_;
+
+  glm::vec2 origin_; // SW corner of the grid
+  glm::vec2 cell_size_;
+  size_t cells_x_, cells_y_;
+  float margin_; // Distance within which a wall is registered in a cell
+
+  // Blocks of cell (x, y) are cell_blocks_[cell_offsets_[i], cell_offsets_[i + 1]), with i = y * cells_x_ + x
+  std::vector<uint32_t> cell_offsets_;
+  std::vector<uint32_t> cell_blocks_;
+
+  /**
+   * @return Index of the cell holding the point. Points outside of the grid go to the nearest cell.
+   */
+  size_t CellIndex(const glm::vec2& point) const;
+
+  /**
+   * Marks blocks of every cell the ray crosses up to the given parameter.
+   * @param t_limit Furthest point of the ray to walk to, as a multiple of ray_dir.
+   * @param blocks Bit set, one bit per block, to mark blocks into.
+   */
+  void CollectBlocks(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float t_limit, uint64_t* blocks) const;
+};
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_WALL_GRID_H
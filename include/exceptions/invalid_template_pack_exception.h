@@ -0,0 +1,24 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_INVALID_TEMPLATE_PACK_EXCEPTION_H
+#define NONEUCLIDEAN_RAY_CASTER_INVALID_TEMPLATE_PACK_EXCEPTION_H
+
+#include <exceptions/room_explorer_exception.h>
+
+namespace room_explorer {
+
+namespace exceptions {
+
+
+class InvalidTemplatePackException : public GeneralExplorerException {
+
+};
+
+
+} // namespace exceptions
+
+} // namespace room_explorer
+
+#endif //NONEUCLIDEAN_RAY_CASTER_INVALID_TEMPLATE_PACK_EXCEPTION_H
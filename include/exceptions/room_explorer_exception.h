@@ -22,4 +22,6 @@ class GeneralExplorerException : public std::exception {
 #endif //NONEUCLIDEAN_RAY_CASTER_ROOM_EXPLORER_EXCEPTION_H
 
 #include <exceptions/no_room_template_exception.h>
-#include <exceptions/invalid_direction_exception.h>
\ No newline at end of file
+#include <exceptions/invalid_direction_exception.h>
+#include <exceptions/invalid_template_pack_exception.h>
+#include <exceptions/invalid_template_weight_exception.h>
\ No newline at end of file
@@ -109,6 +109,8 @@ private:
   size_t ticks_; // Keeps track of number of updates performed
 
   std::set<int> held_keys_; // Keeps track of all the keys pressed simultaneously
+
+  FrameHitBuffer frame_hits_; // Every hit of the current frame. Reused every frame to avoid re-allocation.
   // End of State Handler Variables ====================================================================================
 
 
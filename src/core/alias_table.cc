@@ -0,0 +1,65 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/alias_table.h>
+
+namespace room_explorer {
+
+namespace {
+const uint64_t kFullThreshold = uint64_t{1} << 32;
+} // namespace
+
+// Constructors ========================================================================================================
+AliasTable::AliasTable() = default;
+
+AliasTable::AliasTable(const std::vector<float>& weights)
+    : thresholds_(weights.size(), kFullThreshold), aliases_(weights.size()) {
+  size_t count{weights.size()};
+  double total{0};
+  for (float weight : weights) {
+    total += weight;
+  }
+
+  // Heights scaled so that the average column is exactly full
+  std::vector<double> heights(count, 1);
+  if (total > 0) {
+    for (size_t i = 0; i < count; ++i) {
+      heights[i] = weights[i] * count / total;
+    }
+  }
+
+  std::vector<uint32_t> short_columns, tall_columns;
+  for (size_t i = 0; i < count; ++i) {
+    aliases_[i] = static_cast<uint32_t>(i);
+    (heights[i] < 1 ? short_columns : tall_columns).push_back(static_cast<uint32_t>(i));
+  }
+
+  // Each short column is topped up by a tall one, which becomes short itself once it has given enough
+  while (!short_columns.empty() && !tall_columns.empty()) {
+    uint32_t short_column{short_columns.back()};
+    short_columns.pop_back();
+    uint32_t tall_column{tall_columns.back()};
+
+    thresholds_[short_column] = static_cast<uint64_t>(heights[short_column] * kFullThreshold);
+    aliases_[short_column] = tall_column;
+    heights[tall_column] -= 1 - heights[short_column];
+    if (heights[tall_column] < 1) {
+      tall_columns.pop_back();
+      short_columns.push_back(tall_column);
+    }
+  }
+  // Columns left over are full, short only by rounding
+}
+// End of Constructors =================================================================================================
+
+size_t AliasTable::Sample(uint64_t bits) const {
+  size_t column{static_cast<size_t>(((bits >> 32) * thresholds_.size()) >> 32)};
+  return (bits & 0xFFFFFFFF) < thresholds_[column] ? column : aliases_[column];
+}
+
+size_t AliasTable::Size() const {
+  return thresholds_.size();
+}
+
+} // namespace room_explorer
@@ -0,0 +1,58 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/frame_hit_buffer.h>
+
+namespace room_explorer {
+
+// Constructors ========================================================================================================
+FrameHitBuffer::FrameHitBuffer()
+    : offsets_(1, 0) {}
+// End of Constructors =================================================================================================
+
+
+// Frame Building ======================================================================================================
+void FrameHitBuffer::Clear() {
+  // clear keeps capacity, so the next frame reuses the same memory
+  hits_.clear();
+  offsets_.resize(1);
+  offsets_[0] = 0;
+}
+
+void FrameHitBuffer::Reserve(size_t strip_count, size_t hit_count) {
+  offsets_.reserve(strip_count + 1);
+  hits_.reserve(hit_count);
+}
+
+void FrameHitBuffer::AppendStrip(const HitPackage& package) {
+  // Package is already ordered by distance
+  hits_.insert(hits_.end(), package.begin(), package.end());
+  offsets_.push_back(hits_.size());
+}
+// End of Frame Building ===============================================================================================
+
+
+// Getters =============================================================================================================
+size_t FrameHitBuffer::StripCount() const {
+  return offsets_.size() - 1;
+}
+
+size_t FrameHitBuffer::HitCount() const {
+  return hits_.size();
+}
+
+size_t FrameHitBuffer::StripHitCount(size_t strip) const {
+  return offsets_[strip + 1] - offsets_[strip];
+}
+
+const Hit* FrameHitBuffer::StripBegin(size_t strip) const {
+  return hits_.data() + offsets_[strip];
+}
+
+const Hit* FrameHitBuffer::StripEnd(size_t strip) const {
+  return hits_.data() + offsets_[strip + 1];
+}
+// End of Getters ======================================================================================================
+
+} // namespace room_explorer
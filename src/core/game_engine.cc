@@ -4,16 +4,24 @@
 
 #include <core/game_engine.h>
 
+#include <algorithm>
+
 using namespace room_explorer;
 
 using json = nlohmann::json;
 
-GameEngine::GameEngine(const std::string& room_template_path) {
-  // Factory must be loaded from json
-  json factory_json;
-  std::ifstream(room_template_path) >> factory_json;
-
-  factory_ = factory_json;
+GameEngine::GameEngine(const std::string& room_template_path)
+    : vision_schedule_(kWavefrontSchedule), max_portal_depth_(DEFAULT_MAX_PORTAL_DEPTH), max_rooms_per_frame_(0),
+      table_cos_(0), table_sin_(0) {
+  // Factory is loaded from a compiled pack if given one, otherwise from json.
+  // Walls of json templates are read as rooms of them are first generated, and in the background meanwhile.
+  if (TemplatePack::IsPack(room_template_path)) {
+    factory_.LoadPack(TemplatePack(room_template_path));
+  } else {
+    std::ifstream template_file(room_template_path);
+    factory_.LoadJsonLazily(template_file);
+    factory_.MaterializeInBackground();
+  }
 
   // Initial room will be generated from id "entry"
   current_room_ = factory_.GenerateRoom("entry");
@@ -24,33 +32,160 @@ GameEngine::GameEngine(const std::string& room_template_path) {
 }
 
 std::vector<HitPackage> GameEngine::GetVision(float cos, float sin, size_t half_resolution, float range_distance) {
-  std::vector<HitPackage> packages;
+  CastStrips(cos, sin, half_resolution, range_distance);
+
+  // Copied, so that the scratch keeps its capacity for the next frame. Only the returned vector is allocated.
+  return strip_packages_;
+}
+
+void GameEngine::GetVision(float cos, float sin, size_t half_resolution, float range_distance,
+                           FrameHitBuffer& frame) {
+  CastStrips(cos, sin, half_resolution, range_distance);
+
+  frame.Clear();
+  for (const HitPackage& package : strip_packages_) {
+    frame.AppendStrip(package);
+  }
+}
+
+void GameEngine::CastStrips(float cos, float sin, size_t half_resolution, float range_distance) {
+  size_t total_resolution{2 * half_resolution + 1};
+  UpdateStripTables(cos, sin, half_resolution);
+
+  // Every direction is the view direction rotated once by its own strip, from left-most to right-most.
+  //  No strip depends on another, and the loop is plain arithmetic over the tables.
+  strip_directions_.resize(total_resolution);
+  const float* strip_cos{strip_cos_.data()};
+  const float* strip_sin{strip_sin_.data()};
+  glm::vec2* directions{strip_directions_.data()};
+  float view_x{view_direction_.x};
+  float view_y{view_direction_.y};
+  for (size_t i = 0; i < total_resolution; ++i) {
+    directions[i].x = view_x * strip_cos[i] + view_y * strip_sin[i];
+    directions[i].y = -view_x * strip_sin[i] + view_y * strip_cos[i];
+  }
+
+  strip_packages_.resize(total_resolution);
+
+  // Each strip may enter at most its share of the rooms, so the frame enters no more than all of them
+  PortalBudget budget;
+  budget.max_portal_depth = max_portal_depth_;
+  if (max_rooms_per_frame_ != 0) {
+    budget.frame_rooms = max_rooms_per_frame_;
+    budget.frame_ray_count = total_resolution;
+  }
+
+  auto scale_strips = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      //To avoid fish-eye effect, each hit must be scaled down by cos of angle of ray, kept in the table.
+      //  This must be absolute cos, to avoid negative wall height
+      //  Main direction is never scaled.
+      if (i != half_resolution) {
+        strip_packages_[i].ScaleDistances(std::abs(strip_cos_[i]));
+      }
+    }
+  };
+
+  if (vision_schedule_ == kWavefrontSchedule) {
+    // Each slice of neighbouring strips is cast room by room, by a wavefront of its own
+    size_t slice_count{std::min(vision_pool_ ? GetVisionThreadCount() * VISION_WAVEFRONT_SLICES : 1,
+                                total_resolution)};
+    if (vision_wavefronts_.size() < slice_count) {
+      vision_wavefronts_.resize(slice_count);
+    }
+
+    auto cast_slices = [&](size_t begin, size_t end) {
+      for (size_t slice = begin; slice < end; ++slice) {
+        size_t first{total_resolution * slice / slice_count};
+        size_t last{total_resolution * (slice + 1) / slice_count};
+        PortalBudget slice_budget{budget};
+        slice_budget.first_ray = first;
+        vision_wavefronts_[slice].Cast(current_room_, current_position_, &strip_directions_[first], last - first,
+                                       range_distance, slice_budget, &strip_packages_[first]);
+        scale_strips(first, last);
+      }
+    };
+
+    if (vision_pool_) {
+      vision_pool_->ParallelFor(slice_count, 1, cast_slices);
+    } else {
+      cast_slices(0, slice_count);
+    }
+    return;
+  }
 
-  // Main direction. Center Screen
-  packages.push_back(current_room_->GetVisible(current_position_, view_direction_, range_distance));
+  auto cast_strips = [&](size_t begin, size_t end) {
+    // Neighbouring strips cross the same rooms, so they are followed together as packets
+    for (size_t first = begin; first < end; first += VISION_PACKET_WIDTH) {
+      size_t count{std::min(static_cast<size_t>(VISION_PACKET_WIDTH), end - first)};
+      PortalBudget packet_budget{budget};
+      packet_budget.first_ray = first;
+      current_room_->GetVisible(current_position_, &strip_directions_[first], count, range_distance, packet_budget,
+                                &strip_packages_[first]);
+    }
+    scale_strips(begin, end);
+  };
 
-  // Define two vectors to allow easier and faster rotaiton of direction in which ryas should be shot
-  glm::vec2 counter_clockwise_direction{view_direction_};
-  glm::vec2 clockwise_direction{view_direction_};
+  if (vision_pool_) {
+    vision_pool_->ParallelFor(total_resolution, VISION_STRIP_GRAIN, cast_strips);
+  } else {
+    cast_strips(0, total_resolution);
+  }
+}
 
-  for (size_t i = 0; i < half_resolution; ++i) {
-    // Rotate the ray each time, preparing to shoot the next ray
-    FastRotation(counter_clockwise_direction, cos, -sin); // negative sign for counter clockwise rotation
-    FastRotation(clockwise_direction, cos, sin); // positive sin for clockwise rotation
+void GameEngine::UpdateStripTables(float cos, float sin, size_t half_resolution) {
+  size_t total_resolution{2 * half_resolution + 1};
+  if (strip_cos_.size() == total_resolution && table_cos_ == cos && table_sin_ == sin) {
+    return;
+  }
 
-    //To avoid fish-eye effect, each hit must be scaled down by cos of angle of ray,
-    //  which can be computed by dot product. This must be absolute dot product, to avoid negative wall height
+  table_cos_ = cos;
+  table_sin_ = sin;
+  strip_cos_.resize(total_resolution);
+  strip_sin_.resize(total_resolution);
+
+  // Angles in double, so that the outer-most strips are as exact as the main one
+  double step_angle{std::atan2(static_cast<double>(sin), static_cast<double>(cos))};
+  for (size_t i = 0; i < total_resolution; ++i) {
+    double angle{(static_cast<double>(i) - static_cast<double>(half_resolution)) * step_angle};
+    strip_cos_[i] = static_cast<float>(std::cos(angle));
+    strip_sin_[i] = static_cast<float>(std::sin(angle));
+  }
+  // Main strip is the view direction itself
+  strip_cos_[half_resolution] = 1;
+  strip_sin_[half_resolution] = 0;
+}
 
-    HitPackage pack1 = current_room_->GetVisible(current_position_, counter_clockwise_direction, range_distance);
-    pack1.ScaleDistances(std::abs(glm::dot(view_direction_, counter_clockwise_direction)));
-    packages.insert(packages.begin(), pack1); // Left-most Hit add at front
+void GameEngine::SetVisionThreadCount(size_t thread_count) {
+  if (thread_count <= 1) {
+    vision_pool_.reset();
+    return;
+  }
+  // Calling thread is one of the threads casting rays
+  vision_pool_.reset(new WorkStealingPool(thread_count - 1));
+}
 
-    HitPackage pack2 = current_room_->GetVisible(current_position_, clockwise_direction, range_distance);
-    pack2.ScaleDistances(std::abs(glm::dot(view_direction_, clockwise_direction)));
-    packages.push_back(pack2); // Right-most Hit add at back
+size_t GameEngine::GetVisionThreadCount() const {
+  if (!vision_pool_) {
+    return 1;
   }
+  return vision_pool_->ThreadCount() + 1;
+}
 
-  return packages;
+void GameEngine::SetMaxPortalDepth(size_t max_portal_depth) {
+  max_portal_depth_ = max_portal_depth;
+}
+
+void GameEngine::SetMaxRoomsPerFrame(size_t max_rooms_per_frame) {
+  max_rooms_per_frame_ = max_rooms_per_frame;
+}
+
+void GameEngine::SetVisionSchedule(VisionSchedule vision_schedule) {
+  vision_schedule_ = vision_schedule;
+}
+
+VisionSchedule GameEngine::GetVisionSchedule() const {
+  return vision_schedule_;
 }
 
 // Player Motion Methods ===============================================================================================
@@ -67,23 +202,28 @@ void GameEngine::MoveForward(float speed) {
                                                        std::abs(speed))};
 
   // Find the first hit in the package
-  if (!package_on_path.GetHits().empty()) {
+  if (package_on_path.HitCount() != 0) {
     // If not empty, must contain certain form of hit
-    auto hit_iterator{package_on_path.GetHits().begin()};
+    const Hit* hit_iterator{package_on_path.begin()};
 
-    switch (hit_iterator->second.hit_type_) {
+    switch (hit_iterator->hit_type_) {
       case kPortal:
         {
           // Traversal
           //  Need to know the direction, then first move the
-          Direction traversal_direction{current_room_->GetSideHit(current_position_, speed * view_direction_)};
+          Direction traversal_direction{current_room_->TryGetSideHit(current_position_, speed * view_direction_)};
+          if (traversal_direction == kUndefined) {
+            // Degenerate path along the edge. Treat the portal as a wall rather than traverse.
+            speed = AbsoluteClamp(speed, hit_iterator->hit_distance_ - WALL_MARGIN);
+            break;
+          }
 
           // Need to check if there is a element blocking path on the other side of portal.
           //  This will be the second item on the iterator
           ++hit_iterator;
-          if (hit_iterator != package_on_path.GetHits().end()) {
+          if (hit_iterator != package_on_path.end()) {
             // Clamp to the next hit-distance with margin
-            speed = AbsoluteClamp(speed, hit_iterator->first - WALL_MARGIN);
+            speed = AbsoluteClamp(speed, hit_iterator->hit_distance_ - WALL_MARGIN);
           }
 
           // Must move first, before teleporting to new appropriate location
@@ -94,7 +234,7 @@ void GameEngine::MoveForward(float speed) {
 
       case kRoomWall:
       case kWall:
-        speed = AbsoluteClamp(speed, hit_iterator->first - WALL_MARGIN);
+        speed = AbsoluteClamp(speed, hit_iterator->hit_distance_ - WALL_MARGIN);
         break;
 
       case kVoid:
@@ -111,6 +251,8 @@ void GameEngine::MoveForward(float speed) {
 
 void GameEngine::TraverseRoom(const Direction& direction) {
   current_room_ = current_room_->GetConnectedRoom(direction);
+  // Rooms only change between frames, so distant ones can be dropped here. They come back the same if entered.
+  factory_.EvictDistantRooms(current_room_);
 
   switch (direction) {
     case kNorth:
@@ -4,19 +4,140 @@
 
 #include <core/hit_package.h>
 
+#include <algorithm>
+
 namespace room_explorer {
 
+const size_t HitPackage::kInlineCapacity;
+
+// Constructors ========================================================================================================
+HitPackage::HitPackage()
+    : hit_count_(0), scale_(1), shift_(0) {}
+// End of Constructors =================================================================================================
+
+
 // Getters ==============================================================================
 size_t HitPackage::HitCount() const {
-  return hits_.size();
+  ApplyTransform();
+  return hit_count_;
+}
+
+const Hit* HitPackage::begin() const {
+  ApplyTransform();
+  return Data();
+}
+
+const Hit* HitPackage::end() const {
+  ApplyTransform();
+  return Data() + hit_count_;
 }
 
-const std::map<float, Hit>& HitPackage::GetHits() const {
-  return hits_;
+std::map<float, Hit> HitPackage::GetHits() const {
+  std::map<float, Hit> hits;
+  for (const Hit& hit : *this) {
+    hits.emplace_hint(hits.end(), hit.hit_distance_, hit);
+  }
+  return hits;
 }
 // Getters ==============================================================================
 
 
+// Storage =============================================================================================================
+Hit* HitPackage::Data() const {
+  return overflow_hits_.empty() ? inline_hits_ : overflow_hits_.data();
+}
+
+void HitPackage::Reserve(size_t capacity) {
+  if (overflow_hits_.empty()) {
+    if (capacity <= kInlineCapacity) {
+      return;
+    }
+    // Spill every hit onto the heap. From now on the overflow holds all the hits.
+    overflow_hits_.assign(inline_hits_, inline_hits_ + hit_count_);
+  }
+
+  // Size of the overflow is its capacity. Hits past hit_count_ are unused.
+  if (overflow_hits_.size() < capacity) {
+    overflow_hits_.resize(std::max(capacity, 2 * overflow_hits_.size()));
+  }
+}
+
+void HitPackage::CollapseEqualDistances(bool prefer_later) const {
+  Hit* hits{Data()};
+
+  size_t kept{0};
+  for (size_t i = 0; i < hit_count_; ++i) {
+    if (kept > 0 && hits[kept - 1].hit_distance_ == hits[i].hit_distance_) {
+      Hit& current{hits[kept - 1]};
+      // Re-adding would keep the first added hit, unless a later one has strictly higher priority
+      bool replace{prefer_later ? hits[i].hit_type_ >= current.hit_type_
+                                : hits[i].hit_type_ > current.hit_type_};
+      if (replace) {
+        current = hits[i];
+      }
+    } else {
+      hits[kept++] = hits[i];
+    }
+  }
+  hit_count_ = kept;
+}
+// End of Storage ======================================================================================================
+
+
+// Pending Transform ===================================================================================================
+void HitPackage::ApplyTransform() const {
+  if (scale_ == 1 && shift_ == 0) {
+    return;
+  }
+
+  Hit* hits{Data()};
+  for (size_t i = 0; i < hit_count_; ++i) {
+    hits[i].hit_distance_ = scale_ * hits[i].hit_distance_ + shift_;
+  }
+
+  // Negative scale reverses the order of hits
+  bool reversed{scale_ < 0};
+  if (reversed) {
+    std::reverse(hits, hits + hit_count_);
+  }
+  // Order is kept, but rounding may bring neighbouring hits onto the same distance
+  CollapseEqualDistances(reversed);
+
+  scale_ = 1;
+  shift_ = 0;
+}
+
+Hit HitPackage::TakeTransformedGroup(size_t& end) const {
+  const Hit* hits{Data()};
+  bool reversed{scale_ < 0};
+
+  // Index k in transformed order is stored at index k, or mirrored if the order is reversed
+  auto stored_index = [&](size_t k) { return reversed ? hit_count_ - 1 - k : k; };
+  auto distance = [&](size_t k) { return scale_ * hits[stored_index(k)].hit_distance_ + shift_; };
+
+  float group_distance{distance(end - 1)};
+  size_t begin{end - 1};
+  while (begin > 0 && distance(begin - 1) == group_distance) {
+    --begin;
+  }
+
+  // Of the group, the first stored hit with strictly highest priority is kept
+  size_t first{std::min(stored_index(begin), stored_index(end - 1))};
+  size_t last{std::max(stored_index(begin), stored_index(end - 1))};
+  Hit kept{hits[first]};
+  for (size_t i = first + 1; i <= last; ++i) {
+    if (hits[i].hit_type_ > kept.hit_type_) {
+      kept = hits[i];
+    }
+  }
+  kept.hit_distance_ = group_distance;
+
+  end = begin;
+  return kept;
+}
+// End of Pending Transform ============================================================================================
+
+
 // Package Addition Methods ============================================================================================
 bool HitPackage::AddHit(const Hit& hit) {
   // Ignore invalid hits
@@ -24,57 +145,96 @@ bool HitPackage::AddHit(const Hit& hit) {
     return false;
   }
 
-  // If a hit already exists on the given distance, one with higher priority should take over
-  if (hits_.find(hit.hit_distance_) != hits_.end()) {
-    const Hit& prev = hits_[hit.hit_distance_];
+  ApplyTransform();
+
+  Hit* hits{Data()};
+  Hit* position{std::lower_bound(hits, hits + hit_count_, hit,
+                                 [](const Hit& a, const Hit& b) { return a.hit_distance_ < b.hit_distance_; })};
 
+  // If a hit already exists on the given distance, one with higher priority should take over
+  if (position != hits + hit_count_ && position->hit_distance_ == hit.hit_distance_) {
     // Only replace the hit if priority if strictly higher
-    if (hit.hit_type_ > prev.hit_type_) {
-      hits_[hit.hit_distance_] = hit;
+    if (hit.hit_type_ > position->hit_type_) {
+      *position = hit;
       return true;
-
     } else {
       return false;
     }
   }
 
-  hits_[hit.hit_distance_] = hit;
+  size_t index = position - hits;
+  Reserve(hit_count_ + 1);
+  hits = Data(); // Storage may have moved onto the heap
+
+  // Shift further hits back by one to open a slot
+  std::move_backward(hits + index, hits + hit_count_, hits + hit_count_ + 1);
+  hits[index] = hit;
+  ++hit_count_;
   return true;
 }
 
 void HitPackage::Merge(const HitPackage& package) {
-  // const auto& is pair of float and Hit
-  for (const auto& hit_pair : package.GetHits()) {
-    AddHit(hit_pair.second); // in the
+  // Merging with itself adds nothing, as every hit ties with itself
+  if (&package == this || package.hit_count_ == 0) {
+    return;
   }
+  ApplyTransform();
+
+  size_t total{hit_count_ + package.hit_count_};
+  Reserve(total);
+
+  Hit* hits{Data()};
+
+  // Merge from the back, so that hits of this package are never overwritten before being read.
+  //  Slots freed by equal distances are closed up afterwards.
+  //  Pending transform of other is applied on the fly, leaving other untouched.
+  size_t own{hit_count_};
+  size_t other{package.hit_count_};
+  size_t write{total};
+  while (other > 0) {
+    Hit next{package.TakeTransformedGroup(other)};
+
+    while (own > 0 && hits[own - 1].hit_distance_ > next.hit_distance_) {
+      hits[--write] = hits[--own];
+    }
+
+    if (own > 0 && hits[own - 1].hit_distance_ == next.hit_distance_) {
+      // Hit from this package is kept, unless other has strictly higher priority
+      --own;
+      hits[--write] = next.hit_type_ > hits[own].hit_type_ ? next : hits[own];
+    } else {
+      hits[--write] = next;
+    }
+  }
+
+  // Hits [0, own) are untouched and in place. Merged hits are [write, total).
+  if (write != own) {
+    std::move(hits + write, hits + total, hits + own);
+  }
+  hit_count_ = own + (total - write);
+}
+
+void HitPackage::Clear() {
+  // Hits go back inline. Overflow keeps its capacity, and is filled again without allocating once it spills.
+  hit_count_ = 0;
+  overflow_hits_.clear();
+  scale_ = 1;
+  shift_ = 0;
 }
 // End of  Package Addition Methods ====================================================================================
 
 
 // Distance Manipulator ================================================================================================
 void HitPackage::ShiftHits(float shift) {
-  // To shift the maps back, first remove the current map, then add shifted hits back
-  auto temp_hits = std::move(hits_);
-
-  // Add all the hits back, after shifting them
-  for(auto& hit_pairs : temp_hits) {
-    Hit& hit{hit_pairs.second};
-    hit.ShiftDistance(shift);
-    AddHit(hit); // Add Back using usual method
-  }
+  // scale * d + shift, then + shift
+  shift_ += shift;
 }
 
 void HitPackage::ScaleDistances(float scale) {
-  // To shift the maps back, first remove the current map, then add scaled hits back
-  auto temp_hits = std::move(hits_);
-
-  // Add all the hits back, after scaling them
-  for(auto& hit_pairs : temp_hits) {
-    Hit& hit{hit_pairs.second};
-    hit.ScaleDistance(scale);
-    AddHit(hit); // Add Back using usual method
-  }
+  // (scale * d + shift) * scale
+  scale_ *= scale;
+  shift_ *= scale;
 }
 // End of Distance Manipulator =========================================================================================
 
-} //namespace room_explorer
\ No newline at end of file
+} //namespace room_explorer
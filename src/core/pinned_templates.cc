@@ -0,0 +1,114 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/pinned_templates.h>
+
+#include <algorithm>
+
+namespace room_explorer {
+
+const size_t PinnedTemplates::kNoTemplate;
+const size_t PinnedTemplates::kFirstCapacity;
+
+// Constructors ========================================================================================================
+PinnedTemplates::Table::Table(size_t capacity) : mask_(capacity - 1), slots_(new Slot[capacity]) {
+  for (size_t i = 0; i < capacity; ++i) {
+    slots_[i].key_.store(0, std::memory_order_relaxed);
+    slots_[i].template_.store(kNoTemplate, std::memory_order_relaxed);
+  }
+}
+
+PinnedTemplates::PinnedTemplates() : table_(nullptr), size_(0) {}
+// End of Constructors =================================================================================================
+
+
+// Pin Methods =========================================================================================================
+size_t PinnedTemplates::Find(RoomKey key) const {
+  // Most maps pin only a few keys, if any. Nothing pinned needs no probing.
+  if (size_.load(std::memory_order_acquire) == 0) {
+    return kNoTemplate;
+  }
+  const Table* table{table_.load(std::memory_order_acquire)};
+
+  // Table is never full, so an empty slot always ends the probe
+  for (size_t slot = MixKey(key) & table->mask_;; slot = (slot + 1) & table->mask_) {
+    size_t template_index{table->slots_[slot].template_.load(std::memory_order_acquire)};
+    if (template_index == kNoTemplate) {
+      return kNoTemplate;
+    }
+    if (table->slots_[slot].key_.load(std::memory_order_relaxed) == key) {
+      return template_index;
+    }
+  }
+}
+
+size_t PinnedTemplates::Pin(RoomKey key, size_t template_index) {
+  std::lock_guard<std::mutex> lock(pin_mutex_);
+
+  size_t pinned{Find(key)};
+  if (pinned != kNoTemplate) {
+    return pinned;
+  }
+
+  size_t size{size_.load(std::memory_order_relaxed)};
+  if (tables_.empty() || 2 * (size + 1) > tables_.back()->mask_ + 1) {
+    Rebuild(tables_.empty() ? kFirstCapacity : 2 * (tables_.back()->mask_ + 1), {});
+  }
+  Insert(*tables_.back(), key, template_index);
+  size_.store(size + 1, std::memory_order_release);
+  return template_index;
+}
+
+void PinnedTemplates::Unpin(const std::vector<RoomKey>& keys) {
+  std::lock_guard<std::mutex> lock(pin_mutex_);
+  if (tables_.empty()) {
+    return;
+  }
+
+  std::vector<RoomKey> dropped_keys(keys);
+  std::sort(dropped_keys.begin(), dropped_keys.end());
+  Rebuild(tables_.back()->mask_ + 1, dropped_keys);
+
+  // No lookup is under way, so replaced tables can go
+  tables_.erase(tables_.begin(), tables_.end() - 1);
+}
+
+size_t PinnedTemplates::Size() const {
+  return size_.load(std::memory_order_acquire);
+}
+
+void PinnedTemplates::Insert(Table& table, RoomKey key, size_t template_index) {
+  size_t slot{MixKey(key) & table.mask_};
+  while (table.slots_[slot].template_.load(std::memory_order_relaxed) != kNoTemplate) {
+    slot = (slot + 1) & table.mask_;
+  }
+  // Template comes last, so that a lookup seeing it also sees the key
+  table.slots_[slot].key_.store(key, std::memory_order_relaxed);
+  table.slots_[slot].template_.store(template_index, std::memory_order_release);
+}
+
+void PinnedTemplates::Rebuild(size_t capacity, const std::vector<RoomKey>& dropped_keys) {
+  std::unique_ptr<Table> table(new Table(capacity));
+  size_t size{0};
+  if (!tables_.empty()) {
+    const Table& current = *tables_.back();
+    for (size_t slot = 0; slot <= current.mask_; ++slot) {
+      size_t template_index{current.slots_[slot].template_.load(std::memory_order_relaxed)};
+      RoomKey key{current.slots_[slot].key_.load(std::memory_order_relaxed)};
+      if (template_index == kNoTemplate || std::binary_search(dropped_keys.begin(), dropped_keys.end(), key)) {
+        continue;
+      }
+      Insert(*table, key, template_index);
+      ++size;
+    }
+  }
+
+  // Lookups still reading the replaced table find the same pins there
+  table_.store(table.get(), std::memory_order_release);
+  tables_.push_back(std::move(table));
+  size_.store(size, std::memory_order_release);
+}
+// End of Pin Methods ==================================================================================================
+
+} // namespace room_explorer
@@ -0,0 +1,120 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/predicates.h>
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace room_explorer {
+
+namespace {
+
+/**
+ * Bound on the rounding error of summing count exact terms in double, relative to the sum of their magnitudes.
+ *    Summing rounds count - 1 times, each by at most half an epsilon of the running sum,
+ *    so the error stays below (count - 1) * epsilon / 2 to first order.
+ *    A whole epsilon per term leaves room for the higher order terms, and for the rounding of the magnitude itself.
+ */
+constexpr double SumErrorBound(size_t count) {
+  return count * std::numeric_limits<double>::epsilon();
+}
+
+int Sign(double value) {
+  return (value > 0) - (value < 0);
+}
+
+/**
+ * Exact sign of a sum of doubles, through an expansion holding the sum without rounding.
+ *    Each term is added with two-sum, which splits a sum into its rounded value and the exact rounding error.
+ *    Components end up non-overlapping and increasing in magnitude, so the largest non-zero one decides the sign.
+ */
+template<size_t count>
+int ExactSumSign(const double (&terms)[count]) {
+  double expansion[count];
+  size_t length{0};
+  for (double term : terms) {
+    double carry{term};
+    for (size_t i = 0; i < length; ++i) {
+      double sum{carry + expansion[i]};
+      double carry_virtual{sum - expansion[i]};
+      double component_virtual{sum - carry_virtual};
+      double error{(carry - carry_virtual) + (expansion[i] - component_virtual)};
+      expansion[i] = error;
+      carry = sum;
+    }
+    expansion[length++] = carry;
+  }
+
+  for (size_t i = length; i > 0; --i) {
+    if (expansion[i - 1] != 0) {
+      return Sign(expansion[i - 1]);
+    }
+  }
+  return 0;
+}
+
+/**
+ * Sign of a sum of exact products. Summed in double first, and exactly only when rounding could flip the sign.
+ */
+template<size_t count>
+int SumSign(const double (&terms)[count]) {
+  double sum{0};
+  double magnitude{0};
+  for (double term : terms) {
+    sum += term;
+    magnitude += std::abs(term);
+  }
+
+  if (std::abs(sum) > SumErrorBound(count) * magnitude) {
+    return Sign(sum);
+  }
+  if (magnitude == 0) {
+    return 0;
+  }
+  return ExactSumSign(terms);
+}
+
+} // namespace
+
+
+// Geometric Predicates ================================================================================================
+int CrossSign(const glm::vec2& vec_a, const glm::vec2& vec_b) {
+  // Two exact products, which a comparison orders exactly
+  double left{static_cast<double>(vec_a.x) * vec_b.y};
+  double right{static_cast<double>(vec_a.y) * vec_b.x};
+  return (left > right) - (left < right);
+}
+
+int Orientation(const glm::vec2& point_a, const glm::vec2& point_b, const glm::vec2& point_c) {
+  // (b - a) x (c - a), expanded so that no difference of coordinates is rounded. The a.x * a.y terms cancel out.
+  double ax{point_a.x}, ay{point_a.y};
+  double bx{point_b.x}, by{point_b.y};
+  double cx{point_c.x}, cy{point_c.y};
+  const double terms[6]{bx * cy, -bx * ay, -ax * cy, -by * cx, by * ax, ay * cx};
+  return SumSign(terms);
+}
+
+int SideOfLine(const glm::vec2& point, const glm::vec2& line_pos, const glm::vec2& line_dir) {
+  // d x (p - q), expanded
+  double dx{line_dir.x}, dy{line_dir.y};
+  const double terms[4]{dx * point.y, -dx * line_pos.y, -dy * point.x, dy * line_pos.x};
+  return SumSign(terms);
+}
+
+int SideOfRay(const glm::vec2& point, const glm::vec2& ray_pos, const glm::vec2& ray_dir) {
+  double dx{ray_dir.x}, dy{ray_dir.y};
+  double sum{(dx * point.y - dx * ray_pos.y) - (dy * point.x - dy * ray_pos.x)};
+  double magnitude{std::abs(dx) * (std::abs(point.y) + std::abs(ray_pos.y)) +
+                   std::abs(dy) * (std::abs(point.x) + std::abs(ray_pos.x))};
+
+  if (std::abs(sum) <= kDirectionEpsilon * magnitude) {
+    return 0;
+  }
+  return Sign(sum);
+}
+// End of Geometric Predicates =========================================================================================
+
+} // namespace room_explorer
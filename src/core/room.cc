@@ -4,8 +4,73 @@
 
 #include <core/room.h>
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 namespace room_explorer {
 
+namespace {
+// Salts of the keys of rooms to the north and to the east. Any two distinct odd constants.
+const RoomKey kNorthKeySalt = 0x9E3779B97F4A7C15;
+const RoomKey kEastKeySalt = 0xD1B54A32D192ED03;
+
+/**
+ * @param exclusive_primary_hit Room wall or portal through which the ray leaves the room.
+ * @return Distance at which the ray leaves the room. Infinite if it is not known to leave.
+ */
+float ExitDistance(const Hit& exclusive_primary_hit) {
+  if (exclusive_primary_hit.IsNoHit()) {
+    return std::numeric_limits<float>::infinity();
+  }
+  return exclusive_primary_hit.hit_distance_;
+}
+} // namespace
+
+// Portal Budget ============================================================
+size_t PortalBudget::RayPortalDepth(size_t ray) const {
+  if (frame_rooms == SIZE_MAX) {
+    return max_portal_depth;
+  }
+  // Ray i gets floor((i + 1) * rooms / rays) - floor(i * rooms / rays), split so that nothing overflows
+  size_t frame_ray{first_ray + ray};
+  size_t share{frame_rooms / frame_ray_count};
+  size_t remainder{frame_rooms % frame_ray_count};
+  share += (frame_ray + 1) * remainder / frame_ray_count - frame_ray * remainder / frame_ray_count;
+  return std::min(max_portal_depth, share);
+}
+
+bool PortalBudget::AllowsPortal(size_t ray, size_t depth) const {
+  return depth < RayPortalDepth(ray);
+}
+// End of Portal Budget =====================================================
+
+
+// Room Link ================================================================
+RoomLink::RoomLink() : id_(kNoRoom) {}
+
+RoomLink::RoomLink(const RoomLink& other) : id_(other.Load()) {}
+
+RoomLink& RoomLink::operator=(const RoomLink& other) {
+  id_.store(other.Load(), std::memory_order_relaxed);
+  return *this;
+}
+
+RoomId RoomLink::Load() const {
+  return id_.load(std::memory_order_acquire);
+}
+
+void RoomLink::Store(RoomId id) {
+  id_.store(id, std::memory_order_relaxed);
+}
+
+bool RoomLink::Publish(RoomId id, RoomId& linked) {
+  linked = kNoRoom;
+  return id_.compare_exchange_strong(linked, id, std::memory_order_acq_rel, std::memory_order_acquire);
+}
+// End of Room Link =========================================================
+
+
 // Direction Enum Methods ===================================================
 Direction operator!(const Direction& direction) {
   switch (direction) {
@@ -21,18 +86,27 @@ Direction operator!(const Direction& direction) {
       throw exceptions::InvalidDirectionException();
   }
 }
+
+bool IsCardinal(const Direction& direction) {
+  return direction == kNorth || direction == kSouth || direction == kEast || direction == kWest;
+}
 // End of Direction Enum Method =============================================
 
 
 // Public Room functions ===============================================================================================
+const size_t Room::kMaxPacketWidth;
 
 // Elementary Getters ===========================================================================
 size_t Room::GetWallCount() const {
-  return walls_->size();
+  return walls_->Size();
 }
 
-const std::set<Wall>& Room::GetWalls() const {
-  return *walls_;
+const std::vector<Wall>& Room::GetWalls() const {
+  return walls_->GetWalls();
+}
+
+RoomKey Room::GetKey() const {
+  return key_;
 }
 // End of elementary getters ====================================================================
 
@@ -40,27 +114,41 @@ const std::set<Wall>& Room::GetWalls() const {
 // Room Connectivity Functions ==================================================================
 bool Room::LinkRoom(const Direction& direction, Room* room_p) {
   // If either room-connection is already populated, aboard linking
-  Room*& curr_link = GetLinkedRoomPointer(direction);
-  if (curr_link != nullptr) {
+  RoomLink& curr_link = GetLink(direction);
+  if (curr_link.Load() != kNoRoom) {
     return false;
   }
 
-  Room*& other_link = room_p->GetLinkedRoomPointer(!direction);
-  if (other_link != nullptr) {
+  RoomLink& other_link = room_p->GetLink(!direction);
+  if (other_link.Load() != kNoRoom) {
     return false;
   }
 
-  // Update connected rooms. Assignment possible because link-pointers are references to actual members.
-  curr_link = room_p;
-  other_link = this;
+  // Other room links back before it is published, so no thread ever sees it linked one way only
+  other_link.Store(id_);
+  RoomId linked;
+  if (!curr_link.Publish(room_p->id_, linked)) {
+    other_link.Store(kNoRoom);
+    return false;
+  }
   return true;
 }
 
+Room* Room::LinkGeneratedRoom(const Direction& direction, Room* room_p) {
+  if (LinkRoom(direction, room_p)) {
+    return room_p;
+  }
+  // Another thread linked its own room first. No one else has seen this one, so it is simply released.
+  arena_->Release(room_p->id_);
+  return GetLinkedRoomPointer(direction);
+}
+
 bool Room::IsConnectedWith(Room* other_p, const Direction& direction) const {
   if (other_p != GetLinkedRoomPointer(direction)) {
     return false;
   }
-  if (this != other_p->GetLinkedRoomPointer(!direction)) {
+  // Rooms are linked by id, so that a copy of a room is linked wherever the room itself is
+  if (id_ != other_p->links_[!direction].Load()) {
     return false;
   }
   return true;
@@ -73,8 +161,30 @@ bool Room::IsConnectedWith(Room* other_p) const {
          IsConnectedWith(other_p, kWest);
 }
 
+RoomKey Room::NeighbourKey(RoomKey key, const Direction& direction) {
+  // North and east each mix in their own salt, and south and west undo them,
+  //  so that the key of a room depends only on the way to it from the first room.
+  switch (direction) {
+    case kNorth:
+      return MixKey(key + kNorthKeySalt);
+    case kSouth:
+      return UnmixKey(key) - kNorthKeySalt;
+    case kEast:
+      return MixKey(key + kEastKeySalt);
+    case kWest:
+      return UnmixKey(key) - kEastKeySalt;
+    default:
+      throw exceptions::InvalidDirectionException();
+  }
+}
+
 Room* Room::GetConnectedRoom(const Direction& direction) {
-  return GetConnectedRoom(direction, factory->RandomId());
+  Room* room = GetLinkedRoomPointer(direction);
+  // Template is only looked up when a room is actually generated
+  if (room == nullptr) {
+    room = LinkGeneratedRoom(direction, factory->GenerateRoomAt(NeighbourKey(key_, direction), !fitted_));
+  }
+  return room;
 }
 
 Room* Room::GetConnectedRoom(const Direction& direction, const std::string& default_id) {
@@ -86,8 +196,7 @@ Room* Room::GetConnectedRoom(const Direction& direction, const std::string& defa
       return nullptr;
     }
 
-    room = factory->GenerateRoom(default_id);
-    LinkRoom(direction, room);
+    room = LinkGeneratedRoom(direction, factory->GenerateRoom(default_id, NeighbourKey(key_, direction), !fitted_));
   }
   return room;
 }
@@ -97,36 +206,37 @@ Room* Room::GetConnectedRoom(const Direction& direction, const std::string& defa
 // Room Geometric Functions =====================================================================
 
 // Getters ==================================================================
+// Dimensions are cached from the factory when the room is generated
 float Room::GetWidth() const {
-  return factory->RoomWidth();
+  return bounds_.width_;
 }
 
 float Room::GetHeight() const {
-  return factory->RoomHeight();
+  return bounds_.height_;
 }
 
 float Room::GetNSDoorWidth() const {
-  return factory->GetNSPortalWidth();
+  return bounds_.ns_door_end_ - bounds_.ns_door_begin_;
 }
 
 float Room::GetEWDoorWidth() const {
-  return factory->GetEWPortalWidth();
+  return bounds_.ew_door_end_ - bounds_.ew_door_begin_;
 }
 
 float Room::GetNSDoorBegin() const {
-  return factory->GetNSPortalBegin();
+  return bounds_.ns_door_begin_;
 }
 
 float Room::GetEWDoorBegin() const {
-  return factory->GetEWPortalBegin();
+  return bounds_.ew_door_begin_;
 }
 
 float Room::GetNSDoorEnd() const {
-  return factory->GetNSPortalEnd();
+  return bounds_.ns_door_end_;
 }
 
 float Room::GetEWDoorEnd() const {
-  return factory->GetEWPortalEnd();
+  return bounds_.ew_door_end_;
 }
 
 glm::vec2 Room::GetHead(Direction direction, bool of_portal) const {
@@ -138,6 +248,22 @@ glm::vec2 Room::GetTail(Direction direction, bool of_portal) const {
   return of_portal  ? GetPortalTail(direction)
                     : GetWallTail(direction);
 }
+
+bool Room::TryGetHead(Direction direction, bool of_portal, glm::vec2& head) const {
+  if (!IsCardinal(direction)) {
+    return false;
+  }
+  head = GetHead(direction, of_portal);
+  return true;
+}
+
+bool Room::TryGetTail(Direction direction, bool of_portal, glm::vec2& tail) const {
+  if (!IsCardinal(direction)) {
+    return false;
+  }
+  tail = GetTail(direction, of_portal);
+  return true;
+}
 // End of getters ==========================================================
 
 bool Room::WithinRoom(const glm::vec2& pos, bool wall_inclusive) const {
@@ -166,6 +292,16 @@ bool Room::OnRoomEdge(const glm::vec2& pos) const {
 Direction Room::GetSideHit(const glm::vec2& ray_pos,
                            const glm::vec2& ray_dir,
                            bool point_inclusive) const {
+  Direction direction{TryGetSideHit(ray_pos, ray_dir, point_inclusive)};
+  if (direction == kUndefined) {
+    throw exceptions::InvalidDirectionException();
+  }
+  return direction;
+}
+
+Direction Room::TryGetSideHit(const glm::vec2& ray_pos,
+                              const glm::vec2& ray_dir,
+                              bool point_inclusive) const {
   // Edge border cases are checked first.
   bool touch_north = FloatApproximation(ray_pos.y, GetHeight());
   bool touch_south = FloatApproximation(ray_pos.y, 0);
@@ -181,7 +317,7 @@ Direction Room::GetSideHit(const glm::vec2& ray_pos,
                   strictly_within_y,
                   touch_west || touch_east,
                   touch_north || touch_south)) {
-    throw exceptions::InvalidDirectionException();
+    return kUndefined;
   }
 
   if (touch_north || touch_south || touch_east || touch_west) {
@@ -206,12 +342,12 @@ Direction Room::GetSideHit(const glm::vec2& ray_pos,
       // If not point inclusive, but still on-wall, there are few more cases that can be immediately handled
       //  by simple direction-check
 
-      // If on wall and ray points out-wards, ray will never hit a wall, and should throw exception.
+      // If on wall and ray points out-wards, ray will never hit a wall, and direction is undefined.
       // If on wall and  ray points directly parallel to the wall, ray will intersect with the current wall.
 
       if (touch_north) {
         if (ray_dir.y > 0) {
-          throw exceptions::InvalidDirectionException();
+          return kUndefined;
         }
         // If y = 0, ray must move only in x-direction, directly parallel to north wall.
         if (FloatApproximation(ray_dir.y, 0)) {
@@ -220,7 +356,7 @@ Direction Room::GetSideHit(const glm::vec2& ray_pos,
       }
       if (touch_south) {
         if (ray_dir.y < 0) {
-          throw exceptions::InvalidDirectionException();
+          return kUndefined;
         }
         // If y = 0, ray must move only in x-direction, directly parallel to south wall.
         if (FloatApproximation(ray_dir.y, 0)) {
@@ -229,7 +365,7 @@ Direction Room::GetSideHit(const glm::vec2& ray_pos,
       }
       if (touch_east) {
         if (ray_dir.x > 0) {
-          throw exceptions::InvalidDirectionException();
+          return kUndefined;
         }
         // If x = 0, ray must move only in y-direction, directly parallel to east wall.
         if (FloatApproximation(ray_dir.x, 0)) {
@@ -238,7 +374,7 @@ Direction Room::GetSideHit(const glm::vec2& ray_pos,
       }
       if (touch_west) {
         if (ray_dir.x < 0) {
-          throw exceptions::InvalidDirectionException();
+          return kUndefined;
         }
         // If x = 0, ray must move only in y-direction, directly parallel to west wall.
         if (FloatApproximation(ray_dir.x, 0)) {
@@ -337,7 +473,7 @@ Direction Room::GetSideHit(const glm::vec2& ray_pos,
   }
 
   // Suggests ray is a zero-ray. Invalid direction.
-  throw exceptions::InvalidDirectionException();
+  return kUndefined;
 }
 
 float Room::GetRoomWallHitDistance(const Direction& direction,
@@ -371,40 +507,120 @@ float Room::GetWallTextureIndex(const Direction& direction, bool of_portal,
 
 Hit Room::GetPrimaryWallHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir, bool wall_inclusive) const {
   // dummy for reference
-  __unused Direction direction;
+  Direction direction;
   return GetPrimaryWallHit(ray_pos, ray_dir, direction, wall_inclusive);
 }
 
 Hit Room::GetPrimaryWallHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir, Direction& direction, bool wall_inclusive) const {
-  try {
-    // If invalid direction, will throw
-    direction = GetSideHit(ray_pos, ray_dir, wall_inclusive);
-    bool is_portal{RayHitsPortal(direction, ray_pos, ray_dir)};
-
-    return {GetRoomWallHitDistance(direction, ray_pos, ray_dir),
-            is_portal ? kPortal : kRoomWall,
-            GetWallTextureIndex(direction, is_portal, ray_pos, ray_dir)};
-  } catch (const exceptions::InvalidDirectionException& e) {
-    return {}; // Return invalid hit package
+  Hit hit;
+  bool on_edge;
+  if (TryGetExitHit(ray_pos, ray_dir, wall_inclusive, hit, direction, on_edge)) {
+    return hit;
+  }
+  return GetEdgePrimaryWallHit(ray_pos, ray_dir, direction, wall_inclusive);
+}
+
+bool Room::TryGetExitHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir, bool wall_inclusive,
+                         Hit& hit, Direction& direction, bool& on_edge) const {
+  const RoomBounds& bounds{bounds_};
+  float epsilon{bounds.edge_epsilon_};
+
+  // Distance from each edge. Edges are detected with the same tolerance as GetSideHit.
+  float from_west{ray_pos.x};
+  float from_east{bounds.width_ - ray_pos.x};
+  float from_south{ray_pos.y};
+  float from_north{bounds.height_ - ray_pos.y};
+
+  bool touch_west{std::abs(from_west) <= epsilon};
+  bool touch_east{std::abs(from_east) <= bounds.width_tolerance_};
+  bool touch_south{std::abs(from_south) <= epsilon};
+  bool touch_north{std::abs(from_north) <= bounds.height_tolerance_};
+
+  bool inside_x = (from_west > epsilon) & (from_east > bounds.width_tolerance_);
+  bool inside_y = (from_south > epsilon) & (from_north > bounds.height_tolerance_);
+  on_edge = !(inside_x & inside_y);
+
+  if (on_edge) {
+    // Only a point-exclusive ray on a single edge, pointing strictly into the room, exits like an inside ray
+    int touches{touch_west + touch_east + touch_south + touch_north};
+    bool points_inward = (!touch_west | (ray_dir.x > epsilon)) & (!touch_east | (ray_dir.x < -epsilon)) &
+                         (!touch_south | (ray_dir.y > epsilon)) & (!touch_north | (ray_dir.y < -epsilon));
+    bool within = (inside_x | touch_west | touch_east) & (inside_y | touch_south | touch_north);
+    if (wall_inclusive || touches != 1 || !points_inward || !within) {
+      return false;
+    }
   }
+
+  float length{std::sqrt(ray_dir.x * ray_dir.x + ray_dir.y * ray_dir.y)};
+  if (!(length > 0)) {
+    return false; // Zero-ray
+  }
+  glm::vec2 unit_dir{ray_dir / length};
+
+  // Slab test. Distance to the edge the ray heads towards on each axis, infinite if moving parallel to it.
+  float infinity{std::numeric_limits<float>::infinity()};
+  float x_distance{unit_dir.x != 0 ? (unit_dir.x > 0 ? from_east : -from_west) / unit_dir.x : infinity};
+  float y_distance{unit_dir.y != 0 ? (unit_dir.y > 0 ? from_north : -from_south) / unit_dir.y : infinity};
+
+  // Corners belong to the wall they are the head of: NE to north, SE to east, SW to south and NW to west.
+  //  So on a tie, ray leaves through east or west only when heading into the SE or NW corner.
+  bool exits_x = (x_distance < y_distance) | ((x_distance == y_distance) & (unit_dir.x * unit_dir.y < 0));
+  bool positive{exits_x ? unit_dir.x > 0 : unit_dir.y > 0};
+  direction = exits_x ? (positive ? kEast : kWest) : (positive ? kNorth : kSouth);
+
+  float distance{exits_x ? x_distance : y_distance};
+  // Coordinate of the exit along the exit wall
+  float along{exits_x ? ray_pos.y + unit_dir.y * distance : ray_pos.x + unit_dir.x * distance};
+
+  float door_begin{exits_x ? bounds.ew_door_begin_ : bounds.ns_door_begin_};
+  float door_end{exits_x ? bounds.ew_door_end_ : bounds.ns_door_end_};
+  bool is_portal = (along >= door_begin) & (along <= door_end);
+
+  // Heads are clock-wise, so texture index runs towards smaller coordinates on the north and west walls.
+  //  Their heads are at the far end of the door or wall. Heads of south and east walls are at the near end.
+  bool runs_backwards{exits_x != positive};
+  float wall_length{exits_x ? bounds.height_ : bounds.width_};
+  float head{runs_backwards ? (is_portal ? door_end : wall_length)
+                            : (is_portal ? door_begin : 0)};
+
+  hit = Hit(distance, is_portal ? kPortal : kRoomWall, runs_backwards ? head - along : along - head);
+  return true;
 }
 
+Hit Room::GetEdgePrimaryWallHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir,
+                                Direction& direction, bool wall_inclusive) const {
+  // Degenerate rays are routine on the edges, so they are reported rather than thrown
+  direction = TryGetSideHit(ray_pos, ray_dir, wall_inclusive);
+  if (direction == kUndefined) {
+    return {}; // Return invalid hit package
+  }
 
+  bool is_portal{RayHitsPortal(direction, ray_pos, ray_dir)};
+
+  return {GetRoomWallHitDistance(direction, ray_pos, ray_dir),
+          is_portal ? kPortal : kRoomWall,
+          GetWallTextureIndex(direction, is_portal, ray_pos, ray_dir)};
+}
 
-HitPackage Room::CurrentRoomPackage(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range, bool point_inclusive) const {
-  HitPackage package;
 
-  Hit exclusive_primary_hit{GetPrimaryWallHit(ray_pos, ray_dir, false)};
+
+Hit Room::AddPrimaryWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                             bool point_inclusive, Direction& direction, HitPackage& package) const {
+  Hit exclusive_primary_hit;
+  bool on_edge;
+  if (!TryGetExitHit(ray_pos, ray_dir, false, exclusive_primary_hit, direction, on_edge)) {
+    exclusive_primary_hit = GetEdgePrimaryWallHit(ray_pos, ray_dir, direction, false);
+  }
 
   if (!exclusive_primary_hit.IsNoHit() && exclusive_primary_hit.WithinDistance(visible_range)) {
     package.AddHit(exclusive_primary_hit);
-
-    // only this exclusive primary hit can be a portal
   }
 
-  if (point_inclusive) {
+  // Strictly inside the room, inclusive hit is the exclusive hit. It can only differ on an edge.
+  if (point_inclusive && on_edge) {
     // check for inclusive hit
-    Hit inclusive_primary_hit{GetPrimaryWallHit(ray_pos, ray_dir, true)};
+    Direction inclusive_direction;
+    Hit inclusive_primary_hit{GetEdgePrimaryWallHit(ray_pos, ray_dir, inclusive_direction, true)};
 
     // only include different hits
     if (!inclusive_primary_hit.IsNoHit() &&
@@ -414,128 +630,204 @@ HitPackage Room::CurrentRoomPackage(const glm::vec2& ray_pos, const glm::vec2& r
     }
   }
 
+  return exclusive_primary_hit;
+}
 
-  for (const Wall& wall : *walls_) {
-    Hit hit{wall.GetWallHit(ray_pos, ray_dir)};
-    if (hit.WithinDistance(visible_range)) {
-      package.AddHit(hit);
-    }
+void Room::AddTemplateWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                               float exit_distance, HitPackage& package) const {
+  if (wall_bsp_ != nullptr) {
+    wall_bsp_->AddWallHits(ray_pos, ray_dir, visible_range, exit_distance, package);
+  } else {
+    wall_grid_->AddWallHits(ray_pos, ray_dir, visible_range, exit_distance, package);
   }
-
-  return package;
 }
 
-
-HitPackage Room::GetVisible(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range, bool point_inclusive) {
+HitPackage Room::CurrentRoomPackage(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range, bool point_inclusive) const {
   HitPackage package;
 
   Direction direction;
-  Hit exclusive_primary_hit{GetPrimaryWallHit(ray_pos, ray_dir, direction, false)};
+  Hit exclusive_primary_hit{AddPrimaryWallHits(ray_pos, ray_dir, visible_range, point_inclusive, direction, package)};
 
-  if (!exclusive_primary_hit.IsNoHit() && exclusive_primary_hit.WithinDistance(visible_range)) {
-    package.AddHit(exclusive_primary_hit);
+  // Only walls the ray can reach before leaving the room are tested
+  AddTemplateWallHits(ray_pos, ray_dir, visible_range, ExitDistance(exclusive_primary_hit), package);
 
-    // only this exclusive primary hit can be a portal
-    if (exclusive_primary_hit.hit_type_ == kPortal) {
-      // request Visible from room of direction
-
-      float& texture_shift = exclusive_primary_hit.texture_index_;
-
-      glm::vec2 entry_pos;
-
-      // define entry point, on the other room
-      //  texture index must be from current, the other compoennt needs to be opposite
-      switch (direction) {
-        case kNorth:
-          // entry at (nw_begin + width - texture, 0) :: on south
-          entry_pos = {GetNSDoorEnd() - texture_shift, 0};
-          break;
-        case kSouth:
-          // entry at (nw_begin + texture, height) :: on north
-          entry_pos = {GetNSDoorBegin() + texture_shift, GetHeight()};
-          break;
-        case kEast:
-          // entry at (0, ew_begin + texture) :: on west
-          entry_pos = {0, GetEWDoorBegin() + texture_shift};
-          break;
-        case kWest:
-          // entry at (width, ew_begin + ew_wdith - texture) :: on east
-          entry_pos = {GetWidth(), GetEWDoorEnd() - texture_shift};
-          break;
-
-        case kUndefined:
-          throw exceptions::InvalidDirectionException();
-      }
+  return package;
+}
 
-      float new_range = visible_range - exclusive_primary_hit.hit_distance_;
-      HitPackage next_room = GetConnectedRoom(direction)->GetVisible(entry_pos, ray_dir, new_range, false);
 
-      next_room.ShiftHits(exclusive_primary_hit.hit_distance_);
+HitPackage Room::GetVisible(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range, bool point_inclusive) {
+  return GetVisible(ray_pos, ray_dir, visible_range, PortalBudget(), point_inclusive);
+}
+
+HitPackage Room::GetVisible(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                            const PortalBudget& budget, bool point_inclusive) {
+  HitPackage package;
 
-      package.Merge(next_room);
+  // Ray passes through at most one portal per room, so following it is a walk down a chain of rooms.
+  //  Hits of each room are shifted by the distance traveled up to its entry, and merged behind the earlier rooms.
+  Room* room{this};
+  glm::vec2 entry_pos{ray_pos};
+  float traveled{0};
+  size_t depth{0};
+
+  while (true) {
+    Hit exit_hit;
+    Direction direction;
+    bool hits_portal{room->TraceRoom(entry_pos, ray_dir, visible_range - traveled, traveled, point_inclusive,
+                                     package, exit_hit, direction)};
+
+    if (!hits_portal || !budget.AllowsPortal(0, depth)) {
+      return package;
+    }
+    if (!room->TryGetEntryPosition(direction, exit_hit.texture_index_, entry_pos)) {
+      // A portal hit always has a direction. Stop the ray rather than throw, should it ever not.
+      return package;
     }
-  }
 
-  if (point_inclusive) {
-    // check for inclusive hit
-    Hit inclusive_primary_hit{GetPrimaryWallHit(ray_pos, ray_dir, true)};
+    room = room->GetConnectedRoom(direction);
+    traveled += exit_hit.hit_distance_;
+    point_inclusive = false; // Entry portal is not a hit of the next room
+    ++depth;
+  }
+}
 
-    // only include different hits
-    if (!inclusive_primary_hit.IsNoHit() &&
-        inclusive_primary_hit.WithinDistance(visible_range) &&
-        exclusive_primary_hit != inclusive_primary_hit) {
-      package.AddHit(inclusive_primary_hit);
+void Room::GetVisible(const glm::vec2& ray_pos, const glm::vec2* ray_dirs, size_t ray_count, float visible_range,
+                      const PortalBudget& budget, HitPackage* packages, bool point_inclusive) {
+  // Ray of a packet, as it stands on entering the room of the packet
+  struct PacketRay {
+    size_t ray_; // Index into ray_dirs and packages
+    glm::vec2 entry_pos_;
+    float traveled_;
+  };
+
+  // Rays entering the same room through the same side, at the same depth
+  struct Packet {
+    Room* room_;
+    size_t depth_;
+    size_t ray_count_;
+    PacketRay rays_[kMaxPacketWidth];
+  };
+
+  // Packets still to follow. Each one splits into at most one packet per side, followed depth first.
+  //  Packets on the stack share out the rays of a single initial packet, so there are never more than its rays.
+  Packet packets[kMaxPacketWidth];
+  size_t packet_count{0};
+
+  for (size_t first = 0; first < ray_count; first += kMaxPacketWidth) {
+    Packet initial{this, 0, std::min(kMaxPacketWidth, ray_count - first), {}};
+    for (size_t i = 0; i < initial.ray_count_; ++i) {
+      packages[first + i].Clear();
+      initial.rays_[i] = {first + i, ray_pos, 0};
     }
-  }
+    packets[packet_count++] = initial;
+
+    while (packet_count != 0) {
+      Packet packet = packets[--packet_count];
+
+      // Rays leaving through the same side go on together, indexed by Direction
+      Packet next[4];
+      for (Packet& side_packet : next) {
+        side_packet.ray_count_ = 0;
+      }
+
+      for (size_t i = 0; i < packet.ray_count_; ++i) {
+        const PacketRay& ray = packet.rays_[i];
+        Hit exit_hit;
+        Direction direction;
+        bool hits_portal{packet.room_->TraceRoom(ray.entry_pos_, ray_dirs[ray.ray_], visible_range - ray.traveled_,
+                                                 ray.traveled_, point_inclusive && packet.depth_ == 0,
+                                                 packages[ray.ray_], exit_hit, direction)};
+
+        glm::vec2 entry_pos;
+        if (!hits_portal || !budget.AllowsPortal(ray.ray_, packet.depth_) ||
+            !packet.room_->TryGetEntryPosition(direction, exit_hit.texture_index_, entry_pos)) {
+          continue;
+        }
+        Packet& side_packet = next[direction];
+        side_packet.rays_[side_packet.ray_count_++] = {ray.ray_, entry_pos, ray.traveled_ + exit_hit.hit_distance_};
+      }
 
-  for (const Wall& wall : *walls_) {
-    Hit hit{wall.GetWallHit(ray_pos, ray_dir)};
-    if (!hit.IsNoHit() && hit.WithinDistance(visible_range)) { //add validity check
-      package.AddHit(hit);
+      // Adjacent room is looked up once for every ray going into it
+      for (size_t side = 0; side < 4; ++side) {
+        Packet& side_packet = next[side];
+        if (side_packet.ray_count_ == 0) {
+          continue;
+        }
+        Direction direction{static_cast<Direction>(side)};
+        side_packet.room_ = packet.room_->GetConnectedRoom(direction);
+        side_packet.depth_ = packet.depth_ + 1;
+        packets[packet_count++] = side_packet;
+      }
     }
   }
-
-  return package;
 }
 
+bool Room::TraceRoom(const glm::vec2& entry_pos, const glm::vec2& ray_dir, float room_range, float traveled,
+                     bool point_inclusive, HitPackage& package,
+                     Hit& exit_hit, Direction& direction) const {
+  HitPackage room_package;
 
-// End of Room geometric functions ==============================================================
+  exit_hit = AddPrimaryWallHits(entry_pos, ray_dir, room_range, point_inclusive, direction, room_package);
 
-// End of public room functions ========================================================================================
+  // only this exclusive primary hit can be a portal
+  bool hits_portal{exit_hit.hit_type_ == kPortal && exit_hit.WithinDistance(room_range)};
 
+  // Only walls the ray can reach before leaving the room are tested
+  AddTemplateWallHits(entry_pos, ray_dir, room_range, ExitDistance(exit_hit), room_package);
 
-// Private Room Functions ==============================================================================================
+  room_package.ShiftHits(traveled);
+  package.Merge(room_package);
+  return hits_portal;
+}
 
-// Getters ======================================================================================
-Room*& Room::GetLinkedRoomPointer(const Direction& direction) {
+bool Room::TryGetEntryPosition(Direction direction, float texture_shift, glm::vec2& entry_pos) const {
+  // define entry point, on the other room
+  //  texture index must be from current, the other compoennt needs to be opposite
   switch (direction) {
     case kNorth:
-      return north_;
+      // entry at (nw_begin + width - texture, 0) :: on south
+      entry_pos = {GetNSDoorEnd() - texture_shift, 0};
+      return true;
     case kSouth:
-      return south_;
+      // entry at (nw_begin + texture, height) :: on north
+      entry_pos = {GetNSDoorBegin() + texture_shift, GetHeight()};
+      return true;
     case kEast:
-      return east_;
+      // entry at (0, ew_begin + texture) :: on west
+      entry_pos = {0, GetEWDoorBegin() + texture_shift};
+      return true;
     case kWest:
-      return west_;
+      // entry at (width, ew_begin + ew_wdith - texture) :: on east
+      entry_pos = {GetWidth(), GetEWDoorEnd() - texture_shift};
+      return true;
     default:
-      throw exceptions::InvalidDirectionException();
+      return false;
+  }
+}
+
+
+// End of Room geometric functions ==============================================================
+
+// End of public room functions ========================================================================================
+
+
+// Private Room Functions ==============================================================================================
+
+// Getters ======================================================================================
+RoomLink& Room::GetLink(const Direction& direction) {
+  if (!IsCardinal(direction)) {
+    throw exceptions::InvalidDirectionException();
   }
+  return links_[direction];
 }
 
 Room* Room::GetLinkedRoomPointer(const Direction& direction) const {
-  // Returns copy of pointer rather than reference to it.
-  switch (direction) {
-    case kNorth:
-      return north_;
-    case kSouth:
-      return south_;
-    case kEast:
-      return east_;
-    case kWest:
-      return west_;
-    default:
-      throw exceptions::InvalidDirectionException();
+  if (!IsCardinal(direction)) {
+    throw exceptions::InvalidDirectionException();
   }
+  // Ids are looked up in the arena, which keeps every room in place
+  RoomId id{links_[direction].Load()};
+  return id == kNoRoom ? nullptr : &arena_->Get(id);
 }
 // End of Getters ===============================================================================
 
@@ -557,7 +849,7 @@ glm::vec2 Room::GetPortalHead(Direction dir) const {
     case kWest:
       return vec2(0, GetEWDoorEnd());
 
-    case kUndefined:
+    default:
       throw exceptions::InvalidDirectionException();
   }
 }
@@ -578,7 +870,7 @@ glm::vec2 Room::GetPortalTail(Direction dir) const {
     case kWest:
       return vec2(0, GetEWDoorBegin());
 
-    case kUndefined:
+    default:
       throw exceptions::InvalidDirectionException();
   }
 }
@@ -599,7 +891,7 @@ glm::vec2 Room::GetWallHead(Direction dir) const {
     case kWest:
       return vec2(0, GetHeight());
 
-    case kUndefined:
+    default:
       throw exceptions::InvalidDirectionException();
   }
 }
@@ -620,7 +912,7 @@ glm::vec2 Room::GetWallTail(Direction dir) const {
     case kWest:
       return vec2(0, 0);
 
-    case kUndefined:
+    default:
       throw exceptions::InvalidDirectionException();
   }
 }
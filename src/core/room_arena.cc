@@ -0,0 +1,131 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/room_arena.h>
+
+#include <core/room.h>
+
+#include <memory>
+#include <stdexcept>
+
+namespace room_explorer {
+
+const size_t RoomArena::kFirstChunkBits;
+const size_t RoomArena::kFirstChunkSize;
+const size_t RoomArena::kMaxChunks;
+
+struct RoomArena::Chunk {
+  std::unique_ptr<Room[]> rooms_;
+  std::unique_ptr<std::atomic<RoomId>[]> released_links_;
+
+  explicit Chunk(size_t size) : rooms_(new Room[size]), released_links_(new std::atomic<RoomId>[size]) {}
+};
+
+// Constructors ========================================================================================================
+RoomArena::RoomArena() : slot_count_(0), room_count_(0), released_top_(kNoRoom) {
+  for (std::atomic<Chunk*>& chunk : chunks_) {
+    chunk.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+RoomArena::~RoomArena() {
+  for (std::atomic<Chunk*>& chunk : chunks_) {
+    delete chunk.load(std::memory_order_relaxed);
+  }
+}
+// End of Constructors =================================================================================================
+
+
+// Arena Methods =======================================================================================================
+RoomId RoomArena::Allocate() {
+  // Tag changes on every push and pop, so a top popped and pushed back meanwhile fails the exchange
+  uint64_t top{released_top_.load(std::memory_order_acquire)};
+  while (static_cast<RoomId>(top) != kNoRoom) {
+    RoomId id{static_cast<RoomId>(top)};
+    uint64_t below{ReleasedLink(id).load(std::memory_order_relaxed)};
+    uint64_t tag{(top >> 32) + 1};
+    if (released_top_.compare_exchange_weak(top, (tag << 32) | below,
+                                            std::memory_order_acq_rel, std::memory_order_acquire)) {
+      room_count_.fetch_add(1, std::memory_order_relaxed);
+      return id;
+    }
+  }
+
+  size_t count{slot_count_.load(std::memory_order_relaxed)};
+  while (true) {
+    size_t chunk, index;
+    Locate(static_cast<RoomId>(count), chunk, index);
+    if (chunk >= kMaxChunks || count >= kNoRoom) {
+      throw std::length_error("Room arena is out of room ids");
+    }
+
+    // Chunk is in place before the id is handed out, for threads looking rooms up by count
+    InstallChunk(chunk);
+    if (slot_count_.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+      room_count_.fetch_add(1, std::memory_order_relaxed);
+      return static_cast<RoomId>(count);
+    }
+  }
+}
+
+Room& RoomArena::Get(RoomId id) const {
+  size_t chunk, index;
+  Locate(id, chunk, index);
+  return chunks_[chunk].load(std::memory_order_acquire)->rooms_[index];
+}
+
+void RoomArena::Release(RoomId id) {
+  Get(id) = Room();
+
+  // Room is reset before its id is pushed, for the thread popping it to see it reset
+  uint64_t top{released_top_.load(std::memory_order_relaxed)};
+  do {
+    ReleasedLink(id).store(static_cast<RoomId>(top), std::memory_order_relaxed);
+  } while (!released_top_.compare_exchange_weak(top, (((top >> 32) + 1) << 32) | id,
+                                                 std::memory_order_release, std::memory_order_relaxed));
+  room_count_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t RoomArena::RoomCount() const {
+  return room_count_.load(std::memory_order_relaxed);
+}
+
+size_t RoomArena::SlotCount() const {
+  return slot_count_.load(std::memory_order_acquire);
+}
+
+RoomArena::Chunk& RoomArena::InstallChunk(size_t chunk) {
+  Chunk* installed{chunks_[chunk].load(std::memory_order_acquire)};
+  if (installed != nullptr) {
+    return *installed;
+  }
+
+  // First room of a chunk allocates the whole chunk, rooms and all. Threads racing for it keep the first installed.
+  std::unique_ptr<Chunk> allocated(new Chunk(kFirstChunkSize << chunk));
+  if (chunks_[chunk].compare_exchange_strong(installed, allocated.get(),
+                                             std::memory_order_acq_rel, std::memory_order_acquire)) {
+    return *allocated.release();
+  }
+  return *installed;
+}
+
+std::atomic<RoomId>& RoomArena::ReleasedLink(RoomId id) const {
+  size_t chunk, index;
+  Locate(id, chunk, index);
+  return chunks_[chunk].load(std::memory_order_acquire)->released_links_[index];
+}
+
+void RoomArena::Locate(RoomId id, size_t& chunk, size_t& index) {
+  // Chunk k starts at id kFirstChunkSize * (2^k - 1). Biased by the first chunk size, it starts at a power of two.
+  uint64_t biased{static_cast<uint64_t>(id) + kFirstChunkSize};
+  size_t top_bit{kFirstChunkBits};
+  while ((biased >> (top_bit + 1)) != 0) {
+    ++top_bit;
+  }
+  chunk = top_bit - kFirstChunkBits;
+  index = static_cast<size_t>(biased - (uint64_t{1} << top_bit));
+}
+// End of Arena Methods ================================================================================================
+
+} // namespace room_explorer
@@ -4,52 +4,616 @@
 
 #include <core/room_factory.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+
 namespace room_explorer {
 
+namespace {
+// Salts keeping keys of rooms generated on their own, and the seed, apart from keys reached through links
+const RoomKey kDrawKeySalt = 0x2545F4914F6CDD1D;
+const RoomKey kSeedSalt = 0x5851F42D4C957F2D;
+
+/**
+ * Key of the room generated on its own by the draw of given number.
+ */
+RoomKey DrawKey(uint64_t draw) {
+  return MixKey(draw ^ kDrawKeySalt);
+}
+
+/**
+ * Side of a room, as named in templates, indexed by Direction.
+ */
+size_t SideOfName(const std::string& name) {
+  if (name == "north") {
+    return kNorth;
+  } else if (name == "south") {
+    return kSouth;
+  } else if (name == "east") {
+    return kEast;
+  } else if (name == "west") {
+    return kWest;
+  }
+  throw exceptions::InvalidDirectionException();
+}
+
+/**
+ * Whether a template may have the weight. Negative, infinite and NaN weights have no share to be drawn with.
+ */
+bool IsValidWeight(float weight) {
+  return std::isfinite(weight) && weight >= 0;
+}
+
+/**
+ * Walks over text, keeping where it has read up to, for the indexer to tell where the values it is handed lie.
+ */
+class TrackedIterator {
+public:
+  typedef std::input_iterator_tag iterator_category;
+  typedef char value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef const char* pointer;
+  typedef const char& reference;
+
+  TrackedIterator(const char* position, const char** read_up_to) : position_(position), read_up_to_(read_up_to) {}
+
+  reference operator*() const {
+    return *position_;
+  }
+  TrackedIterator& operator++() {
+    *read_up_to_ = ++position_;
+    return *this;
+  }
+  bool operator==(const TrackedIterator& other) const {
+    return position_ == other.position_;
+  }
+  bool operator!=(const TrackedIterator& other) const {
+    return position_ != other.position_;
+  }
+
+private:
+  const char* position_;
+  const char** read_up_to_;
+};
+
+/**
+ * Reads a map from SAX events. Keeps every field of the map and of its templates but the walls,
+ *    and the byte range of the JSON of each template, without building the JSON of the walls.
+ * The parser hands over braces as soon as it reads them, so the text read up to ends with the brace of the event.
+ */
+class TemplateIndexer : public nlohmann::json_sax<json> {
+public:
+  struct IndexedTemplate {
+    std::string id_;
+    json fields_; // Every field of the template but the walls
+    size_t begin_, end_;
+    bool has_walls_;
+  };
+
+  TemplateIndexer(const char* text, const char* const* read_up_to) : text_(text), read_up_to_(read_up_to) {}
+
+  const json& GetMapFields() const {
+    return map_fields_;
+  }
+  const std::vector<IndexedTemplate>& GetTemplates() const {
+    return templates_;
+  }
+  bool HasRooms() const {
+    return has_rooms_;
+  }
+
+  // SAX Events ========================================================================================================
+  bool null() override {
+    return Value(nullptr);
+  }
+  bool boolean(bool value) override {
+    return Value(value);
+  }
+  bool number_integer(number_integer_t value) override {
+    return Value(value);
+  }
+  bool number_unsigned(number_unsigned_t value) override {
+    return Value(value);
+  }
+  bool number_float(number_float_t value, const string_t&) override {
+    return Value(value);
+  }
+  bool string(string_t& value) override {
+    return Value(std::move(value));
+  }
+  bool binary(binary_t& value) override {
+    return Value(json::binary(std::move(value)));
+  }
+
+  bool start_object(std::size_t) override {
+    return Open(json::object());
+  }
+  bool key(string_t& key) override {
+    key_ = std::move(key);
+    return true;
+  }
+  bool end_object() override {
+    if (frames_.back() == kTemplate) {
+      IndexedTemplate& indexed = templates_.back();
+      indexed.end_ = static_cast<size_t>(*read_up_to_ - text_);
+      if (!indexed.has_walls_) {
+        throw json::out_of_range::create(403, "key 'walls' not found");
+      }
+    }
+    return Close();
+  }
+  bool start_array(std::size_t) override {
+    return Open(json::array());
+  }
+  bool end_array() override {
+    return Close();
+  }
+
+  bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& exception) override {
+    // Syntax errors and numbers out of range are reported through events. Thrown as their own type, as the DOM parser
+    //  would throw them.
+    if (const json::parse_error* syntax_error = dynamic_cast<const json::parse_error*>(&exception)) {
+      throw *syntax_error;
+    }
+    if (const json::out_of_range* range_error = dynamic_cast<const json::out_of_range*>(&exception)) {
+      throw *range_error;
+    }
+    throw json::other_error::create(exception.id, exception.what());
+  }
+  // End of SAX Events =================================================================================================
+
+private:
+  // What the value being read belongs to
+  enum Frame {
+    kMap, // Fields of the map
+    kRooms, // Templates, by id
+    kTemplate, // Fields of a template
+    kKept, // Values kept whole, in kept_
+    kSkipped // Walls, and everything within them
+  };
+
+  const char* text_;
+  const char* const* read_up_to_;
+
+  std::vector<Frame> frames_; // Innermost last
+  std::vector<json*> kept_; // Objects and arrays of kKept frames, innermost last
+  std::string key_; // Key of the value being read, if within an object
+
+  json map_fields_ = json::object();
+  bool has_rooms_{false};
+  std::vector<IndexedTemplate> templates_;
+
+  /**
+   * Where a value read now is kept, or nullptr if it is not.
+   */
+  json* Slot() {
+    if (frames_.empty()) {
+      throw json::type_error::create(302, "type must be object, but the map is not one");
+    }
+    switch (frames_.back()) {
+      case kMap:
+        if (key_ == "rooms") {
+          throw json::type_error::create(302, "type must be object, but rooms is not one");
+        }
+        return &map_fields_[key_];
+      case kRooms:
+        throw json::type_error::create(302, "type must be object, but template " + key_ + " is not one");
+      case kTemplate:
+        if (key_ == "walls") {
+          templates_.back().has_walls_ = true;
+          return nullptr;
+        }
+        return &templates_.back().fields_[key_];
+      case kKept:
+        if (kept_.back()->is_array()) {
+          kept_.back()->push_back(nullptr);
+          return &kept_.back()->back();
+        }
+        return &(*kept_.back())[key_];
+      case kSkipped:
+        return nullptr;
+    }
+    return nullptr;
+  }
+
+  bool Value(json value) {
+    json* slot{Slot()};
+    if (slot != nullptr) {
+      *slot = std::move(value);
+    }
+    return true;
+  }
+
+  bool Open(json container) {
+    if (frames_.empty()) {
+      if (!container.is_object()) {
+        throw json::type_error::create(302, "type must be object, but the map is not one");
+      }
+      frames_.push_back(kMap);
+    } else if (frames_.back() == kMap && key_ == "rooms") {
+      if (!container.is_object()) {
+        throw json::type_error::create(302, "type must be object, but rooms is not one");
+      }
+      frames_.push_back(kRooms);
+      has_rooms_ = true;
+    } else if (frames_.back() == kRooms) {
+      if (!container.is_object()) {
+        throw json::type_error::create(302, "type must be object, but template " + key_ + " is not one");
+      }
+      size_t begin{static_cast<size_t>(*read_up_to_ - text_) - 1};
+      templates_.push_back({key_, json::object(), begin, begin, false});
+      frames_.push_back(kTemplate);
+    } else {
+      json* slot{Slot()};
+      if (slot == nullptr) {
+        frames_.push_back(kSkipped);
+      } else {
+        *slot = std::move(container);
+        frames_.push_back(kKept);
+        kept_.push_back(slot);
+      }
+    }
+    return true;
+  }
+
+  bool Close() {
+    if (frames_.back() == kKept) {
+      kept_.pop_back();
+    }
+    frames_.pop_back();
+    return true;
+  }
+};
+} // namespace
+
+// Constructors ========================================================================================================
+RoomFactory::RoomFactory()
+    : kTemplateCounts_(0), kSeed_(0), kRoomCapacity_(0), arena_(new RoomArena()),
+      generation_(new GenerationState()) {}
+// End of Constructors =================================================================================================
+
+
 // JSON Loaders ========================================================================================================
 void from_json(const json& json, RoomFactory& room_factory) {
-  room_factory.kRoomWidth_ = json.at("room_dimension").at("width");
-  room_factory.kRoomHeight_ = json.at("room_dimension").at("height");
+  room_factory.SetMapFields(json);
+
+  //Use for each items instead of copy to not have to copy id and templates separately
+  for (auto& item : json.at("rooms").items()) {
+    room_factory.AddTemplate(item.key(), item.value());
+  }
+  room_factory.CompileTemplates();
+}
+
+void from_json(const json& json, RoomFactory::RoomTemplate& room_template) {
+  room_template.walls_ = WallArray(json.at("walls").get<std::vector<Wall>>());
+  RoomFactory::SetTemplateFields(json, room_template);
+}
+// End of JSON Loaders =================================================================================================
+
+// Template Loading ====================================================================================================
+void RoomFactory::SetDimensions(float width, float height, float ns_door_width, float ew_door_width) {
+  kRoomWidth_ = width;
+  kRoomHeight_ = height;
+  kNSDoorWidth_ = ns_door_width;
+  kEWDoorWidth_ = ew_door_width;
+
+  kNSDoorBegin_ = (kRoomWidth_ - kNSDoorWidth_) / 2;
+  kEWDoorBegin_ = (kRoomHeight_ - kEWDoorWidth_) / 2;
+
+  kBounds_.width_ = kRoomWidth_;
+  kBounds_.height_ = kRoomHeight_;
+  kBounds_.ns_door_begin_ = GetNSPortalBegin();
+  kBounds_.ns_door_end_ = GetNSPortalEnd();
+  kBounds_.ew_door_begin_ = GetEWPortalBegin();
+  kBounds_.ew_door_end_ = GetEWPortalEnd();
+  // FloatApproximation against 0 is absolute, against the far edges relative to the room size
+  kBounds_.edge_epsilon_ = .0000005f;
+  kBounds_.width_tolerance_ = kBounds_.edge_epsilon_ * std::abs(kBounds_.width_);
+  kBounds_.height_tolerance_ = kBounds_.edge_epsilon_ * std::abs(kBounds_.height_);
+}
+
+void RoomFactory::SetMapFields(const json& json) {
+  SetDimensions(json.at("room_dimension").at("width"), json.at("room_dimension").at("height"),
+                json.at("room_dimension").at("ns_door_width"), json.at("room_dimension").at("ew_door_width"));
 
   // Initialize position only if provided. Default to center of the room
   if (json.contains("entry_x")) {
-    room_factory.kEntryPosition_.x = json.at("entry_x");
+    kEntryPosition_.x = json.at("entry_x");
   } else {
-    room_factory.kEntryPosition_.x = room_factory.kRoomWidth_ / 2;
+    kEntryPosition_.x = kRoomWidth_ / 2;
   }
   if (json.contains("entry_y")) {
-    room_factory.kEntryPosition_.y = json.at("entry_y");
+    kEntryPosition_.y = json.at("entry_y");
   } else {
-    room_factory.kEntryPosition_.y = room_factory.kRoomHeight_ / 2;
+    kEntryPosition_.y = kRoomHeight_ / 2;
   }
 
-  room_factory.kNSDoorWidth_ = json.at("room_dimension").at("ns_door_width");
-  room_factory.kEWDoorWidth_ = json.at("room_dimension").at("ew_door_width");
+  // Unseeded maps are all the same map, and unbounded maps never evict
+  kSeed_ = json.contains("seed") ? json.at("seed").get<uint64_t>() : 0;
+  kRoomCapacity_ = json.contains("room_capacity") ? json.at("room_capacity").get<size_t>() : 0;
+}
 
-  room_factory.kNSDoorBegin_ = (room_factory.kRoomWidth_ - room_factory.kNSDoorWidth_) / 2;
-  room_factory.kEWDoorBegin_ = (room_factory.kRoomHeight_ - room_factory.kEWDoorWidth_) / 2;
+void RoomFactory::SetTemplateFields(const json& json, RoomTemplate& room_template) {
+  // Walls are walked through the grid unless the template asks for the tree
+  room_template.uses_bsp_ = json.contains("wall_partition") && json.at("wall_partition") == "bsp";
 
-  //Use for each items instead of copy to not have to copy id and templates separately
-  for (auto& item : json.at("rooms").items()) {
-    const std::string& id = item.key();
+  // Any template may sit on any side unless told otherwise, and every door is open
+  room_template.weight_ = json.contains("weight") ? json.at("weight").get<float>() : 1;
+  if (!IsValidWeight(room_template.weight_)) {
+    throw exceptions::InvalidTemplateWeightException();
+  }
+  if (json.contains("open_sides")) {
+    std::fill(std::begin(room_template.open_sides_), std::end(room_template.open_sides_), false);
+    for (const auto& side : json.at("open_sides")) {
+      room_template.open_sides_[SideOfName(side)] = true;
+    }
+  }
+  if (json.contains("neighbours")) {
+    for (auto& rule : json.at("neighbours").items()) {
+      room_template.neighbour_ids_[SideOfName(rule.key())] = rule.value().get<std::vector<std::string>>();
+    }
+  }
+}
+
+void RoomFactory::AddTemplate(const std::string& id, RoomTemplate room_template) {
+  kIds_.insert(id);
+  RoomTemplate& added = kRoomTemplates_.insert(std::make_pair(id, std::move(room_template))).first->second;
+
+  // Grid covers the room, so it can only be built once the dimensions are known
+  BuildWallPartitions(added, kBounds_);
+}
 
-    room_factory.kIds_.insert(id);
-    room_factory.kRoomTemplates_.insert(std::pair<std::string, RoomFactory::RoomTemplate>(id, item.value()));
+void RoomFactory::BuildWallPartitions(RoomTemplate& room_template, const RoomBounds& bounds) {
+  // Every wall left is traced by every ray that reaches it, so walls that change no hit go first
+  std::vector<Wall> walls{CleanUpWalls(room_template.walls_.GetWalls(), bounds, room_template.cleanup_report_)};
+  room_template.walls_ = WallArray(walls);
+
+  room_template.wall_grid_ = WallGrid(walls, bounds);
+  if (room_template.uses_bsp_) {
+    room_template.wall_bsp_ = WallBsp(walls, bounds);
   }
+}
+
+void RoomFactory::CompileTemplates() {
+  kTemplateCounts_ = kIds_.size();
+  kIdList_.assign(kIds_.begin(), kIds_.end());
 
-  room_factory.kTemplateCounts_ = room_factory.kIds_.size();
+  // Weights and neighbour rules are compiled once every id is known, in the order of the ids
+  std::vector<TemplateAdjacency::TemplateSides> sides(kTemplateCounts_);
+  kTemplateWeights_.clear();
+  for (size_t index = 0; index < kTemplateCounts_; ++index) {
+    const RoomTemplate& room_template = kRoomTemplates_.at(kIdList_[index]);
+    kTemplateWeights_.push_back(room_template.weight_);
+
+    std::copy(std::begin(room_template.open_sides_), std::end(room_template.open_sides_), sides[index].open_);
+    for (const auto& rule : room_template.neighbour_ids_) {
+      sides[index].ruled_[rule.first] = true;
+      for (const std::string& neighbour_id : rule.second) {
+        auto found = std::lower_bound(kIdList_.begin(), kIdList_.end(), neighbour_id);
+        if (found == kIdList_.end() || *found != neighbour_id) {
+          throw exceptions::NoRoomTemplateException();
+        }
+        sides[index].allowed_[rule.first].push_back(found - kIdList_.begin());
+      }
+    }
+  }
+  kTemplateAlias_ = AliasTable(kTemplateWeights_);
+  kAdjacency_ = TemplateAdjacency(sides);
 }
+// End of Template Loading =============================================================================================
 
-void from_json(const json& json, RoomFactory::RoomTemplate& room_template) {
-  std::copy(json.at("walls").begin(), json.at("walls").end(),
-            std::inserter(room_template.walls_, room_template.walls_.begin()));
+
+// Template Pack =======================================================================================================
+void RoomFactory::LoadPack(const TemplatePack& pack) {
+  const TemplatePackHeader& header{pack.GetHeader()};
+  // Weights are checked before anything is loaded, as packs may come from anywhere
+  for (size_t index = 0; index < header.template_count_; ++index) {
+    if (!IsValidWeight(pack.GetEntry(index).weight_)) {
+      throw exceptions::InvalidTemplatePackException();
+    }
+  }
+  SetDimensions(header.room_width_, header.room_height_, header.ns_door_width_, header.ew_door_width_);
+  kEntryPosition_ = glm::vec2(header.entry_x_, header.entry_y_);
+  kSeed_ = header.seed_;
+  kRoomCapacity_ = static_cast<size_t>(header.room_capacity_);
+
+  // Walls are read straight from the mapped arrays
+  const float* head_x{pack.GetHeadX()};
+  const float* head_y{pack.GetHeadY()};
+  const float* tail_x{pack.GetTailX()};
+  const float* tail_y{pack.GetTailY()};
+  for (size_t index = 0; index < header.template_count_; ++index) {
+    const TemplatePackEntry& entry{pack.GetEntry(index)};
+    RoomTemplate room_template;
+    std::vector<Wall> walls;
+    for (size_t wall = entry.first_wall_; wall < entry.first_wall_ + entry.wall_count_; ++wall) {
+      walls.emplace_back(glm::vec2(head_x[wall], head_y[wall]), glm::vec2(tail_x[wall], tail_y[wall]));
+    }
+    room_template.walls_ = WallArray(walls);
+
+    room_template.uses_bsp_ = (entry.flags_ & TemplatePack::kUsesBspFlag) != 0;
+    room_template.weight_ = entry.weight_;
+    for (size_t side = 0; side < TemplateAdjacency::kSideCount; ++side) {
+      room_template.open_sides_[side] = (entry.flags_ & TemplatePack::OpenSideFlag(side)) != 0;
+      if (entry.flags_ & TemplatePack::RuledSideFlag(side)) {
+        std::vector<std::string>& neighbour_ids = room_template.neighbour_ids_[side];
+        for (size_t i = 0; i < entry.neighbour_count_[side]; ++i) {
+          neighbour_ids.push_back(pack.GetId(pack.GetNeighbours()[entry.first_neighbour_[side] + i]));
+        }
+      }
+    }
+    AddTemplate(pack.GetId(index), std::move(room_template));
+  }
+  CompileTemplates();
 }
-// End of JSON Loaders =================================================================================================
+
+void RoomFactory::WritePack(std::ostream& out) const {
+  TemplatePackContents contents;
+  TemplatePackHeader& header = contents.header_;
+  header.room_width_ = kRoomWidth_;
+  header.room_height_ = kRoomHeight_;
+  header.ns_door_width_ = kNSDoorWidth_;
+  header.ew_door_width_ = kEWDoorWidth_;
+  header.entry_x_ = kEntryPosition_.x;
+  header.entry_y_ = kEntryPosition_.y;
+  header.seed_ = kSeed_;
+  header.room_capacity_ = kRoomCapacity_;
+
+  // Templates are written in the order of the ids, so that neighbours are written as their index
+  for (size_t index = 0; index < kTemplateCounts_; ++index) {
+    const std::string& id{kIdList_[index]};
+    const RoomTemplate& room_template = GetTemplate(index);
+    TemplatePackEntry entry{};
+    entry.id_offset_ = static_cast<uint32_t>(contents.strings_.size());
+    entry.id_length_ = static_cast<uint32_t>(id.size());
+    contents.strings_ += id;
+
+    entry.first_wall_ = static_cast<uint32_t>(contents.head_x_.size());
+    entry.wall_count_ = static_cast<uint32_t>(room_template.walls_.Size());
+    for (const Wall& wall : room_template.walls_.GetWalls()) {
+      contents.head_x_.push_back(wall.GetHead().x);
+      contents.head_y_.push_back(wall.GetHead().y);
+      contents.tail_x_.push_back(wall.GetTail().x);
+      contents.tail_y_.push_back(wall.GetTail().y);
+    }
+
+    entry.weight_ = room_template.weight_;
+    entry.flags_ = room_template.uses_bsp_ ? TemplatePack::kUsesBspFlag : 0;
+    for (size_t side = 0; side < TemplateAdjacency::kSideCount; ++side) {
+      if (room_template.open_sides_[side]) {
+        entry.flags_ |= TemplatePack::OpenSideFlag(side);
+      }
+      entry.first_neighbour_[side] = static_cast<uint32_t>(contents.neighbours_.size());
+      auto rule = room_template.neighbour_ids_.find(side);
+      if (rule != room_template.neighbour_ids_.end()) {
+        entry.flags_ |= TemplatePack::RuledSideFlag(side);
+        for (const std::string& neighbour_id : rule->second) {
+          auto found = std::lower_bound(kIdList_.begin(), kIdList_.end(), neighbour_id);
+          contents.neighbours_.push_back(static_cast<uint32_t>(found - kIdList_.begin()));
+        }
+      }
+      entry.neighbour_count_[side] = static_cast<uint32_t>(contents.neighbours_.size()) - entry.first_neighbour_[side];
+    }
+    contents.entries_.push_back(entry);
+  }
+
+  TemplatePack::Write(contents, out);
+}
+// End of Template Pack ================================================================================================
+
+
+// Lazy JSON Loader ====================================================================================================
+RoomFactory::LazyTemplates::~LazyTemplates() {
+  stopping_.store(true, std::memory_order_relaxed);
+  if (background_.joinable()) {
+    background_.join();
+  }
+}
+
+void RoomFactory::LoadJsonLazily(std::istream& in) {
+  std::unique_ptr<LazyTemplates> lazy(new LazyTemplates());
+  lazy->text_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+  // Indexer learns where each template lies from how far the parser has read
+  const char* text{lazy->text_.data()};
+  const char* read_up_to{text};
+  TemplateIndexer indexer(text, &read_up_to);
+  json::sax_parse(TrackedIterator(text, &read_up_to), TrackedIterator(text + lazy->text_.size(), &read_up_to),
+                  &indexer);
+  if (!indexer.HasRooms()) {
+    throw json::out_of_range::create(403, "key 'rooms' not found");
+  }
+
+  SetMapFields(indexer.GetMapFields());
+  // Later templates of the same id replace earlier ones, as they do in the JSON document
+  std::map<std::string, std::pair<size_t, size_t>> ranges;
+  for (const TemplateIndexer::IndexedTemplate& indexed : indexer.GetTemplates()) {
+    RoomTemplate room_template;
+    SetTemplateFields(indexed.fields_, room_template);
+    kIds_.insert(indexed.id_);
+    kRoomTemplates_[indexed.id_] = std::move(room_template);
+    ranges[indexed.id_] = std::make_pair(indexed.begin_, indexed.end_);
+  }
+  CompileTemplates();
+
+  for (const std::string& id : kIdList_) {
+    lazy->ranges_.push_back(ranges.at(id));
+    lazy->templates_.push_back(&kRoomTemplates_.at(id));
+  }
+  lazy->materialized_.reset(new std::atomic<bool>[kTemplateCounts_]());
+  lazy->bounds_ = kBounds_;
+  lazy_ = std::move(lazy);
+}
+
+void RoomFactory::MaterializeInBackground() {
+  if (!lazy_ || lazy_->background_.joinable()) {
+    return;
+  }
+
+  // Templates stay where they are when the factory is moved, so the thread only needs them
+  LazyTemplates* lazy{lazy_.get()};
+  lazy->background_ = std::thread([lazy]() {
+    for (size_t index = 0; index < lazy->ranges_.size() && !lazy->stopping_.load(std::memory_order_relaxed); ++index) {
+      try {
+        Materialize(*lazy, index);
+      } catch (const std::exception&) {
+        // Left as it is, to be thrown again by whoever generates a room of the template
+      }
+    }
+  });
+}
+
+bool RoomFactory::IsMaterialized(const std::string& id) const {
+  if (!ContainsRoomId(id)) {
+    return false;
+  }
+  if (!lazy_) {
+    return true;
+  }
+  size_t template_index = std::lower_bound(kIdList_.begin(), kIdList_.end(), id) - kIdList_.begin();
+  return lazy_->materialized_[template_index].load(std::memory_order_acquire);
+}
+
+const RoomFactory::RoomTemplate& RoomFactory::GetTemplate(size_t template_index) const {
+  if (lazy_) {
+    Materialize(*lazy_, template_index);
+  }
+  return kRoomTemplates_.at(kIdList_[template_index]);
+}
+
+void RoomFactory::Materialize(LazyTemplates& lazy, size_t template_index) {
+  if (lazy.materialized_[template_index].load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(lazy.materialize_mutex_);
+  if (lazy.materialized_[template_index].load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  // Only the JSON of the template is parsed, and only the walls are taken from it
+  const char* text{lazy.text_.data()};
+  const std::pair<size_t, size_t>& range{lazy.ranges_[template_index]};
+  json template_json = json::parse(text + range.first, text + range.second);
+
+  RoomTemplate& room_template = *lazy.templates_[template_index];
+  room_template.walls_ = WallArray(template_json.at("walls").get<std::vector<Wall>>());
+  BuildWallPartitions(room_template, lazy.bounds_);
+  lazy.materialized_[template_index].store(true, std::memory_order_release);
+
+  if (++lazy.materialized_count_ == lazy.ranges_.size()) {
+    std::string().swap(lazy.text_);
+  }
+}
+// End of Lazy JSON Loader =============================================================================================
+
+
 
 
 // Room Template Getters ===============================================================================================
 size_t RoomFactory::RoomTemplate::GetWallCount() const {
-  return walls_.size();
+  return walls_.Size();
 }
 // End of Room Template Getters ========================================================================================
 
@@ -86,6 +650,10 @@ float RoomFactory::GetEWPortalEnd() const {
 const glm::vec2& RoomFactory::GetEntryPosition() const {
   return kEntryPosition_;
 }
+
+const RoomBounds& RoomFactory::GetBounds() const {
+  return kBounds_;
+}
 // End of Geometric Getters ==========================================================
 
 // Template Characteristics Getters ==================================================
@@ -94,13 +662,40 @@ size_t RoomFactory::RoomTemplateCount() const {
 }
 
 const std::string &RoomFactory::RandomId() const {
-  auto it = kIds_.begin();
   if (kTemplateCounts_ == 0) {
     throw exceptions::NoRoomTemplateException();
   }
-  size_t advance_length = std::rand() % kTemplateCounts_;
-  std::advance(it, advance_length);
-  return *it;
+  uint64_t draw{generation_->draw_count_.fetch_add(1, std::memory_order_relaxed)};
+  return TemplateIdOf(DrawKey(draw));
+}
+
+const std::string& RoomFactory::TemplateIdOf(RoomKey key, bool fitted) const {
+  if (kTemplateCounts_ == 0) {
+    throw exceptions::NoRoomTemplateException();
+  }
+  return kIdList_[TemplateIndexOf(key, fitted)];
+}
+
+size_t RoomFactory::TemplateIndexOf(RoomKey key, bool fitted) const {
+  size_t pinned{generation_->pinned_templates_.Find(key)};
+  if (pinned != PinnedTemplates::kNoTemplate) {
+    return pinned;
+  }
+
+  uint64_t bits{MixKey(key ^ MixKey(kSeed_ + kSeedSalt))};
+  if (!fitted) {
+    return kTemplateAlias_.Sample(bits);
+  }
+
+  // Neighbours are chosen freely, so their templates follow from their keys without generating them
+  size_t neighbours[TemplateAdjacency::kSideCount];
+  size_t sides[TemplateAdjacency::kSideCount];
+  const Direction directions[] = {kNorth, kSouth, kEast, kWest};
+  for (size_t i = 0; i < TemplateAdjacency::kSideCount; ++i) {
+    neighbours[i] = TemplateIndexOf(Room::NeighbourKey(key, directions[i]), false);
+    sides[i] = !directions[i];
+  }
+  return kAdjacency_.PickFitted(neighbours, sides, kTemplateWeights_, bits);
 }
 
 const std::set<std::string>& RoomFactory::GetAvailableIds() const {
@@ -108,6 +703,30 @@ const std::set<std::string>& RoomFactory::GetAvailableIds() const {
 }
 // End of Template Characteristics Getters ===========================================
 
+uint64_t RoomFactory::GetSeed() const {
+  return kSeed_;
+}
+
+size_t RoomFactory::GetRoomCapacity() const {
+  return kRoomCapacity_;
+}
+
+size_t RoomFactory::GeneratedRoomCount() const {
+  return arena_->RoomCount();
+}
+
+size_t RoomFactory::PinnedKeyCount() const {
+  return generation_->pinned_templates_.Size();
+}
+
+WallCleanupReport RoomFactory::GetWallCleanupReport() const {
+  WallCleanupReport report;
+  for (size_t index = 0; index < kTemplateCounts_; ++index) {
+    report += GetTemplate(index).cleanup_report_;
+  }
+  return report;
+}
+
 // End of Room Factory Getters =========================================================================================
 
 // Room Factory Generation Methods =====================================================================================
@@ -119,22 +738,118 @@ Room* RoomFactory::GenerateRoom(const std::string &id) const {
   if (!ContainsRoomId(id)) {
     return nullptr;
   }
+  return GenerateRoom(id, DrawKey(generation_->draw_count_.fetch_add(1, std::memory_order_relaxed)));
+}
+
+Room* RoomFactory::GenerateRoom(const std::string& id, RoomKey key, bool fitted) const {
+  if (!ContainsRoomId(id)) {
+    return nullptr;
+  }
+
+  // Key remembers the template, for the room to be generated the same should it be evicted.
+  //  Only the first template pinned to a key counts, so that every room ever generated at the key is the same.
+  size_t template_index = std::lower_bound(kIdList_.begin(), kIdList_.end(), id) - kIdList_.begin();
+  template_index = generation_->pinned_templates_.Pin(key, template_index);
+  return BuildRoom(template_index, key, fitted);
+}
 
-  Room* room = new Room();
+Room* RoomFactory::GenerateRoomAt(RoomKey key, bool fitted) const {
+  if (kTemplateCounts_ == 0) {
+    throw exceptions::NoRoomTemplateException();
+  }
+  return BuildRoom(TemplateIndexOf(key, fitted), key, fitted);
+}
+
+Room* RoomFactory::GenerateRandomRoom() const {
+  if (kTemplateCounts_ == 0) {
+    throw exceptions::NoRoomTemplateException();
+  }
+  return GenerateRoomAt(DrawKey(generation_->draw_count_.fetch_add(1, std::memory_order_relaxed)), false);
+}
+
+size_t RoomFactory::EvictDistantRooms(const Room* center) {
+  if (kRoomCapacity_ == 0 || arena_->RoomCount() <= kRoomCapacity_) {
+    return 0;
+  }
+
+  // Rooms closest to the center through links are kept, in the order of a breadth first walk
+  size_t keep_count{std::max<size_t>(kRoomCapacity_ / 2, 1)};
+  size_t slot_count{arena_->SlotCount()};
+  std::vector<bool> kept(slot_count, false);
+  std::vector<RoomId> kept_ids{center->id_};
+  kept[center->id_] = true;
+  for (size_t i = 0; i < kept_ids.size() && kept_ids.size() < keep_count; ++i) {
+    for (const RoomLink& room_link : arena_->Get(kept_ids[i]).links_) {
+      RoomId link{room_link.Load()};
+      if (link != kNoRoom && !kept[link] && kept_ids.size() < keep_count) {
+        kept[link] = true;
+        kept_ids.push_back(link);
+      }
+    }
+  }
+
+  // Rooms linked to the center in any way may be walked back to, and so keep their pins
+  std::vector<bool> reachable(kept);
+  std::vector<RoomId> reachable_ids(kept_ids);
+  for (size_t i = 0; i < reachable_ids.size(); ++i) {
+    for (const RoomLink& room_link : arena_->Get(reachable_ids[i]).links_) {
+      RoomId link{room_link.Load()};
+      if (link != kNoRoom && !reachable[link]) {
+        reachable[link] = true;
+        reachable_ids.push_back(link);
+      }
+    }
+  }
+
+  // Links are a tree, so each evicted room next to a kept one is only linked to that one room
+  for (RoomId id : kept_ids) {
+    for (RoomLink& link : arena_->Get(id).links_) {
+      RoomId linked{link.Load()};
+      if (linked != kNoRoom && !kept[linked]) {
+        link.Store(kNoRoom);
+      }
+    }
+  }
+
+  size_t evicted_count{0};
+  std::vector<RoomKey> unpinned_keys;
+  for (RoomId id = 0; id < slot_count; ++id) {
+    if (!kept[id] && arena_->Get(id).id_ != kNoRoom) {
+      // No way leads back to the room, so its key will not be generated again
+      if (!reachable[id]) {
+        unpinned_keys.push_back(arena_->Get(id).key_);
+      }
+      arena_->Release(id);
+      ++evicted_count;
+    }
+  }
+  generation_->pinned_templates_.Unpin(unpinned_keys);
+  return evicted_count;
+}
+
+Room* RoomFactory::BuildRoom(size_t template_index, RoomKey key, bool fitted) const {
+  // Template comes first, as materializing it may throw
+  const RoomTemplate& room_temp = GetTemplate(template_index);
+
+  // Rooms live in the arena, and refer to each other by their id in it
+  RoomId room_id{arena_->Allocate()};
+  Room* room = &arena_->Get(room_id);
+  room->id_ = room_id;
+  room->arena_ = arena_.get();
+  room->key_ = key;
+  room->fitted_ = fitted;
   // Every room has to hold reference to factory from which it and its adjacent rooms are generated
   room->factory = this;
 
-  const RoomTemplate& room_temp = kRoomTemplates_.at(id);
   // Link straight to source. Reduces space complexity, which may be a source of slowness.
   // Due to non-euclidean physics, small repeating room unit will define infinite space.
   room->walls_ = &room_temp.walls_;
+  room->wall_grid_ = &room_temp.wall_grid_;
+  room->wall_bsp_ = room_temp.uses_bsp_ ? &room_temp.wall_bsp_ : nullptr;
+  room->bounds_ = kBounds_;
 
   return room;
 }
-
-Room* RoomFactory::GenerateRandomRoom() const {
-  return GenerateRoom(RandomId());
-}
 // End of Room Factory Generation Methods ==============================================================================
 
 } // namespace room_explorer
\ No newline at end of file
@@ -0,0 +1,58 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/room_key.h>
+
+namespace room_explorer {
+
+namespace {
+// Finalizer of SplitMix64. Each step is invertible, so the whole mix is.
+const uint64_t kFirstMultiplier = 0xBF58476D1CE4E5B9;
+const uint64_t kSecondMultiplier = 0x94D049BB133111EB;
+
+/**
+ * Inverse of an odd multiplier modulo 2^64, by Newton's iteration. Each iteration doubles the correct low bits.
+ */
+uint64_t MultiplicativeInverse(uint64_t multiplier) {
+  uint64_t inverse{multiplier}; // Correct to 3 bits for any odd multiplier
+  for (int i = 0; i < 5; ++i) {
+    inverse *= 2 - multiplier * inverse;
+  }
+  return inverse;
+}
+
+const uint64_t kFirstInverse = MultiplicativeInverse(kFirstMultiplier);
+const uint64_t kSecondInverse = MultiplicativeInverse(kSecondMultiplier);
+
+/**
+ * Undoes x ^= x >> shift. Each pass recovers another shift bits, from the top down.
+ */
+uint64_t UnshiftXor(uint64_t x, unsigned shift) {
+  uint64_t original{x};
+  for (unsigned recovered = shift; recovered < 64; recovered += shift) {
+    original = x ^ (original >> shift);
+  }
+  return original;
+}
+} // namespace
+
+RoomKey MixKey(RoomKey key) {
+  key ^= key >> 30;
+  key *= kFirstMultiplier;
+  key ^= key >> 27;
+  key *= kSecondMultiplier;
+  key ^= key >> 31;
+  return key;
+}
+
+RoomKey UnmixKey(RoomKey key) {
+  key = UnshiftXor(key, 31);
+  key *= kSecondInverse;
+  key = UnshiftXor(key, 27);
+  key *= kFirstInverse;
+  key = UnshiftXor(key, 30);
+  return key;
+}
+
+} // namespace room_explorer
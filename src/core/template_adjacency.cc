@@ -0,0 +1,159 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/template_adjacency.h>
+
+namespace room_explorer {
+
+const size_t TemplateAdjacency::kSideCount;
+
+namespace {
+size_t OppositeSide(size_t side) {
+  return side ^ 1;
+}
+
+bool SideAllows(const TemplateAdjacency::TemplateSides& sides, size_t side, size_t other_index) {
+  if (!sides.ruled_[side]) {
+    return true;
+  }
+  for (size_t allowed : sides.allowed_[side]) {
+    if (allowed == other_index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Index of the lowest set bit of a non-zero word, by de Bruijn multiplication.
+ */
+size_t LowestBit(uint64_t word) {
+  static const size_t kPositions[64] = {
+      0,  1,  48, 2,  57, 49, 28, 3,  61, 58, 50, 42, 38, 29, 17, 4,
+      62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+      63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+      46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9,  13, 8,  7,  6};
+  return kPositions[((word & (~word + 1)) * 0x03F79D71B4CB0A89) >> 58];
+}
+} // namespace
+
+// Constructors ========================================================================================================
+TemplateAdjacency::TemplateAdjacency() : template_count_(0), word_count_(0) {}
+
+TemplateAdjacency::TemplateAdjacency(const std::vector<TemplateSides>& sides)
+    : template_count_(sides.size()), word_count_((sides.size() + 63) / 64),
+      masks_(sides.size() * kSideCount * word_count_, 0) {
+  // Rules are only compiled once, so every pair is simply checked both ways
+  for (size_t index = 0; index < template_count_; ++index) {
+    for (size_t side = 0; side < kSideCount; ++side) {
+      uint64_t* mask{&masks_[(index * kSideCount + side) * word_count_]};
+      size_t opposite{OppositeSide(side)};
+      for (size_t other = 0; other < template_count_; ++other) {
+        if (SideAllows(sides[index], side, other) && SideAllows(sides[other], opposite, index)
+            && sides[index].open_[side] == sides[other].open_[opposite]) {
+          mask[other / 64] |= uint64_t{1} << (other % 64);
+        }
+      }
+    }
+  }
+}
+// End of Constructors =================================================================================================
+
+// Getters =============================================================================================================
+size_t TemplateAdjacency::TemplateCount() const {
+  return template_count_;
+}
+
+size_t TemplateAdjacency::WordCount() const {
+  return word_count_;
+}
+
+bool TemplateAdjacency::Allows(size_t index, size_t side, size_t other_index) const {
+  return (Mask(index, side)[other_index / 64] >> (other_index % 64)) & 1;
+}
+
+std::vector<uint64_t> TemplateAdjacency::FullMask() const {
+  std::vector<uint64_t> mask(word_count_, ~uint64_t{0});
+  if (template_count_ % 64 != 0) {
+    mask.back() = (uint64_t{1} << (template_count_ % 64)) - 1;
+  }
+  return mask;
+}
+// End of Getters ======================================================================================================
+
+bool TemplateAdjacency::Restrict(std::vector<uint64_t>& mask, size_t index, size_t side) const {
+  const uint64_t* allowed{Mask(index, side)};
+  uint64_t any{0};
+  for (size_t word = 0; word < word_count_; ++word) {
+    any |= mask[word] & allowed[word];
+  }
+  if (any == 0) {
+    return false;
+  }
+
+  for (size_t word = 0; word < word_count_; ++word) {
+    mask[word] &= allowed[word];
+  }
+  return true;
+}
+
+size_t TemplateAdjacency::PickFitted(const size_t (&indices)[kSideCount], const size_t (&sides)[kSideCount],
+                                     const std::vector<float>& weights, uint64_t bits) const {
+  // Masks of the sides kept. A word of the templates left is worked out again from them whenever it is needed.
+  const uint64_t* kept[kSideCount];
+  size_t kept_count{0};
+  auto left_word = [&](size_t word, const uint64_t* extra) {
+    uint64_t left{word + 1 == word_count_ && template_count_ % 64 != 0
+                  ? (uint64_t{1} << (template_count_ % 64)) - 1 : ~uint64_t{0}};
+    for (size_t i = 0; i < kept_count; ++i) {
+      left &= kept[i][word];
+    }
+    return extra != nullptr ? left & extra[word] : left;
+  };
+
+  for (size_t i = 0; i < kSideCount; ++i) {
+    const uint64_t* allowed{Mask(indices[i], sides[i])};
+    uint64_t any{0};
+    for (size_t word = 0; word < word_count_; ++word) {
+      any |= left_word(word, allowed);
+    }
+    if (any != 0) {
+      kept[kept_count++] = allowed;
+    }
+  }
+
+  double total{0};
+  size_t count{0};
+  for (size_t word = 0; word < word_count_; ++word) {
+    for (uint64_t left = left_word(word, nullptr); left != 0; left &= left - 1) {
+      total += weights[word * 64 + LowestBit(left)];
+      ++count;
+    }
+  }
+
+  // Top 53 bits make a double in [0, 1)
+  double target{static_cast<double>(bits >> 11) / static_cast<double>(uint64_t{1} << 53)};
+  target *= total > 0 ? total : count;
+  size_t last{0};
+  for (size_t word = 0; word < word_count_; ++word) {
+    for (uint64_t left = left_word(word, nullptr); left != 0; left &= left - 1) {
+      size_t index{word * 64 + LowestBit(left)};
+      double weight{total > 0 ? weights[index] : 1.0};
+      if (weight > 0) {
+        last = index;
+        if (target < weight) {
+          return index;
+        }
+        target -= weight;
+      }
+    }
+  }
+  return last; // Only reached by rounding
+}
+
+const uint64_t* TemplateAdjacency::Mask(size_t index, size_t side) const {
+  return &masks_[(index * kSideCount + side) * word_count_];
+}
+
+} // namespace room_explorer
@@ -0,0 +1,200 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/template_pack.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace room_explorer {
+
+const char TemplatePack::kMagic[8] = {'R', 'X', 'T', 'P', 'A', 'C', 'K', '\0'};
+const uint32_t TemplatePack::kVersion;
+const uint32_t TemplatePack::kByteOrderMark;
+const uint32_t TemplatePack::kUsesBspFlag;
+
+namespace {
+/**
+ * Writes the elements of the vector as they lie in memory.
+ */
+template <typename T>
+void WriteArray(const std::vector<T>& array, std::ostream& out) {
+  if (!array.empty()) {
+    out.write(reinterpret_cast<const char*>(array.data()), array.size() * sizeof(T));
+  }
+}
+} // namespace
+
+uint32_t TemplatePack::OpenSideFlag(size_t side) {
+  return uint32_t{1} << (1 + side);
+}
+
+uint32_t TemplatePack::RuledSideFlag(size_t side) {
+  return uint32_t{1} << (5 + side);
+}
+
+// Constructors ========================================================================================================
+TemplatePack::TemplatePack(const std::string& path) {
+#ifdef _WIN32
+  // No mapping without the Windows API. Reading the file whole still skips parsing.
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw exceptions::InvalidTemplatePackException();
+  }
+  buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+#else
+  int file{open(path.c_str(), O_RDONLY)};
+  if (file < 0) {
+    throw exceptions::InvalidTemplatePackException();
+  }
+  struct stat file_status;
+  if (fstat(file, &file_status) != 0 || file_status.st_size < static_cast<off_t>(sizeof(TemplatePackHeader))) {
+    close(file);
+    throw exceptions::InvalidTemplatePackException();
+  }
+  size_ = static_cast<size_t>(file_status.st_size);
+  void* mapping{mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0)};
+  // Mapping holds its own reference to the file
+  close(file);
+  if (mapping == MAP_FAILED) {
+    throw exceptions::InvalidTemplatePackException();
+  }
+  data_ = static_cast<const char*>(mapping);
+#endif
+
+  try {
+    Validate();
+  } catch (...) {
+#ifndef _WIN32
+    munmap(const_cast<char*>(data_), size_);
+#endif
+    throw;
+  }
+}
+
+TemplatePack::~TemplatePack() {
+#ifndef _WIN32
+  munmap(const_cast<char*>(data_), size_);
+#endif
+}
+// End of Constructors =================================================================================================
+
+bool TemplatePack::IsPack(const std::string& path) {
+  char magic[sizeof(kMagic)];
+  std::ifstream file(path, std::ios::binary);
+  return file.read(magic, sizeof(magic)) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0;
+}
+
+void TemplatePack::Write(const TemplatePackContents& contents, std::ostream& out) {
+  TemplatePackHeader header{contents.header_};
+  std::memcpy(header.magic_, kMagic, sizeof(kMagic));
+  header.version_ = kVersion;
+  header.byte_order_ = kByteOrderMark;
+  header.template_count_ = static_cast<uint32_t>(contents.entries_.size());
+  header.wall_count_ = static_cast<uint32_t>(contents.head_x_.size());
+  header.neighbour_count_ = static_cast<uint32_t>(contents.neighbours_.size());
+  header.string_size_ = static_cast<uint32_t>(contents.strings_.size());
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  WriteArray(contents.entries_, out);
+  WriteArray(contents.head_x_, out);
+  WriteArray(contents.head_y_, out);
+  WriteArray(contents.tail_x_, out);
+  WriteArray(contents.tail_y_, out);
+  WriteArray(contents.neighbours_, out);
+  out.write(contents.strings_.data(), contents.strings_.size());
+}
+
+// Getters =============================================================================================================
+const TemplatePackHeader& TemplatePack::GetHeader() const {
+  return *reinterpret_cast<const TemplatePackHeader*>(data_);
+}
+
+const TemplatePackEntry& TemplatePack::GetEntry(size_t index) const {
+  return entries_[index];
+}
+
+std::string TemplatePack::GetId(size_t index) const {
+  return std::string(strings_ + entries_[index].id_offset_, entries_[index].id_length_);
+}
+
+const float* TemplatePack::GetHeadX() const {
+  return head_x_;
+}
+
+const float* TemplatePack::GetHeadY() const {
+  return head_y_;
+}
+
+const float* TemplatePack::GetTailX() const {
+  return tail_x_;
+}
+
+const float* TemplatePack::GetTailY() const {
+  return tail_y_;
+}
+
+const uint32_t* TemplatePack::GetNeighbours() const {
+  return neighbours_;
+}
+// End of Getters ======================================================================================================
+
+void TemplatePack::Validate() {
+  if (size_ < sizeof(TemplatePackHeader)) {
+    throw exceptions::InvalidTemplatePackException();
+  }
+  const TemplatePackHeader& header{GetHeader()};
+  if (std::memcmp(header.magic_, kMagic, sizeof(kMagic)) != 0 || header.version_ != kVersion
+      || header.byte_order_ != kByteOrderMark) {
+    throw exceptions::InvalidTemplatePackException();
+  }
+
+  // Counts are 32 bit, so the expected size cannot overflow 64 bits
+  uint64_t expected_size{sizeof(TemplatePackHeader) + uint64_t{header.template_count_} * sizeof(TemplatePackEntry)
+                         + uint64_t{header.wall_count_} * 4 * sizeof(float)
+                         + uint64_t{header.neighbour_count_} * sizeof(uint32_t) + header.string_size_};
+  if (expected_size != size_) {
+    throw exceptions::InvalidTemplatePackException();
+  }
+
+  const char* cursor{data_ + sizeof(TemplatePackHeader)};
+  entries_ = reinterpret_cast<const TemplatePackEntry*>(cursor);
+  cursor += header.template_count_ * sizeof(TemplatePackEntry);
+  head_x_ = reinterpret_cast<const float*>(cursor);
+  head_y_ = head_x_ + header.wall_count_;
+  tail_x_ = head_y_ + header.wall_count_;
+  tail_y_ = tail_x_ + header.wall_count_;
+  neighbours_ = reinterpret_cast<const uint32_t*>(tail_y_ + header.wall_count_);
+  strings_ = reinterpret_cast<const char*>(neighbours_ + header.neighbour_count_);
+
+  for (size_t index = 0; index < header.template_count_; ++index) {
+    const TemplatePackEntry& entry{entries_[index]};
+    if (uint64_t{entry.id_offset_} + entry.id_length_ > header.string_size_
+        || uint64_t{entry.first_wall_} + entry.wall_count_ > header.wall_count_) {
+      throw exceptions::InvalidTemplatePackException();
+    }
+    for (size_t side = 0; side < 4; ++side) {
+      if (uint64_t{entry.first_neighbour_[side]} + entry.neighbour_count_[side] > header.neighbour_count_) {
+        throw exceptions::InvalidTemplatePackException();
+      }
+    }
+  }
+  for (size_t i = 0; i < header.neighbour_count_; ++i) {
+    if (neighbours_[i] >= header.template_count_) {
+      throw exceptions::InvalidTemplatePackException();
+    }
+  }
+}
+
+} // namespace room_explorer
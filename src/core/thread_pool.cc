@@ -0,0 +1,173 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/thread_pool.h>
+
+#include <algorithm>
+
+namespace room_explorer {
+
+// Constructors ========================================================================================================
+WorkStealingPool::WorkStealingPool(size_t thread_count)
+    : task_(nullptr), generation_(0), stopping_(false), remaining_chunks_(0) {
+  // Last queue belongs to the thread calling ParallelFor
+  for (size_t i = 0; i <= thread_count; ++i) {
+    queues_.emplace_back(new WorkQueue());
+  }
+
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers_.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+// End of Constructors =================================================================================================
+
+
+// Getters =============================================================================================================
+size_t WorkStealingPool::ThreadCount() const {
+  return workers_.size();
+}
+// End of Getters ======================================================================================================
+
+
+// Work Distribution ===================================================================================================
+void WorkStealingPool::RunJob(size_t count, size_t grain, const std::function<void(size_t, size_t)>& task) {
+  if (count == 0) {
+    return;
+  }
+  if (grain == 0) {
+    grain = 1;
+  }
+
+  size_t chunk_count{(count + grain - 1) / grain};
+  size_t queue_count{queues_.size()};
+
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    first_exception_ = nullptr;
+    remaining_chunks_ = chunk_count;
+    // Published before any chunk is queued, so whoever takes a chunk also sees its task
+    task_.store(&task, std::memory_order_release);
+
+    // Ranges of the last job are all taken. Storage is kept for this one.
+    for (const std::unique_ptr<WorkQueue>& queue : queues_) {
+      std::lock_guard<std::mutex> queue_lock(queue->mutex_);
+      queue->ranges_.clear();
+      queue->front_ = queue->back_ = 0;
+    }
+
+    // Each queue receives a contiguous block of chunks, so that neighbouring strips stay on one thread
+    //  unless stolen.
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+      size_t begin{chunk * grain};
+      size_t end{std::min(begin + grain, count)};
+
+      WorkQueue& queue = *queues_[chunk * queue_count / chunk_count];
+      std::lock_guard<std::mutex> queue_lock(queue.mutex_);
+      queue.ranges_.emplace_back(begin, end);
+      queue.back_ = queue.ranges_.size();
+    }
+
+    ++generation_;
+  }
+  work_available_.notify_all();
+
+  // Calling thread works as well, rather than idly waiting
+  RunChunks(queue_count - 1);
+
+  std::exception_ptr exception;
+  {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    work_done_.wait(lock, [this] { return remaining_chunks_ == 0; });
+    task_.store(nullptr, std::memory_order_relaxed);
+    exception = first_exception_;
+    first_exception_ = nullptr;
+  }
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+void WorkStealingPool::WorkerLoop(size_t queue_index) {
+  size_t seen_generation{0};
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(state_mutex_);
+      work_available_.wait(lock, [this, seen_generation] {
+        return stopping_ || generation_ != seen_generation;
+      });
+
+      if (stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+
+    RunChunks(queue_index);
+  }
+}
+
+void WorkStealingPool::RunChunks(size_t queue_index) {
+  std::pair<size_t, size_t> range;
+
+  while (TakeChunk(queue_index, range)) {
+    const std::function<void(size_t, size_t)>* task{task_.load(std::memory_order_acquire)};
+
+    try {
+      (*task)(range.first, range.second);
+    } catch (...) {
+      // Only the first exception is kept. Rest of the chunks still run, so the job can finish cleanly.
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      if (!first_exception_) {
+        first_exception_ = std::current_exception();
+      }
+    }
+
+    // Last chunk to finish wakes the thread waiting in ParallelFor
+    if (remaining_chunks_.fetch_sub(1) == 1) {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      work_done_.notify_all();
+    }
+  }
+}
+
+bool WorkStealingPool::TakeChunk(size_t queue_index, std::pair<size_t, size_t>& range) {
+  // Own queue is worked from the front, in index order
+  {
+    WorkQueue& own = *queues_[queue_index];
+    std::lock_guard<std::mutex> lock(own.mutex_);
+    if (own.front_ != own.back_) {
+      range = own.ranges_[own.front_++];
+      return true;
+    }
+  }
+
+  // Other queues are stolen from the back, furthest away from where their owner is working
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    WorkQueue& victim = *queues_[(queue_index + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex_);
+    if (victim.front_ != victim.back_) {
+      range = victim.ranges_[--victim.back_];
+      return true;
+    }
+  }
+
+  return false;
+}
+// End of Work Distribution ============================================================================================
+
+} // namespace room_explorer
@@ -4,6 +4,8 @@
 
 #include <core/util.h>
 
+#include <core/predicates.h>
+
 namespace room_explorer {
 
 // Numeric Utilities ===================================================================================================
@@ -61,29 +63,36 @@ bool IsUnitVector(const glm::vec2& vec) {
 }
 
 bool AreCollinear(const glm::vec2& point_a, const glm::vec2& point_b, const glm::vec2& point_c) {
-  // Collinearity is implied by 2 vectors being parallel.
+  // Points are collinear if they make no turn.
   //  This also satisfies co-point condition.
-  return AreParallel(point_a - point_b, point_c - point_b);
+  return Orientation(point_a, point_b, point_c) == 0;
 }
 
 bool AreParallel(const glm::vec2& vec_a, const glm::vec2& vec_b) {
-  // Vectors are parallel if dot of one with the normal of other is zero.
+  // Vectors are parallel if their cross product is zero.
   //  Also satisfies zero-vector condition.
-  return FloatApproximation(glm::dot(vec_a, glm::vec2(vec_b.y, -vec_b.x)), 0);
+  return CrossSign(vec_a, vec_b) == 0;
 }
 
 
 float GetRayToLineDistance(const glm::vec2& line_head, const glm::vec2& line_tail,
                            const glm::vec2& ray_pos, const glm::vec2& ray_dir) {
   // If position already is on head or tail, trivially 0 distance
-  if (FloatApproximation(line_head, ray_pos) ||
-      FloatApproximation(line_tail, ray_pos)) {
+  if (line_head == ray_pos || line_tail == ray_pos) {
     return 0;
   }
   // Single Point. Assume line passes through ray-pos.
-  if (FloatApproximation(line_head, line_tail)) {
+  if (line_head == line_tail) {
+    return 0;
+  }
+  // Position on the line. This also handles in-line case, where the ray never crosses the line.
+  if (Orientation(line_head, line_tail, ray_pos) == 0) {
     return 0;
   }
+  // Ray parallel to the line, but not on it, never reaches the line
+  if (SideOfRay(line_head, line_tail, ray_dir) == 0) {
+    return std::numeric_limits<float>::infinity();
+  }
 
   /* Utilize polar-coordinate representation of linear graph to calculate distance.
    * distance = (H - T)•<H.y - P.y, P.x - H.x> / (H - T)•<sin(θ), -cos(θ)>
@@ -104,15 +113,12 @@ float GetRayToLineDistance(const glm::vec2& line_head, const glm::vec2& line_tai
   glm::vec2 ref(line_head.y - ray_pos.y, ray_pos.x - line_head.x);
 
   float r = glm::dot(diff, ref);
-  // If (H - T)•<H.y - P.y, P.x - H.x> is zero, regardless of denominator distance will be zero
-  //  This also handles in-line case, where denominator == 0 test will fail
-  if(FloatApproximation(r, 0)) {
+  float denominator = glm::dot(diff, normal_dir);
+  // Nearly on, or nearly parallel to the line, rounded to zero
+  if (r == 0) {
     return 0;
   }
-
-  float denominator = glm::dot(diff, normal_dir);
-  if (FloatApproximation(denominator, 0)) {
-    // If demon is zero, means that ray and line are parallel, meaning distance should be infinite
+  if (denominator == 0) {
     return std::numeric_limits<float>::infinity();
   }
 
@@ -125,8 +131,7 @@ bool RayIntersectsWithSegment(const glm::vec2& segment_head, const glm::vec2& se
                               bool parallel_hit_valid) {
   // Trivial Cases
   // If position if head or tail itself, will be considered to have intersected with wall as a whole
-  if (FloatApproximation(segment_head, ray_pos) ||
-      FloatApproximation(segment_tail, ray_pos)) {
+  if (segment_head == ray_pos || segment_tail == ray_pos) {
     return true;
   }
 
@@ -134,11 +139,9 @@ bool RayIntersectsWithSegment(const glm::vec2& segment_head, const glm::vec2& se
   glm::vec2 head = segment_head - ray_pos;
   glm::vec2 tail = segment_tail - ray_pos;
 
-  // Complementary normals
-  glm::vec2 tail_c(tail.y, -tail.x);
-
-  float a = glm::dot(head, tail_c);
-  if (FloatApproximation(a, 0)) {
+  // Signs of head x tail, head x dir and tail x dir, exact
+  int a = Orientation(ray_pos, segment_head, segment_tail);
+  if (a == 0) {
     // head and tail are collinear
 
     if (glm::dot(head, tail) < 0) {
@@ -154,9 +157,7 @@ bool RayIntersectsWithSegment(const glm::vec2& segment_head, const glm::vec2& se
         return false;
       }
 
-      glm::vec2 dir_c(ray_dir.y, -ray_dir.x);
-
-      if (FloatApproximation(glm::dot(head, dir_c), 0)) {
+      if (SideOfRay(segment_head, ray_pos, ray_dir) == 0) {
         if (glm::dot(head, ray_dir) > 0) {
           // direction is 0 rad
           return true;
@@ -173,16 +174,15 @@ bool RayIntersectsWithSegment(const glm::vec2& segment_head, const glm::vec2& se
     }
 
   } else {
-    glm::vec2 dir_c(ray_dir.y, -ray_dir.x);
-    float b = glm::dot(head, dir_c);
+    int b = -SideOfRay(segment_head, ray_pos, ray_dir);
     // not collinear, either in I, II quad or III, IV quad
     if (a > 0) {
       // theta in (0, pi) rad
-      if (b > 0 || FloatApproximation(b, 0)) {
+      if (b >= 0) {
         // dir in [0, pi] rad
 
-        float c = glm::dot(tail, dir_c);
-        if (c < 0 || FloatApproximation(c, 0)) {
+        int c = -SideOfRay(segment_tail, ray_pos, ray_dir);
+        if (c <= 0) {
           // dir <= theta rad
           // dir in [0, theta] rad
           return true;
@@ -197,11 +197,11 @@ bool RayIntersectsWithSegment(const glm::vec2& segment_head, const glm::vec2& se
     } else {
       // theta in (pi, 2pi) rad
 
-      if (b < 0 || FloatApproximation(b, 0)) {
+      if (b <= 0) {
         // dir in [pi, 2pi] rad
-        float c = glm::dot(tail, dir_c);
+        int c = -SideOfRay(segment_tail, ray_pos, ray_dir);
 
-        if (c > 0 || FloatApproximation(c, 0)) {
+        if (c >= 0) {
           // dir >= theta rad
           // dir in [theta, 2pi] rad
           return true;
@@ -221,7 +221,7 @@ bool RayIntersectsWithSegment(const glm::vec2& segment_head, const glm::vec2& se
 float TextureIndexOnLineOfRay(const glm::vec2& line_head, const glm::vec2& line_tail,
                               const glm::vec2& ray_pos, const glm::vec2& ray_dir) {
   // If ray and segment are parallel, texture can be computed in a more efficient way
-  if (AreParallel(ray_dir, line_head - line_tail)) {
+  if (SideOfRay(line_head, line_tail, ray_dir) == 0) {
     // Only when also collinear when parallel, texture index will be finite
     if (AreCollinear(ray_pos, line_head, line_tail)) {
 
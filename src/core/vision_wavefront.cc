@@ -0,0 +1,143 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/vision_wavefront.h>
+
+#include <core/room_key.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace room_explorer {
+
+namespace {
+const size_t kNoQueue = SIZE_MAX;
+} // namespace
+
+const size_t VisionWavefront::kFirstQueueSlots;
+
+// Casting =============================================================================================================
+void VisionWavefront::Cast(Room* room, const glm::vec2& ray_pos, const glm::vec2* ray_dirs, size_t ray_count,
+                           float visible_range, const PortalBudget& budget, HitPackage* packages,
+                           bool point_inclusive) {
+  next_wave_count_ = 0;
+  ++wave_stamp_;
+  size_t first_queue{NextWaveQueue(room)};
+  for (size_t i = 0; i < ray_count; ++i) {
+    packages[i].Clear();
+    next_wave_[first_queue].rays_.push_back({i, ray_pos, 0});
+  }
+
+  // Every ray of a wave has passed the same number of portals
+  size_t depth{0};
+  for (; next_wave_count_ != 0; ++depth) {
+    std::swap(wave_, next_wave_);
+    wave_count_ = next_wave_count_;
+    next_wave_count_ = 0;
+    ++wave_stamp_;
+
+    // Rooms of the same template one after another, so that its walls are traced while still in cache.
+    //  Ties go by queue, so that the order is fixed without the buffer a stable sort would allocate.
+    order_.resize(wave_count_);
+    for (size_t i = 0; i < wave_count_; ++i) {
+      order_[i] = i;
+    }
+    std::sort(order_.begin(), order_.end(), [this](size_t a, size_t b) {
+      const WallArray* walls_a{wave_[a].room_->walls_};
+      const WallArray* walls_b{wave_[b].room_->walls_};
+      if (walls_a != walls_b) {
+        return std::less<const WallArray*>()(walls_a, walls_b);
+      }
+      return a < b;
+    });
+
+    for (size_t queue_index : order_) {
+      RoomQueue& queue = wave_[queue_index];
+      Room* wave_room{queue.room_};
+      // Adjacent rooms, and their queues in the next wave, are looked up once for all the rays of the room
+      size_t neighbour_queues[4]{kNoQueue, kNoQueue, kNoQueue, kNoQueue};
+
+      for (const WaveRay& ray : queue.rays_) {
+        Hit exit_hit;
+        Direction direction;
+        bool hits_portal{wave_room->TraceRoom(ray.entry_pos_, ray_dirs[ray.ray_], visible_range - ray.traveled_,
+                                              ray.traveled_, point_inclusive && depth == 0,
+                                              packages[ray.ray_], exit_hit, direction)};
+
+        glm::vec2 entry_pos;
+        if (!hits_portal || !budget.AllowsPortal(ray.ray_, depth) ||
+            !wave_room->TryGetEntryPosition(direction, exit_hit.texture_index_, entry_pos)) {
+          continue;
+        }
+
+        size_t& neighbour_queue = neighbour_queues[direction];
+        if (neighbour_queue == kNoQueue) {
+          neighbour_queue = NextWaveQueue(wave_room->GetConnectedRoom(direction));
+        }
+        next_wave_[neighbour_queue].rays_.push_back({ray.ray_, entry_pos,
+                                                     ray.traveled_ + exit_hit.hit_distance_});
+      }
+      queue.rays_.clear();
+    }
+  }
+
+  // Waves end on the queues they began with, so that the next cast finds each queue as grown as this one left it
+  if (depth % 2 == 1) {
+    std::swap(wave_, next_wave_);
+  }
+}
+
+size_t VisionWavefront::NextWaveQueue(Room* room) {
+  // Table is kept at most half full, so that probes stay short
+  if (2 * (next_wave_count_ + 1) > queue_slots_.size()) {
+    GrowQueueSlots();
+  }
+
+  size_t mask{queue_slots_.size() - 1};
+  for (size_t slot = SlotOf(room) & mask;; slot = (slot + 1) & mask) {
+    QueueSlot& queue_slot = queue_slots_[slot];
+    if (queue_slot.wave_ == wave_stamp_ && queue_slot.room_ == room) {
+      return queue_slot.queue_;
+    }
+    if (queue_slot.wave_ != wave_stamp_) {
+      queue_slot = {room, wave_stamp_, next_wave_count_};
+      break;
+    }
+  }
+
+  if (next_wave_count_ == next_wave_.size()) {
+    next_wave_.emplace_back();
+  }
+  next_wave_[next_wave_count_].room_ = room;
+  next_wave_[next_wave_count_].rays_.clear();
+  return next_wave_count_++;
+}
+
+void VisionWavefront::GrowQueueSlots() {
+  std::vector<QueueSlot> old_slots(std::max<size_t>(2 * queue_slots_.size(), kFirstQueueSlots));
+  old_slots.swap(queue_slots_);
+
+  // Only queues of the next wave are still in use, the rest are stale
+  size_t mask{queue_slots_.size() - 1};
+  for (const QueueSlot& old_slot : old_slots) {
+    if (old_slot.wave_ != wave_stamp_) {
+      continue;
+    }
+    size_t slot{SlotOf(old_slot.room_) & mask};
+    while (queue_slots_[slot].wave_ == wave_stamp_) {
+      slot = (slot + 1) & mask;
+    }
+    queue_slots_[slot] = old_slot;
+  }
+}
+
+size_t VisionWavefront::SlotOf(const Room* room) {
+  // Rooms are laid out in arrays, so the low bits of their addresses vary little. Mixing spreads them out.
+  return static_cast<size_t>(MixKey(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(room))));
+}
+// End of Casting ======================================================================================================
+
+} // namespace room_explorer
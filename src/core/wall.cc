@@ -4,8 +4,19 @@
 
 #include <core/wall.h>
 
+#include <core/predicates.h>
+
 namespace room_explorer {
 
+namespace {
+/**
+ * @return Z-component of the cross product of the two vectors, extended into 3D.
+ */
+double CrossDouble(const glm::vec2& a, const glm::vec2& b) {
+  return static_cast<double>(a.x) * b.y - static_cast<double>(a.y) * b.x;
+}
+} // namespace
+
 // Load Wall from JSON =====================================================
 void from_json(const json& json, Wall& wall) {
   wall.head_ = glm::vec2(json.at("head_x"), json.at("head_y"));
@@ -97,14 +108,76 @@ float Wall::TextureIndex(const glm::vec2& ray_pos, const glm::vec2& ray_dir) con
 
 // Hit Summaries ===================================================
 Hit Wall::GetWallHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir) const {
-  // Intersection deduced from Distance. Distance will return -1 if not intersected.
-  float wall_intersection_distance = Distance(ray_pos, ray_dir);
-  if (wall_intersection_distance == -1) {
+  glm::vec2 wall_dir{tail_ - head_};
+  return GetSegmentHit(head_, tail_, wall_dir, glm::length(wall_dir), ray_pos, ray_dir, glm::length(ray_dir));
+}
+
+Hit Wall::GetSegmentHit(const glm::vec2& head, const glm::vec2& tail, const glm::vec2& wall_dir, float wall_length,
+                        const glm::vec2& ray_pos, const glm::vec2& ray_dir, float ray_length) {
+  /* Single pass over the same rules as Distance and TextureIndex.
+   * Ray pos + t * dir meets the wall head + u * (tail - head) where, by one cross product determinant,
+   *    t = (head - pos) x (tail - head) / dir x (tail - head)
+   *    u = (head - pos) x dir / dir x (tail - head)
+   * Hit lies on the segment if u is in [0, 1], and in front of the ray if t is positive.
+   * Every such decision is taken on exact signs. Values are only rounded once the hit is certain.
+   */
+  glm::vec2 to_head{head - ray_pos};
+  glm::vec2 to_tail{tail - ray_pos};
+
+  // Ray beginning on either end-point hits the wall right there
+  if (head == ray_pos || tail == ray_pos) {
+    return {0, kWall, TextureIndexOnLineOfRay(head, tail, ray_pos, ray_dir)};
+  }
+
+  // End-points on the same side of the ray miss, which rules out most walls before anything else.
+  //  Rays aimed right at an end-point hit it. Positions between the end-points always have them on both sides.
+  int headside{SideOfRay(head, ray_pos, ray_dir)};
+  int tailside{SideOfRay(tail, ray_pos, ray_dir)};
+  if (headside == tailside && headside != 0) {
+    return {}; // Return invalid hit.
+  }
+
+  // Sign of (head - pos) x (tail - head), which is also that of (head - pos) x (tail - pos)
+  int turn{Orientation(ray_pos, head, tail)};
+
+  // Collinear, or point wall: ray position lies on the line of the wall
+  if (turn == 0) {
+    if (glm::dot(to_head, to_tail) < 0) {
+      // Ray begins between the end-points. In-line ray aimed at head has index 0.
+      bool aimed_at_head{SideOfRay(head, tail, ray_dir) == 0 && glm::dot(ray_dir, to_head) > 0};
+      return {0, kWall, aimed_at_head ? 0 : glm::length(to_head)};
+    }
+
+    // Outside the segment, ray must run along the line towards the segment. It reaches the nearer end-point first.
+    if (headside == 0 && glm::dot(to_head, ray_dir) > 0) {
+      // Running towards the segment means aiming at the head as well, so index is 0
+      return {std::min(glm::length(to_head), glm::length(to_tail)), kWall, 0};
+    }
     return {}; // Return invalid hit.
   }
 
-  float texture_index = TextureIndex(ray_pos, ray_dir);
-  return {wall_intersection_distance, kWall, texture_index};
+  int determinant_sign{SideOfRay(tail, head, ray_dir)};
+  if (determinant_sign == 0) {
+    return {}; // Parallel, but not collinear. Never meets.
+  }
+  if (turn != determinant_sign) {
+    return {}; // Line of the wall is behind the ray
+  }
+
+  // In double, so that a near-parallel determinant cannot round to zero. Rounding is clamped into the decided range.
+  double determinant{CrossDouble(ray_dir, wall_dir)};
+  float u;
+  if (headside == 0) {
+    u = 0;
+  } else if (tailside == 0) {
+    u = 1;
+  } else {
+    u = static_cast<float>(std::min(std::max(CrossDouble(to_head, ray_dir) / determinant, 0.), 1.));
+  }
+  float t{static_cast<float>(std::max(CrossDouble(to_head, wall_dir) / determinant, 0.))};
+
+  // Parameters are in units of the direction and wall vectors
+  return {t * ray_length, kWall, u * wall_length};
 }
 // End of Hit Summaries ============================================
 
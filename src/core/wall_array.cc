@@ -0,0 +1,85 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/wall_array.h>
+
+namespace room_explorer {
+
+const size_t WallArray::kPaddingWidth;
+
+// Constructors ========================================================================================================
+WallArray::WallArray(const std::vector<Wall>& walls) : walls_(walls) {
+  // Padding lanes are zero, a point wall at the origin
+  size_t padded_size{PaddedSize()};
+  for (FloatArray* array : {&head_x_, &head_y_, &tail_x_, &tail_y_, &direction_x_, &direction_y_, &length_}) {
+    array->assign(padded_size, 0);
+  }
+
+  for (size_t i = 0; i < walls_.size(); ++i) {
+    const glm::vec2& head{walls_[i].GetHead()};
+    const glm::vec2& tail{walls_[i].GetTail()};
+    // Computed as Wall::GetWallHit would, so that hits come out the same to the last bit
+    glm::vec2 direction{tail - head};
+
+    head_x_[i] = head.x;
+    head_y_[i] = head.y;
+    tail_x_[i] = tail.x;
+    tail_y_[i] = tail.y;
+    direction_x_[i] = direction.x;
+    direction_y_[i] = direction.y;
+    length_[i] = glm::length(direction);
+  }
+}
+
+WallArray::WallArray(const std::set<Wall>& walls)
+    : WallArray(std::vector<Wall>(walls.begin(), walls.end())) {}
+// End of Constructors =================================================================================================
+
+
+// Getters =============================================================================================================
+size_t WallArray::Size() const {
+  return walls_.size();
+}
+
+size_t WallArray::PaddedSize() const {
+  return (walls_.size() + kPaddingWidth - 1) / kPaddingWidth * kPaddingWidth;
+}
+
+const std::vector<Wall>& WallArray::GetWalls() const {
+  return walls_;
+}
+
+const float* WallArray::HeadX() const {
+  return head_x_.data();
+}
+const float* WallArray::HeadY() const {
+  return head_y_.data();
+}
+const float* WallArray::TailX() const {
+  return tail_x_.data();
+}
+const float* WallArray::TailY() const {
+  return tail_y_.data();
+}
+const float* WallArray::DirectionX() const {
+  return direction_x_.data();
+}
+const float* WallArray::DirectionY() const {
+  return direction_y_.data();
+}
+const float* WallArray::Length() const {
+  return length_.data();
+}
+// End of Getters ======================================================================================================
+
+
+// Geometric Functions =================================================================================================
+Hit WallArray::GetWallHit(size_t index, const glm::vec2& ray_pos, const glm::vec2& ray_dir, float ray_length) const {
+  return Wall::GetSegmentHit(glm::vec2(head_x_[index], head_y_[index]), glm::vec2(tail_x_[index], tail_y_[index]),
+                             glm::vec2(direction_x_[index], direction_y_[index]), length_[index],
+                             ray_pos, ray_dir, ray_length);
+}
+// End of Geometric Functions ==========================================================================================
+
+} // namespace room_explorer
@@ -0,0 +1,354 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/wall_batch.h>
+
+// Explicit SIMD kernels are only compiled where the compiler can target them.
+//  GCC and Clang can compile AVX2 and AVX-512 functions in a baseline build, and pick them at runtime.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ROOM_EXPLORER_X86_DISPATCH
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ROOM_EXPLORER_SSE2
+#endif
+
+#if defined(ROOM_EXPLORER_SSE2) || defined(ROOM_EXPLORER_X86_DISPATCH)
+#include <immintrin.h>
+#endif
+
+#include <cmath>
+
+namespace room_explorer {
+
+const size_t WallBatch::kBlockWidth;
+static_assert(WallBatch::kBlockWidth == WallArray::kPaddingWidth, "Blocks must not read past the padded arrays");
+
+namespace {
+
+// Rejection Margin ====================================================================================================
+// A wall is only rejected if the ray misses it by more than this margin.
+//  Margin is relative to the size of the coordinates involved, with an absolute floor for tiny coordinates,
+//  and is orders of magnitude larger than the epsilon of FloatApproximation.
+const float kRelativeSlack = 1e-4f;
+const float kAbsoluteSlack = 1e-5f;
+// End of Rejection Margin =============================================================================================
+
+
+/**
+ * Kernel testing a block of kBlockWidth walls.
+ *    Coordinate pointers point to the first wall of the block.
+ *    Returns bit mask of walls which may be hit.
+ */
+typedef uint32_t (*CandidateKernel)(const float* head_x, const float* head_y,
+                                    const float* tail_x, const float* tail_y,
+                                    float pos_x, float pos_y, float dir_x, float dir_y);
+
+/*
+ * Every kernel performs the same test on each wall, relative to the ray position P, with direction D:
+ *    h = H - P, t = T - P
+ *    Ray line misses the segment if both ends are strictly on the same side of the ray,
+ *        D x h > m and D x t > m, or D x h < -m and D x t < -m.
+ *    Ray points away from the segment if both ends are strictly behind the ray,
+ *        D . h < -m and D . t < -m.
+ *    m = (slack * (|h| + |t| + |P|) + abs_slack) * |D| + abs_slack, with |.| the cheap L1 norm.
+ *        |P| covers FloatApproximation treating positions as equal relative to their own size.
+ * Comparisons with NaN are false, so such walls are never rejected.
+ */
+
+uint32_t ScalarCandidates(const float* head_x, const float* head_y,
+                          const float* tail_x, const float* tail_y,
+                          float pos_x, float pos_y, float dir_x, float dir_y) {
+  float dir_norm{std::abs(dir_x) + std::abs(dir_y)};
+  float position_slack{kRelativeSlack * (std::abs(pos_x) + std::abs(pos_y)) + kAbsoluteSlack};
+
+  uint32_t mask{0};
+  for (size_t i = 0; i < WallBatch::kBlockWidth; ++i) {
+    float hx{head_x[i] - pos_x};
+    float hy{head_y[i] - pos_y};
+    float tx{tail_x[i] - pos_x};
+    float ty{tail_y[i] - pos_y};
+
+    float head_cross{dir_x * hy - dir_y * hx};
+    float tail_cross{dir_x * ty - dir_y * tx};
+    float head_dot{dir_x * hx + dir_y * hy};
+    float tail_dot{dir_x * tx + dir_y * ty};
+
+    float margin{(kRelativeSlack * (std::abs(hx) + std::abs(hy) + std::abs(tx) + std::abs(ty)) + position_slack)
+                 * dir_norm + kAbsoluteSlack};
+
+    // Non-short-circuit operators keep the loop free of branches
+    uint32_t reject = ((head_cross > margin) & (tail_cross > margin)) |
+                      ((head_cross < -margin) & (tail_cross < -margin)) |
+                      ((head_dot < -margin) & (tail_dot < -margin));
+
+    mask |= (reject ^ 1u) << i;
+  }
+  return mask;
+}
+
+#ifdef ROOM_EXPLORER_SSE2
+uint32_t SSE2Candidates(const float* head_x, const float* head_y,
+                        const float* tail_x, const float* tail_y,
+                        float pos_x, float pos_y, float dir_x, float dir_y) {
+  const __m128 abs_mask{_mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))};
+  const __m128 px{_mm_set1_ps(pos_x)};
+  const __m128 py{_mm_set1_ps(pos_y)};
+  const __m128 dx{_mm_set1_ps(dir_x)};
+  const __m128 dy{_mm_set1_ps(dir_y)};
+  const __m128 dir_norm{_mm_set1_ps(std::abs(dir_x) + std::abs(dir_y))};
+  const __m128 relative_slack{_mm_set1_ps(kRelativeSlack)};
+  const __m128 position_slack{_mm_set1_ps(kRelativeSlack * (std::abs(pos_x) + std::abs(pos_y)) + kAbsoluteSlack)};
+  const __m128 absolute_slack{_mm_set1_ps(kAbsoluteSlack)};
+
+  uint32_t mask{0};
+  for (size_t i = 0; i < WallBatch::kBlockWidth; i += 4) {
+    __m128 hx{_mm_sub_ps(_mm_loadu_ps(head_x + i), px)};
+    __m128 hy{_mm_sub_ps(_mm_loadu_ps(head_y + i), py)};
+    __m128 tx{_mm_sub_ps(_mm_loadu_ps(tail_x + i), px)};
+    __m128 ty{_mm_sub_ps(_mm_loadu_ps(tail_y + i), py)};
+
+    __m128 head_cross{_mm_sub_ps(_mm_mul_ps(dx, hy), _mm_mul_ps(dy, hx))};
+    __m128 tail_cross{_mm_sub_ps(_mm_mul_ps(dx, ty), _mm_mul_ps(dy, tx))};
+    __m128 head_dot{_mm_add_ps(_mm_mul_ps(dx, hx), _mm_mul_ps(dy, hy))};
+    __m128 tail_dot{_mm_add_ps(_mm_mul_ps(dx, tx), _mm_mul_ps(dy, ty))};
+
+    __m128 extent{_mm_add_ps(_mm_add_ps(_mm_and_ps(hx, abs_mask), _mm_and_ps(hy, abs_mask)),
+                             _mm_add_ps(_mm_and_ps(tx, abs_mask), _mm_and_ps(ty, abs_mask)))};
+    __m128 margin{_mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(relative_slack, extent), position_slack), dir_norm),
+                             absolute_slack)};
+    __m128 negative_margin{_mm_sub_ps(_mm_setzero_ps(), margin)};
+
+    __m128 reject{_mm_or_ps(
+        _mm_or_ps(_mm_and_ps(_mm_cmpgt_ps(head_cross, margin), _mm_cmpgt_ps(tail_cross, margin)),
+                  _mm_and_ps(_mm_cmplt_ps(head_cross, negative_margin), _mm_cmplt_ps(tail_cross, negative_margin))),
+        _mm_and_ps(_mm_cmplt_ps(head_dot, negative_margin), _mm_cmplt_ps(tail_dot, negative_margin)))};
+
+    mask |= static_cast<uint32_t>(~_mm_movemask_ps(reject) & 0xF) << i;
+  }
+  return mask;
+}
+#endif // ROOM_EXPLORER_SSE2
+
+#ifdef ROOM_EXPLORER_X86_DISPATCH
+__attribute__((target("avx2")))
+uint32_t AVX2Candidates(const float* head_x, const float* head_y,
+                        const float* tail_x, const float* tail_y,
+                        float pos_x, float pos_y, float dir_x, float dir_y) {
+  const __m256 abs_mask{_mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))};
+  const __m256 px{_mm256_set1_ps(pos_x)};
+  const __m256 py{_mm256_set1_ps(pos_y)};
+  const __m256 dx{_mm256_set1_ps(dir_x)};
+  const __m256 dy{_mm256_set1_ps(dir_y)};
+  const __m256 dir_norm{_mm256_set1_ps(std::abs(dir_x) + std::abs(dir_y))};
+  const __m256 relative_slack{_mm256_set1_ps(kRelativeSlack)};
+  const __m256 position_slack{_mm256_set1_ps(kRelativeSlack * (std::abs(pos_x) + std::abs(pos_y)) + kAbsoluteSlack)};
+  const __m256 absolute_slack{_mm256_set1_ps(kAbsoluteSlack)};
+
+  uint32_t mask{0};
+  for (size_t i = 0; i < WallBatch::kBlockWidth; i += 8) {
+    __m256 hx{_mm256_sub_ps(_mm256_loadu_ps(head_x + i), px)};
+    __m256 hy{_mm256_sub_ps(_mm256_loadu_ps(head_y + i), py)};
+    __m256 tx{_mm256_sub_ps(_mm256_loadu_ps(tail_x + i), px)};
+    __m256 ty{_mm256_sub_ps(_mm256_loadu_ps(tail_y + i), py)};
+
+    __m256 head_cross{_mm256_sub_ps(_mm256_mul_ps(dx, hy), _mm256_mul_ps(dy, hx))};
+    __m256 tail_cross{_mm256_sub_ps(_mm256_mul_ps(dx, ty), _mm256_mul_ps(dy, tx))};
+    __m256 head_dot{_mm256_add_ps(_mm256_mul_ps(dx, hx), _mm256_mul_ps(dy, hy))};
+    __m256 tail_dot{_mm256_add_ps(_mm256_mul_ps(dx, tx), _mm256_mul_ps(dy, ty))};
+
+    __m256 extent{_mm256_add_ps(_mm256_add_ps(_mm256_and_ps(hx, abs_mask), _mm256_and_ps(hy, abs_mask)),
+                                _mm256_add_ps(_mm256_and_ps(tx, abs_mask), _mm256_and_ps(ty, abs_mask)))};
+    __m256 margin{_mm256_add_ps(
+        _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(relative_slack, extent), position_slack), dir_norm),
+        absolute_slack)};
+    __m256 negative_margin{_mm256_sub_ps(_mm256_setzero_ps(), margin)};
+
+    __m256 reject{_mm256_or_ps(
+        _mm256_or_ps(_mm256_and_ps(_mm256_cmp_ps(head_cross, margin, _CMP_GT_OQ),
+                                   _mm256_cmp_ps(tail_cross, margin, _CMP_GT_OQ)),
+                     _mm256_and_ps(_mm256_cmp_ps(head_cross, negative_margin, _CMP_LT_OQ),
+                                   _mm256_cmp_ps(tail_cross, negative_margin, _CMP_LT_OQ))),
+        _mm256_and_ps(_mm256_cmp_ps(head_dot, negative_margin, _CMP_LT_OQ),
+                      _mm256_cmp_ps(tail_dot, negative_margin, _CMP_LT_OQ)))};
+
+    mask |= static_cast<uint32_t>(~_mm256_movemask_ps(reject) & 0xFF) << i;
+  }
+  return mask;
+}
+
+__attribute__((target("avx512f")))
+uint32_t AVX512Candidates(const float* head_x, const float* head_y,
+                          const float* tail_x, const float* tail_y,
+                          float pos_x, float pos_y, float dir_x, float dir_y) {
+  const __m512 px{_mm512_set1_ps(pos_x)};
+  const __m512 py{_mm512_set1_ps(pos_y)};
+  const __m512 dx{_mm512_set1_ps(dir_x)};
+  const __m512 dy{_mm512_set1_ps(dir_y)};
+  const __m512 dir_norm{_mm512_set1_ps(std::abs(dir_x) + std::abs(dir_y))};
+  const __m512 relative_slack{_mm512_set1_ps(kRelativeSlack)};
+  const __m512 position_slack{_mm512_set1_ps(kRelativeSlack * (std::abs(pos_x) + std::abs(pos_y)) + kAbsoluteSlack)};
+  const __m512 absolute_slack{_mm512_set1_ps(kAbsoluteSlack)};
+
+  // Whole block in a single register
+  __m512 hx{_mm512_sub_ps(_mm512_loadu_ps(head_x), px)};
+  __m512 hy{_mm512_sub_ps(_mm512_loadu_ps(head_y), py)};
+  __m512 tx{_mm512_sub_ps(_mm512_loadu_ps(tail_x), px)};
+  __m512 ty{_mm512_sub_ps(_mm512_loadu_ps(tail_y), py)};
+
+  __m512 head_cross{_mm512_sub_ps(_mm512_mul_ps(dx, hy), _mm512_mul_ps(dy, hx))};
+  __m512 tail_cross{_mm512_sub_ps(_mm512_mul_ps(dx, ty), _mm512_mul_ps(dy, tx))};
+  __m512 head_dot{_mm512_add_ps(_mm512_mul_ps(dx, hx), _mm512_mul_ps(dy, hy))};
+  __m512 tail_dot{_mm512_add_ps(_mm512_mul_ps(dx, tx), _mm512_mul_ps(dy, ty))};
+
+  __m512 extent{_mm512_add_ps(_mm512_add_ps(_mm512_abs_ps(hx), _mm512_abs_ps(hy)),
+                              _mm512_add_ps(_mm512_abs_ps(tx), _mm512_abs_ps(ty)))};
+  __m512 margin{_mm512_add_ps(
+      _mm512_mul_ps(_mm512_add_ps(_mm512_mul_ps(relative_slack, extent), position_slack), dir_norm),
+      absolute_slack)};
+  __m512 negative_margin{_mm512_sub_ps(_mm512_setzero_ps(), margin)};
+
+  __mmask16 reject{static_cast<__mmask16>(
+      (_mm512_cmp_ps_mask(head_cross, margin, _CMP_GT_OQ) & _mm512_cmp_ps_mask(tail_cross, margin, _CMP_GT_OQ)) |
+      (_mm512_cmp_ps_mask(head_cross, negative_margin, _CMP_LT_OQ) &
+       _mm512_cmp_ps_mask(tail_cross, negative_margin, _CMP_LT_OQ)) |
+      (_mm512_cmp_ps_mask(head_dot, negative_margin, _CMP_LT_OQ) &
+       _mm512_cmp_ps_mask(tail_dot, negative_margin, _CMP_LT_OQ)))};
+
+  return static_cast<uint32_t>(~reject & 0xFFFF);
+}
+#endif // ROOM_EXPLORER_X86_DISPATCH
+
+
+// Kernel Dispatch =====================================================================================================
+CandidateKernel KernelFunction(WallKernel kernel) {
+  switch (kernel) {
+#ifdef ROOM_EXPLORER_SSE2
+    case kSSE2Kernel:
+      return SSE2Candidates;
+#endif
+#ifdef ROOM_EXPLORER_X86_DISPATCH
+    case kAVX2Kernel:
+      return AVX2Candidates;
+    case kAVX512Kernel:
+      return AVX512Candidates;
+#endif
+    default:
+      return ScalarCandidates;
+  }
+}
+
+WallKernel BestSupportedKernel() {
+  if (WallBatch::KernelSupported(kAVX512Kernel)) {
+    return kAVX512Kernel;
+  }
+  if (WallBatch::KernelSupported(kAVX2Kernel)) {
+    return kAVX2Kernel;
+  }
+  if (WallBatch::KernelSupported(kSSE2Kernel)) {
+    return kSSE2Kernel;
+  }
+  return kScalarKernel;
+}
+
+// Chosen once on start-up
+WallKernel active_kernel = BestSupportedKernel();
+CandidateKernel active_kernel_function = KernelFunction(active_kernel);
+// End of Kernel Dispatch ==============================================================================================
+
+} // namespace
+
+
+// Constructors ========================================================================================================
+WallBatch::WallBatch(const std::set<Wall>& walls)
+    : WallBatch(std::vector<Wall>(walls.begin(), walls.end())) {}
+
+WallBatch::WallBatch(const std::vector<Wall>& walls)
+    : walls_(walls) {}
+// End of Constructors =================================================================================================
+
+
+// Getters =============================================================================================================
+size_t WallBatch::WallCount() const {
+  return walls_.Size();
+}
+
+const std::vector<Wall>& WallBatch::GetWalls() const {
+  return walls_.GetWalls();
+}
+// End of Getters ======================================================================================================
+
+
+// Batch Geometry ======================================================================================================
+uint32_t WallBatch::CandidateMask(size_t block_begin, const glm::vec2& ray_pos, const glm::vec2& ray_dir) const {
+  uint32_t mask{active_kernel_function(walls_.HeadX() + block_begin, walls_.HeadY() + block_begin,
+                                       walls_.TailX() + block_begin, walls_.TailY() + block_begin,
+                                       ray_pos.x, ray_pos.y, ray_dir.x, ray_dir.y)};
+
+  // Lanes past the last wall are padding
+  size_t lane_count{walls_.Size() - block_begin};
+  if (lane_count < kBlockWidth) {
+    mask &= (1u << lane_count) - 1;
+  }
+  return mask;
+}
+
+void WallBatch::AddWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                            HitPackage& package) const {
+  float ray_length{glm::length(ray_dir)};
+  for (size_t block = 0; block < walls_.Size(); block += kBlockWidth) {
+    uint32_t mask{CandidateMask(block, ray_pos, ray_dir)};
+
+    // Only the remaining candidates go through the exact scalar geometry
+    for (size_t i = block; mask != 0; ++i, mask >>= 1) {
+      if (mask & 1u) {
+        Hit hit{walls_.GetWallHit(i, ray_pos, ray_dir, ray_length)};
+        if (!hit.IsNoHit() && hit.WithinDistance(visible_range)) {
+          package.AddHit(hit);
+        }
+      }
+    }
+  }
+}
+// End of Batch Geometry ===============================================================================================
+
+
+// Kernel Selection ====================================================================================================
+WallKernel WallBatch::GetActiveKernel() {
+  return active_kernel;
+}
+
+bool WallBatch::KernelSupported(WallKernel kernel) {
+  switch (kernel) {
+    case kScalarKernel:
+      return true;
+#ifdef ROOM_EXPLORER_SSE2
+    case kSSE2Kernel:
+      return true;
+#endif
+#ifdef ROOM_EXPLORER_X86_DISPATCH
+    case kAVX2Kernel:
+      // May run before other static constructors, where GCC requires explicit initialization
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+    case kAVX512Kernel:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return false;
+  }
+}
+
+bool WallBatch::SetActiveKernel(WallKernel kernel) {
+  if (!KernelSupported(kernel)) {
+    return false;
+  }
+  active_kernel = kernel;
+  active_kernel_function = KernelFunction(kernel);
+  return true;
+}
+// End of Kernel Selection =============================================================================================
+
+} // namespace room_explorer
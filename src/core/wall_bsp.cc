@@ -0,0 +1,369 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/wall_bsp.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace room_explorer {
+
+const uint32_t WallBsp::kNoNode;
+const size_t WallBsp::kSplitterCandidates;
+
+namespace {
+
+// Tree Margins ========================================================================================================
+// Sides of a line are widened by this margin, relative to the size of the walls and the room.
+//  Orders of magnitude larger than any rounding of the traversal, and than the epsilon of FloatApproximation.
+const float kRelativeMargin = 1e-3f;
+const float kAbsoluteMargin = 1e-4f;
+
+// Visited bit sets of a single ray live on the stack up to this many words
+const size_t kInlineWords = 8;
+// End of Tree Margins =================================================================================================
+
+} // namespace
+
+
+struct WallBsp::Traversal {
+  glm::vec2 pos_;
+  glm::vec2 dir_;
+  float dir_length_;
+  float visible_range_;
+
+  uint64_t* visited_; // Bit set of walls already tested
+
+  HitPackage* package_; // Every hit goes into the package. Null when only the nearest hit is searched for.
+  Hit nearest_;
+  uint32_t nearest_wall_;
+};
+
+
+// Constructors ========================================================================================================
+WallBsp::WallBsp()
+    : fragment_count_(0), walls_inside_room_(true), room_size_(0, 0), margin_(0) {}
+
+WallBsp::WallBsp(const std::set<Wall>& walls, const RoomBounds& bounds)
+    : WallBsp(std::vector<Wall>(walls.begin(), walls.end()), bounds) {}
+
+WallBsp::WallBsp(const std::vector<Wall>& walls, const RoomBounds& bounds)
+    : walls_(walls), fragment_count_(0), walls_inside_room_(true), room_size_(bounds.width_, bounds.height_) {
+  glm::vec2 extent_min{0, 0};
+  glm::vec2 extent_max{room_size_};
+  for (const Wall& wall : walls) {
+    for (const glm::vec2& point : {wall.GetHead(), wall.GetTail()}) {
+      if (point.x < 0 || point.y < 0 || point.x > room_size_.x || point.y > room_size_.y) {
+        walls_inside_room_ = false;
+      }
+      extent_min = glm::min(extent_min, point);
+      extent_max = glm::max(extent_max, point);
+    }
+  }
+  glm::vec2 extent{extent_max - extent_min};
+  margin_ = kRelativeMargin * std::max(extent.x, extent.y) + kAbsoluteMargin;
+
+  std::vector<Fragment> fragments;
+  for (size_t i = 0; i < walls.size(); ++i) {
+    fragments.push_back({walls[i].GetHead(), walls[i].GetTail(), static_cast<uint32_t>(i)});
+  }
+  Build(fragments);
+  fragment_count_ = node_walls_.size();
+}
+// End of Constructors =================================================================================================
+
+
+// Getters =============================================================================================================
+size_t WallBsp::WallCount() const {
+  return walls_.Size();
+}
+
+size_t WallBsp::NodeCount() const {
+  return nodes_.size();
+}
+
+size_t WallBsp::FragmentCount() const {
+  return fragment_count_;
+}
+
+const std::vector<Wall>& WallBsp::GetWalls() const {
+  return walls_.GetWalls();
+}
+// End of Getters ======================================================================================================
+
+
+// Tree Building =======================================================================================================
+uint32_t WallBsp::Build(std::vector<Fragment>& fragments) {
+  if (fragments.empty()) {
+    return kNoNode;
+  }
+
+  // Fragments are classified with half the margin, so that traversal, widened by the full margin, never misses them
+  float tolerance{margin_ / 2};
+
+  // Side of both ends of a fragment, as signed distances from the line
+  auto sides = [](const Fragment& fragment, const glm::vec2& point, const glm::vec2& normal) {
+    return std::make_pair(glm::dot(normal, fragment.head_ - point), glm::dot(normal, fragment.tail_ - point));
+  };
+
+  // Of a few candidates, the splitter cutting the fewest fragments and balancing both sides is picked
+  std::vector<size_t> candidates;
+  for (size_t i = 0; i < fragments.size(); ++i) {
+    if (glm::length(fragments[i].tail_ - fragments[i].head_) > margin_) {
+      candidates.push_back(i);
+    }
+  }
+
+  Node node{{0, 0}, {0, 0}, kNoNode, kNoNode, 0, 0};
+  std::vector<Fragment> front;
+  std::vector<Fragment> back;
+  std::vector<uint32_t> on_line;
+
+  if (candidates.empty()) {
+    // Only points and tiny walls left. A leaf holds them all.
+    for (const Fragment& fragment : fragments) {
+      on_line.push_back(fragment.wall_);
+    }
+  } else {
+    size_t stride{std::max(candidates.size() / kSplitterCandidates, size_t{1})};
+    size_t best_score{SIZE_MAX};
+    for (size_t c = 0; c < candidates.size(); c += stride) {
+      const Fragment& splitter{fragments[candidates[c]]};
+      glm::vec2 along{glm::normalize(splitter.tail_ - splitter.head_)};
+      glm::vec2 normal{-along.y, along.x};
+
+      size_t front_count{0}, back_count{0}, split_count{0};
+      for (const Fragment& fragment : fragments) {
+        auto side = sides(fragment, splitter.head_, normal);
+        bool in_front{side.first >= -tolerance && side.second >= -tolerance};
+        bool in_back{side.first <= tolerance && side.second <= tolerance};
+        if (in_front && in_back) {
+          continue;
+        }
+        front_count += in_front;
+        back_count += in_back;
+        split_count += !in_front && !in_back;
+      }
+
+      size_t imbalance{front_count > back_count ? front_count - back_count : back_count - front_count};
+      size_t score{8 * split_count + imbalance};
+      if (score < best_score) {
+        best_score = score;
+        node.point_ = splitter.head_;
+        node.normal_ = normal;
+      }
+    }
+
+    for (const Fragment& fragment : fragments) {
+      auto side = sides(fragment, node.point_, node.normal_);
+      bool in_front{side.first >= -tolerance && side.second >= -tolerance};
+      bool in_back{side.first <= tolerance && side.second <= tolerance};
+
+      if (in_front && in_back) {
+        on_line.push_back(fragment.wall_);
+      } else if (in_front) {
+        front.push_back(fragment);
+      } else if (in_back) {
+        back.push_back(fragment);
+      } else {
+        // Straddles the line. Both pieces keep the wall they came from.
+        glm::vec2 cut{fragment.head_ + (fragment.tail_ - fragment.head_) * (side.first / (side.first - side.second))};
+        Fragment head_piece{fragment.head_, cut, fragment.wall_};
+        Fragment tail_piece{cut, fragment.tail_, fragment.wall_};
+        (side.first > 0 ? front : back).push_back(head_piece);
+        (side.second > 0 ? front : back).push_back(tail_piece);
+      }
+    }
+  }
+
+  // Walls of the node are tested in set order
+  std::sort(on_line.begin(), on_line.end());
+  on_line.erase(std::unique(on_line.begin(), on_line.end()), on_line.end());
+  node.walls_begin_ = static_cast<uint32_t>(node_walls_.size());
+  node_walls_.insert(node_walls_.end(), on_line.begin(), on_line.end());
+  node.walls_end_ = static_cast<uint32_t>(node_walls_.size());
+
+  uint32_t index{static_cast<uint32_t>(nodes_.size())};
+  nodes_.push_back(node);
+
+  // Nodes may move as children are added, so they are only referred to by index
+  fragments.clear();
+  uint32_t front_index{Build(front)};
+  uint32_t back_index{Build(back)};
+  nodes_[index].front_ = front_index;
+  nodes_[index].back_ = back_index;
+  return index;
+}
+// End of Tree Building ================================================================================================
+
+
+// Tree Geometry =======================================================================================================
+void WallBsp::AddWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                          float exit_distance, HitPackage& package) const {
+  if (nodes_.empty()) {
+    return;
+  }
+
+  size_t word_count{(walls_.Size() + 63) / 64};
+  uint64_t inline_visited[kInlineWords];
+  std::vector<uint64_t> heap_visited;
+  uint64_t* visited{inline_visited};
+  if (word_count > kInlineWords) {
+    heap_visited.resize(word_count);
+    visited = heap_visited.data();
+  }
+  std::fill(visited, visited + word_count, 0);
+
+  Traversal traversal{ray_pos, ray_dir, glm::length(ray_dir), visible_range, visited, &package, Hit(), 0};
+
+  bool walkable{traversal.dir_length_ > 0 && std::isfinite(traversal.dir_length_) &&
+                std::isfinite(ray_pos.x) && std::isfinite(ray_pos.y)};
+  if (!walkable) {
+    // Degenerate rays test every wall, like a plain loop would
+    for (const Wall& wall : walls_.GetWalls()) {
+      Hit hit{wall.GetWallHit(ray_pos, ray_dir)};
+      if (!hit.IsNoHit() && hit.WithinDistance(visible_range)) {
+        package.AddHit(hit);
+      }
+    }
+    return;
+  }
+
+  float walk_range{visible_range};
+  // From within the room, every wall is hit before the ray leaves the room
+  bool starts_in_room{ray_pos.x >= -margin_ && ray_pos.y >= -margin_ &&
+                      ray_pos.x <= room_size_.x + margin_ && ray_pos.y <= room_size_.y + margin_};
+  if (walls_inside_room_ && starts_in_room) {
+    walk_range = std::min(walk_range, exit_distance);
+  }
+
+  Visit(0, 0, (walk_range + margin_) / traversal.dir_length_, traversal);
+}
+
+Hit WallBsp::NearestWallHit(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range) const {
+  if (nodes_.empty()) {
+    return Hit();
+  }
+
+  size_t word_count{(walls_.Size() + 63) / 64};
+  uint64_t inline_visited[kInlineWords];
+  std::vector<uint64_t> heap_visited;
+  uint64_t* visited{inline_visited};
+  if (word_count > kInlineWords) {
+    heap_visited.resize(word_count);
+    visited = heap_visited.data();
+  }
+  std::fill(visited, visited + word_count, 0);
+
+  Traversal traversal{ray_pos, ray_dir, glm::length(ray_dir), visible_range, visited, nullptr, Hit(), 0};
+
+  bool walkable{traversal.dir_length_ > 0 && std::isfinite(traversal.dir_length_) &&
+                std::isfinite(ray_pos.x) && std::isfinite(ray_pos.y)};
+  if (walkable) {
+    Visit(0, 0, (visible_range + margin_) / traversal.dir_length_, traversal);
+  } else {
+    for (const Wall& wall : walls_.GetWalls()) {
+      Hit hit{wall.GetWallHit(ray_pos, ray_dir)};
+      if (!hit.IsNoHit() && hit.WithinDistance(visible_range) &&
+          (traversal.nearest_.IsNoHit() || hit.hit_distance_ < traversal.nearest_.hit_distance_)) {
+        traversal.nearest_ = hit;
+      }
+    }
+  }
+  return traversal.nearest_;
+}
+
+bool WallBsp::Visit(uint32_t node_index, float t_min, float t_max, Traversal& traversal) const {
+  if (node_index == kNoNode || t_min > t_max) {
+    return true;
+  }
+
+  // Nothing in this part of the ray can be nearer than the nearest hit so far
+  if (traversal.package_ == nullptr && !traversal.nearest_.IsNoHit() &&
+      traversal.nearest_.hit_distance_ < t_min * traversal.dir_length_ - margin_) {
+    return true;
+  }
+
+  const Node& node{nodes_[node_index]};
+  if (node.normal_.x == 0 && node.normal_.y == 0) {
+    return VisitWalls(node, traversal);
+  }
+
+  // Signed distance from the line is side + rate * t along the ray
+  float side{glm::dot(node.normal_, traversal.pos_ - node.point_)};
+  float rate{glm::dot(node.normal_, traversal.dir_)};
+
+  // Parts of [t_min, t_max] in front of the line, behind it, and on it, all widened by the margin
+  float front_min{t_min}, front_max{t_max};
+  float back_min{t_min}, back_max{t_max};
+  float line_min{t_min}, line_max{t_max};
+  if (rate == 0) {
+    if (side < -margin_) {
+      front_max = -1;
+    }
+    if (side > margin_) {
+      back_max = -1;
+    }
+    if (std::abs(side) > margin_) {
+      line_max = -1;
+    }
+  } else {
+    float enter_front{(-margin_ - side) / rate};
+    float leave_back{(margin_ - side) / rate};
+    if (rate > 0) {
+      front_min = std::max(front_min, enter_front);
+      back_max = std::min(back_max, leave_back);
+      line_min = std::max(line_min, enter_front);
+      line_max = std::min(line_max, leave_back);
+    } else {
+      front_max = std::min(front_max, enter_front);
+      back_min = std::max(back_min, leave_back);
+      line_min = std::max(line_min, leave_back);
+      line_max = std::min(line_max, enter_front);
+    }
+  }
+
+  // Side the ray is on at t_min is nearer
+  bool front_first{side + rate * t_min >= 0};
+  uint32_t near_index{front_first ? node.front_ : node.back_};
+  uint32_t far_index{front_first ? node.back_ : node.front_};
+
+  if (!Visit(near_index, front_first ? front_min : back_min, front_first ? front_max : back_max, traversal)) {
+    return false;
+  }
+  if (line_min <= line_max && !VisitWalls(node, traversal)) {
+    return false;
+  }
+  return Visit(far_index, front_first ? back_min : front_min, front_first ? back_max : front_max, traversal);
+}
+
+bool WallBsp::VisitWalls(const Node& node, Traversal& traversal) const {
+  for (uint32_t i = node.walls_begin_; i < node.walls_end_; ++i) {
+    uint32_t wall{node_walls_[i]};
+    uint64_t bit{uint64_t{1} << (wall % 64)};
+    if (traversal.visited_[wall / 64] & bit) {
+      continue;
+    }
+    traversal.visited_[wall / 64] |= bit;
+
+    Hit hit{walls_.GetWallHit(wall, traversal.pos_, traversal.dir_, traversal.dir_length_)};
+    if (hit.IsNoHit() || !hit.WithinDistance(traversal.visible_range_)) {
+      continue;
+    }
+
+    if (traversal.package_ != nullptr) {
+      traversal.package_->AddHit(hit);
+    } else if (traversal.nearest_.IsNoHit() || hit.hit_distance_ < traversal.nearest_.hit_distance_ ||
+               (hit.hit_distance_ == traversal.nearest_.hit_distance_ && wall < traversal.nearest_wall_)) {
+      // Of walls at the same distance, the first in set order is kept, as in a package
+      traversal.nearest_ = hit;
+      traversal.nearest_wall_ = wall;
+    }
+  }
+  return true;
+}
+// End of Tree Geometry ================================================================================================
+
+} // namespace room_explorer
@@ -0,0 +1,176 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/wall_cleanup.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace room_explorer {
+
+namespace {
+/**
+ * Whether the wall runs along a room edge at given coordinate, both end points within tolerance of it.
+ */
+bool AlongEdge(float head, float tail, float edge, double tolerance) {
+  return std::abs(static_cast<double>(head) - edge) <= tolerance &&
+         std::abs(static_cast<double>(tail) - edge) <= tolerance;
+}
+
+/**
+ * Whether a wall spanning from a to b along an edge stays clear of the door on it.
+ */
+bool ClearOfDoor(float a, float b, float door_begin, float door_end) {
+  return std::max(a, b) <= door_begin || std::min(a, b) >= door_end;
+}
+
+/**
+ * Whether the room edge hides the wall. Edges are opaque room walls everywhere but at their doors.
+ */
+bool HiddenByEdge(const Wall& wall, const RoomBounds& bounds, double tolerance) {
+  const glm::vec2& head{wall.GetHead()};
+  const glm::vec2& tail{wall.GetTail()};
+
+  // West and east edges hold the east-west doors, south and north edges the north-south doors
+  if (AlongEdge(head.x, tail.x, 0, tolerance) || AlongEdge(head.x, tail.x, bounds.width_, tolerance)) {
+    return ClearOfDoor(head.y, tail.y, bounds.ew_door_begin_, bounds.ew_door_end_);
+  }
+  if (AlongEdge(head.y, tail.y, 0, tolerance) || AlongEdge(head.y, tail.y, bounds.height_, tolerance)) {
+    return ClearOfDoor(head.x, tail.x, bounds.ns_door_begin_, bounds.ns_door_end_);
+  }
+  return false;
+}
+
+double Length(const Wall& wall) {
+  double x{static_cast<double>(wall.GetTail().x) - wall.GetHead().x};
+  double y{static_cast<double>(wall.GetTail().y) - wall.GetHead().y};
+  return std::sqrt(x * x + y * y);
+}
+
+/**
+ * Orders walls by their end points, so that the cleanup does not depend on the order walls are given in.
+ */
+bool EndPointsBefore(const Wall& a, const Wall& b) {
+  const glm::vec2& a_head{a.GetHead()};
+  const glm::vec2& b_head{b.GetHead()};
+  if (a_head.x != b_head.x) {
+    return a_head.x < b_head.x;
+  }
+  if (a_head.y != b_head.y) {
+    return a_head.y < b_head.y;
+  }
+  if (a.GetTail().x != b.GetTail().x) {
+    return a.GetTail().x < b.GetTail().x;
+  }
+  return a.GetTail().y < b.GetTail().y;
+}
+
+/**
+ * Joins other onto the wall, should other lie on the line of the wall and touch or overlap it.
+ *    End points of the joined wall are end points of the two walls, so no coordinate is rounded.
+ * @param covered Set to whether either wall already spans the other, in which case the wall becomes the spanning one.
+ * @return Whether other was joined.
+ */
+bool TryJoin(Wall& wall, const Wall& other, double tolerance, bool& covered) {
+  const glm::vec2& head{wall.GetHead()};
+  double length{Length(wall)};
+  double unit_x{(static_cast<double>(wall.GetTail().x) - head.x) / length};
+  double unit_y{(static_cast<double>(wall.GetTail().y) - head.y) / length};
+
+  // Position of each end point of other along the wall from its head, and away from the line of the wall
+  double along[2], away[2];
+  const glm::vec2 other_points[2] = {other.GetHead(), other.GetTail()};
+  for (size_t i = 0; i < 2; ++i) {
+    double x{static_cast<double>(other_points[i].x) - head.x};
+    double y{static_cast<double>(other_points[i].y) - head.y};
+    along[i] = x * unit_x + y * unit_y;
+    away[i] = x * unit_y - y * unit_x;
+  }
+  if (std::abs(away[0]) > tolerance || std::abs(away[1]) > tolerance) {
+    return false;
+  }
+
+  size_t low{along[0] <= along[1] ? 0u : 1u};
+  size_t high{1 - low};
+  if (along[low] > length + tolerance || along[high] < -tolerance) {
+    return false;
+  }
+
+  bool other_within{along[low] >= -tolerance && along[high] <= length + tolerance};
+  bool wall_within{along[low] <= tolerance && along[high] >= length - tolerance};
+  covered = other_within || wall_within;
+  if (other_within) {
+    return true;
+  }
+  if (wall_within) {
+    wall = other;
+    return true;
+  }
+
+  // Joined wall runs the way the longer wall does
+  glm::vec2 low_point{along[low] < 0 ? other_points[low] : head};
+  glm::vec2 high_point{along[high] > length ? other_points[high] : wall.GetTail()};
+  bool other_reversed{along[0] > along[1]};
+  if (Length(other) > length && other_reversed) {
+    wall = Wall(high_point, low_point);
+  } else {
+    wall = Wall(low_point, high_point);
+  }
+  return true;
+}
+} // namespace
+
+// Wall Cleanup Report =================================================================================================
+size_t WallCleanupReport::OutputCount() const {
+  return input_count_ - degenerate_count_ - boundary_count_ - duplicate_count_ - merged_count_;
+}
+
+WallCleanupReport& WallCleanupReport::operator+=(const WallCleanupReport& report) {
+  input_count_ += report.input_count_;
+  degenerate_count_ += report.degenerate_count_;
+  boundary_count_ += report.boundary_count_;
+  duplicate_count_ += report.duplicate_count_;
+  merged_count_ += report.merged_count_;
+  return *this;
+}
+// End of Wall Cleanup Report ==========================================================================================
+
+
+// Wall Cleanup ========================================================================================================
+std::vector<Wall> CleanUpWalls(const std::vector<Wall>& walls, const RoomBounds& bounds, WallCleanupReport& report) {
+  report = WallCleanupReport();
+  report.input_count_ = walls.size();
+  double tolerance{kWallCleanupTolerance * std::max(std::abs(bounds.width_), std::abs(bounds.height_))};
+
+  std::vector<Wall> kept;
+  for (const Wall& wall : walls) {
+    if (Length(wall) <= tolerance) {
+      ++report.degenerate_count_;
+    } else if (HiddenByEdge(wall, bounds, tolerance)) {
+      ++report.boundary_count_;
+    } else {
+      kept.push_back(wall);
+    }
+  }
+  std::sort(kept.begin(), kept.end(), EndPointsBefore);
+
+  // Each wall takes in every later wall it can join. A joined wall may reach walls it missed, so those are looked at again.
+  for (size_t i = 0; i < kept.size(); ++i) {
+    size_t j{i + 1};
+    while (j < kept.size()) {
+      bool covered;
+      if (TryJoin(kept[i], kept[j], tolerance, covered)) {
+        ++(covered ? report.duplicate_count_ : report.merged_count_);
+        kept.erase(kept.begin() + j);
+        j = i + 1;
+      } else {
+        ++j;
+      }
+    }
+  }
+  return kept;
+}
+// End of Wall Cleanup =================================================================================================
+
+} // namespace room_explorer
@@ -0,0 +1,329 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/wall_grid.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace room_explorer {
+
+const size_t WallGrid::kMaxCellsPerSide;
+const size_t WallGrid::kMinGridWalls;
+const size_t WallGrid::kWallsPerCell;
+
+namespace {
+
+// Grid Margins ========================================================================================================
+// Walls are registered in every cell within this margin, relative to the size of the grid.
+//  Orders of magnitude larger than any rounding of the cell walk, and than the epsilon of FloatApproximation.
+const float kRelativeMargin = 1e-3f;
+const float kAbsoluteMargin = 1e-4f;
+// End of Grid Margins =================================================================================================
+
+
+// Scratch Space =======================================================================================================
+// Block bit sets and candidate walls of a single ray live on the stack up to these sizes
+const size_t kInlineWords = 8;
+const size_t kInlineCandidates = 64;
+// End of Scratch Space ================================================================================================
+
+
+/**
+ * Checks if the wall may pass through the box.
+ *    Box must already be grown by the margin.
+ */
+bool WallTouchesBox(const Wall& wall, const glm::vec2& box_min, const glm::vec2& box_max) {
+  const glm::vec2& head{wall.GetHead()};
+  const glm::vec2& tail{wall.GetTail()};
+
+  // Bounding boxes must overlap
+  if (std::max(head.x, tail.x) < box_min.x || std::min(head.x, tail.x) > box_max.x ||
+      std::max(head.y, tail.y) < box_min.y || std::min(head.y, tail.y) > box_max.y) {
+    return false;
+  }
+
+  // Line of the wall must not pass fully beside the box
+  glm::vec2 wall_dir{tail - head};
+  glm::vec2 corners[4]{box_min, {box_max.x, box_min.y}, box_max, {box_min.x, box_max.y}};
+  bool any_left{false};
+  bool any_right{false};
+  for (const glm::vec2& corner : corners) {
+    glm::vec2 to_corner{corner - head};
+    float side{wall_dir.x * to_corner.y - wall_dir.y * to_corner.x};
+    any_left |= side >= 0;
+    any_right |= side <= 0;
+  }
+  return any_left && any_right;
+}
+
+} // namespace
+
+
+// Constructors ========================================================================================================
+WallGrid::WallGrid()
+    : walls_inside_room_(true), room_size_(0, 0), origin_(0, 0), cell_size_(1, 1), cells_x_(1), cells_y_(1),
+      margin_(0), cell_offsets_(2, 0) {}
+
+WallGrid::WallGrid(const std::set<Wall>& walls, const RoomBounds& bounds)
+    : WallGrid(std::vector<Wall>(walls.begin(), walls.end()), bounds) {}
+
+WallGrid::WallGrid(const std::vector<Wall>& walls, const RoomBounds& bounds)
+    : walls_(walls), walls_inside_room_(true), room_size_(bounds.width_, bounds.height_) {
+  // Grid spans the room, and any wall reaching outside of it
+  glm::vec2 grid_min{0, 0};
+  glm::vec2 grid_max{room_size_};
+  for (const Wall& wall : walls) {
+    for (const glm::vec2& point : {wall.GetHead(), wall.GetTail()}) {
+      if (point.x < 0 || point.y < 0 || point.x > room_size_.x || point.y > room_size_.y) {
+        walls_inside_room_ = false;
+      }
+      grid_min = glm::min(grid_min, point);
+      grid_max = glm::max(grid_max, point);
+    }
+  }
+
+  glm::vec2 extent{grid_max - grid_min};
+  margin_ = kRelativeMargin * std::max(extent.x, extent.y) + kAbsoluteMargin;
+
+  size_t cells_per_side{1};
+  if (walls.size() >= kMinGridWalls) {
+    float cell_count{static_cast<float>(walls.size()) / kWallsPerCell};
+    cells_per_side = std::min(static_cast<size_t>(std::ceil(std::sqrt(cell_count))), kMaxCellsPerSide);
+  }
+  cells_x_ = cells_per_side;
+  cells_y_ = cells_per_side;
+
+  // Grid itself is grown by the margin, so that rays starting on the room edge are inside of it
+  origin_ = grid_min - glm::vec2(margin_);
+  cell_size_ = (extent + glm::vec2(2 * margin_)) / glm::vec2(cells_x_, cells_y_);
+
+  // Walls sharing a cell end up in the same few blocks. Stable, so a single cell keeps set order.
+  std::vector<std::pair<size_t, uint32_t>> cell_of_wall;
+  for (size_t i = 0; i < walls.size(); ++i) {
+    glm::vec2 middle{(walls[i].GetHead() + walls[i].GetTail()) * .5f};
+    cell_of_wall.emplace_back(CellIndex(middle), static_cast<uint32_t>(i));
+  }
+  std::stable_sort(cell_of_wall.begin(), cell_of_wall.end(),
+                   [](const std::pair<size_t, uint32_t>& a, const std::pair<size_t, uint32_t>& b) {
+                     return a.first < b.first;
+                   });
+
+  std::vector<Wall> sorted_walls;
+  for (const auto& cell_wall : cell_of_wall) {
+    sorted_walls.push_back(walls[cell_wall.second]);
+    set_indices_.push_back(cell_wall.second);
+  }
+  batch_ = WallBatch(sorted_walls);
+
+  // Cells are laid out row after row, each listing its blocks in order
+  cell_offsets_.assign(1, 0);
+  for (size_t y = 0; y < cells_y_; ++y) {
+    for (size_t x = 0; x < cells_x_; ++x) {
+      glm::vec2 cell_min{origin_ + cell_size_ * glm::vec2(x, y) - glm::vec2(margin_)};
+      glm::vec2 cell_max{origin_ + cell_size_ * glm::vec2(x + 1, y + 1) + glm::vec2(margin_)};
+
+      for (size_t block = 0; block * WallBatch::kBlockWidth < sorted_walls.size(); ++block) {
+        size_t block_end{std::min((block + 1) * WallBatch::kBlockWidth, sorted_walls.size())};
+        for (size_t i = block * WallBatch::kBlockWidth; i < block_end; ++i) {
+          if (WallTouchesBox(sorted_walls[i], cell_min, cell_max)) {
+            cell_blocks_.push_back(static_cast<uint32_t>(block));
+            break;
+          }
+        }
+      }
+      cell_offsets_.push_back(static_cast<uint32_t>(cell_blocks_.size()));
+    }
+  }
+}
+// End of Constructors =================================================================================================
+
+
+// Getters =============================================================================================================
+size_t WallGrid::WallCount() const {
+  return walls_.Size();
+}
+
+size_t WallGrid::CellsX() const {
+  return cells_x_;
+}
+
+size_t WallGrid::CellsY() const {
+  return cells_y_;
+}
+
+const std::vector<Wall>& WallGrid::GetWalls() const {
+  return walls_.GetWalls();
+}
+
+bool WallGrid::WallsInsideRoom() const {
+  return walls_inside_room_;
+}
+// End of Getters ======================================================================================================
+
+
+// Grid Geometry =======================================================================================================
+void WallGrid::AddWallHits(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float visible_range,
+                           float exit_distance, HitPackage& package) const {
+  // Single cell holds every wall, in set order. Nothing to walk.
+  if (cells_x_ * cells_y_ == 1) {
+    batch_.AddWallHits(ray_pos, ray_dir, visible_range, package);
+    return;
+  }
+
+  size_t block_count{(walls_.Size() + WallBatch::kBlockWidth - 1) / WallBatch::kBlockWidth};
+  size_t word_count{(block_count + 63) / 64};
+
+  uint64_t inline_blocks[kInlineWords];
+  std::vector<uint64_t> heap_blocks;
+  uint64_t* blocks{inline_blocks};
+  if (word_count > kInlineWords) {
+    heap_blocks.resize(word_count);
+    blocks = heap_blocks.data();
+  }
+  std::fill(blocks, blocks + word_count, 0);
+
+  float dir_length{glm::length(ray_dir)};
+  bool walkable{dir_length > 0 && std::isfinite(dir_length) && std::isfinite(ray_pos.x) && std::isfinite(ray_pos.y)};
+
+  if (walkable) {
+    float walk_range{visible_range};
+
+    // From within the room, every wall is hit before the ray leaves the room
+    bool starts_in_room{ray_pos.x >= -margin_ && ray_pos.y >= -margin_ &&
+                        ray_pos.x <= room_size_.x + margin_ && ray_pos.y <= room_size_.y + margin_};
+    if (walls_inside_room_ && starts_in_room) {
+      walk_range = std::min(walk_range, exit_distance);
+    }
+
+    CollectBlocks(ray_pos, ray_dir, (walk_range + margin_) / dir_length, blocks);
+  } else {
+    // Degenerate rays test every wall, like a plain loop would
+    std::fill(blocks, blocks + word_count, ~uint64_t{0});
+  }
+
+  // Walls left by the kernel are resolved in set order, so that ties between hits resolve the same way
+  uint32_t inline_candidates[kInlineCandidates];
+  std::vector<uint32_t> heap_candidates;
+  size_t candidate_count{0};
+
+  for (size_t word = 0; word < word_count; ++word) {
+    uint64_t bits{blocks[word]};
+    for (size_t block = word * 64; bits != 0 && block < block_count; ++block, bits >>= 1) {
+      if ((bits & 1u) == 0) {
+        continue;
+      }
+
+      size_t block_begin{block * WallBatch::kBlockWidth};
+      uint32_t mask{batch_.CandidateMask(block_begin, ray_pos, ray_dir)};
+      for (size_t i = block_begin; mask != 0; ++i, mask >>= 1) {
+        if ((mask & 1u) == 0) {
+          continue;
+        }
+        if (candidate_count < kInlineCandidates) {
+          inline_candidates[candidate_count] = set_indices_[i];
+        } else {
+          if (heap_candidates.empty()) {
+            heap_candidates.assign(inline_candidates, inline_candidates + kInlineCandidates);
+          }
+          heap_candidates.push_back(set_indices_[i]);
+        }
+        ++candidate_count;
+      }
+    }
+  }
+
+  uint32_t* candidates{heap_candidates.empty() ? inline_candidates : heap_candidates.data()};
+  std::sort(candidates, candidates + candidate_count);
+  for (size_t i = 0; i < candidate_count; ++i) {
+    Hit hit{walls_.GetWallHit(candidates[i], ray_pos, ray_dir, dir_length)};
+    if (!hit.IsNoHit() && hit.WithinDistance(visible_range)) {
+      package.AddHit(hit);
+    }
+  }
+}
+
+size_t WallGrid::CellIndex(const glm::vec2& point) const {
+  glm::vec2 cell{(point - origin_) / cell_size_};
+  long x{std::min(std::max(static_cast<long>(std::floor(cell.x)), 0L), static_cast<long>(cells_x_) - 1)};
+  long y{std::min(std::max(static_cast<long>(std::floor(cell.y)), 0L), static_cast<long>(cells_y_) - 1)};
+  return static_cast<size_t>(y) * cells_x_ + static_cast<size_t>(x);
+}
+
+void WallGrid::CollectBlocks(const glm::vec2& ray_pos, const glm::vec2& ray_dir, float t_limit,
+                             uint64_t* blocks) const {
+  const float infinity{std::numeric_limits<float>::infinity()};
+  glm::vec2 grid_end{origin_ + cell_size_ * glm::vec2(cells_x_, cells_y_)};
+
+  // Clip the ray to the grid
+  float t_begin{0};
+  float t_end{t_limit};
+  for (int axis = 0; axis < 2; ++axis) {
+    if (ray_dir[axis] == 0) {
+      if (ray_pos[axis] < origin_[axis] || ray_pos[axis] > grid_end[axis]) {
+        return;
+      }
+    } else {
+      float t_near{(origin_[axis] - ray_pos[axis]) / ray_dir[axis]};
+      float t_far{(grid_end[axis] - ray_pos[axis]) / ray_dir[axis]};
+      if (t_near > t_far) {
+        std::swap(t_near, t_far);
+      }
+      t_begin = std::max(t_begin, t_near);
+      t_end = std::min(t_end, t_far);
+    }
+  }
+  if (t_begin > t_end) {
+    return;
+  }
+
+  // Starting cell. Rounding across a cell border is covered by the margin.
+  size_t start{CellIndex(ray_pos + ray_dir * t_begin)};
+  long x{static_cast<long>(start % cells_x_)};
+  long y{static_cast<long>(start / cells_x_)};
+
+  long step_x{ray_dir.x > 0 ? 1 : -1};
+  long step_y{ray_dir.y > 0 ? 1 : -1};
+
+  // Parameters at which the ray crosses the next vertical and horizontal cell border
+  float t_next_x{ray_dir.x == 0 ? infinity
+                                : (origin_.x + (x + (ray_dir.x > 0)) * cell_size_.x - ray_pos.x) / ray_dir.x};
+  float t_next_y{ray_dir.y == 0 ? infinity
+                                : (origin_.y + (y + (ray_dir.y > 0)) * cell_size_.y - ray_pos.y) / ray_dir.y};
+  float t_delta_x{ray_dir.x == 0 ? infinity : cell_size_.x / std::abs(ray_dir.x)};
+  float t_delta_y{ray_dir.y == 0 ? infinity : cell_size_.y / std::abs(ray_dir.y)};
+
+  while (true) {
+    size_t cell{static_cast<size_t>(y) * cells_x_ + static_cast<size_t>(x)};
+    for (uint32_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+      uint32_t block{cell_blocks_[i]};
+      blocks[block / 64] |= uint64_t{1} << (block % 64);
+    }
+
+    if (t_next_x < t_next_y) {
+      if (t_next_x > t_end) {
+        return;
+      }
+      x += step_x;
+      if (x < 0 || x >= static_cast<long>(cells_x_)) {
+        return;
+      }
+      t_next_x += t_delta_x;
+    } else {
+      if (t_next_y > t_end) {
+        return;
+      }
+      y += step_y;
+      if (y < 0 || y >= static_cast<long>(cells_y_)) {
+        return;
+      }
+      t_next_y += t_delta_y;
+    }
+  }
+}
+// End of Grid Geometry ================================================================================================
+
+} // namespace room_explorer
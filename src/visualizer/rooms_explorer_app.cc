@@ -30,6 +30,18 @@ RoomsExplorerApp::RoomsExplorerApp()
 
   kVisibleDistance_ = meta_json.at("visible_distance");
 
+  // Vision threads are optional. Without them, every ray is cast on the render thread.
+  if (meta_json.contains("vision_threads")) {
+    game_engine_.SetVisionThreadCount(meta_json.at("vision_threads"));
+  }
+  // Portal budgets are optional as well. Without them, rays follow portals up to the default depth.
+  if (meta_json.contains("max_portal_depth")) {
+    game_engine_.SetMaxPortalDepth(meta_json.at("max_portal_depth"));
+  }
+  if (meta_json.contains("max_rooms_per_frame")) {
+    game_engine_.SetMaxRoomsPerFrame(meta_json.at("max_rooms_per_frame"));
+  }
+
   kFloorHeight_ = meta_json.at("floor_height");
 
   // Adjuster adjusts brightness function so that distant enough elements are shaded enough.
@@ -105,19 +117,20 @@ void RoomsExplorerApp::draw() {
 
 
   // Room-Elements
-  // Load through HitPackages in each strip direction
-  std::vector<HitPackage> packages{ game_engine_.GetVision(kResolutionCosine_, kResolutionSine_,
-                                                          kHalfResolution_,
-                                                          kVisibleDistance_) };
+  // Load every hit of the frame into the reused frame buffer, strip by strip
+  game_engine_.GetVision(kResolutionCosine_, kResolutionSine_,
+                         kHalfResolution_,
+                         kVisibleDistance_,
+                         frame_hits_);
   for (size_t i = 0; i < kTotalResolution_; ++i) { // Must draw each strip in order
-    const HitPackage& package = packages.at(i); // Hit Packages contain ordered individual Hits of room-element
+    // Hits of each strip are ordered individual Hits of room-element, nearest first
 
     // the furthest element must be rendered first, so nearer object can be layered on top, giveing transparent depth
     // Start at the end, and iterate down
-    auto it = package.GetHits().end();
-    while (it != package.GetHits().begin()) {
-      --it;
-      DrawStrip(i, it->second);
+    const Hit* hit = frame_hits_.StripEnd(i);
+    while (hit != frame_hits_.StripBegin(i)) {
+      --hit;
+      DrawStrip(i, *hit);
     }
   }
 }
@@ -0,0 +1,52 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/alias_table.h>
+#include <core/room_key.h>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using namespace room_explorer;
+
+namespace {
+
+/**
+ * Share of samples of each index, over evenly spread bits.
+ */
+std::vector<double> SampleShares(const AliasTable& table, size_t sample_count) {
+  std::vector<double> shares(table.Size(), 0);
+  for (size_t i = 0; i < sample_count; ++i) {
+    shares[table.Sample(MixKey(i))] += 1.0 / sample_count;
+  }
+  return shares;
+}
+
+} // namespace
+
+TEST_CASE("AliasTable Sampling") {
+  SECTION("Single weight") {
+    AliasTable table({2.5f});
+    REQUIRE(table.Size() == 1);
+    REQUIRE(table.Sample(0) == 0);
+    REQUIRE(table.Sample(~uint64_t{0}) == 0);
+  }
+
+  SECTION("Shares follow the weights") {
+    std::vector<float> weights{1, 3, 0, 4, 2};
+    std::vector<double> shares{SampleShares(AliasTable(weights), 100000)};
+    for (size_t i = 0; i < weights.size(); ++i) {
+      REQUIRE(shares[i] == Approx(weights[i] / 10).margin(.01));
+    }
+    REQUIRE(shares[2] == 0);
+  }
+
+  SECTION("No weight at all is uniform") {
+    std::vector<double> shares{SampleShares(AliasTable({0, 0, 0, 0}), 100000)};
+    for (double share : shares) {
+      REQUIRE(share == Approx(.25).margin(.01));
+    }
+  }
+}
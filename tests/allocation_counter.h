@@ -0,0 +1,16 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_ALLOCATION_COUNTER_H
+#define NONEUCLIDEAN_RAY_CASTER_ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+/**
+ * Number of times the test binary has called the global operator new so far, on any thread.
+ *    Replaced in allocation_counter.cc, so that code can be checked not to allocate once warmed up.
+ */
+size_t AllocationCount();
+
+#endif //NONEUCLIDEAN_RAY_CASTER_ALLOCATION_COUNTER_H
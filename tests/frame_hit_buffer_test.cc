@@ -0,0 +1,113 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/frame_hit_buffer.h>
+#include <core/game_engine.h>
+
+#include <catch2/catch.hpp>
+
+using namespace room_explorer;
+
+TEST_CASE("FrameHitBuffer Building") {
+  FrameHitBuffer frame;
+
+  SECTION("Empty") {
+    REQUIRE(frame.StripCount() == 0);
+    REQUIRE(frame.HitCount() == 0);
+  }
+
+  SECTION("Strips keep order and distance order") {
+    HitPackage first;
+    first.AddHit({5, kWall, 1});
+    first.AddHit({2, kPortal, 3});
+
+    HitPackage empty;
+
+    HitPackage third;
+    third.AddHit({7, kRoomWall, 0});
+
+    frame.AppendStrip(first);
+    frame.AppendStrip(empty);
+    frame.AppendStrip(third);
+
+    REQUIRE(frame.StripCount() == 3);
+    REQUIRE(frame.HitCount() == 3);
+
+    REQUIRE(frame.StripHitCount(0) == 2);
+    REQUIRE(frame.StripBegin(0)[0] == Hit(2, kPortal, 3));
+    REQUIRE(frame.StripBegin(0)[1] == Hit(5, kWall, 1));
+
+    REQUIRE(frame.StripHitCount(1) == 0);
+    REQUIRE(frame.StripBegin(1) == frame.StripEnd(1));
+
+    REQUIRE(frame.StripHitCount(2) == 1);
+    REQUIRE(*frame.StripBegin(2) == Hit(7, kRoomWall, 0));
+    REQUIRE(frame.StripEnd(2) == frame.StripBegin(0) + 3);
+  }
+
+  SECTION("Clear keeps memory") {
+    HitPackage package;
+    package.AddHit({1, kWall, 0});
+    package.AddHit({2, kWall, 0});
+
+    frame.Reserve(4, 8);
+    frame.AppendStrip(package);
+    const Hit* data{frame.StripBegin(0)};
+
+    frame.Clear();
+    REQUIRE(frame.StripCount() == 0);
+    REQUIRE(frame.HitCount() == 0);
+
+    frame.AppendStrip(package);
+    REQUIRE(frame.StripBegin(0) == data);
+  }
+}
+
+TEST_CASE("Frame Vision") {
+  GameEngine engine("resources/room_templates/small_maze.json");
+  float angle{0.02f};
+
+  FrameHitBuffer frame;
+  engine.GetVision(std::cos(angle), std::sin(angle), 60, 550, frame);
+  std::vector<HitPackage> packages{engine.GetVision(std::cos(angle), std::sin(angle), 60, 550)};
+
+  REQUIRE(frame.StripCount() == 121);
+  REQUIRE(packages.size() == 121);
+
+  for (size_t i = 0; i < packages.size(); ++i) {
+    REQUIRE(frame.StripHitCount(i) == packages[i].HitCount());
+
+    const Hit* hit{frame.StripBegin(i)};
+    for (const auto& hit_pair : packages[i].GetHits()) {
+      REQUIRE(*hit == hit_pair.second);
+      ++hit;
+    }
+  }
+
+  SECTION("Reused frame is overwritten") {
+    engine.GetVision(std::cos(angle), std::sin(angle), 10, 550, frame);
+    REQUIRE(frame.StripCount() == 21);
+  }
+
+  SECTION("Strips keep their angle whatever the resolution") {
+    // Strip rotations come straight from their angle, so the inner strips of a wider frame are the same rays
+    std::vector<HitPackage> narrow{engine.GetVision(std::cos(angle), std::sin(angle), 10, 550)};
+    REQUIRE(narrow.size() == 21);
+    for (size_t i = 0; i < narrow.size(); ++i) {
+      auto narrow_hits = narrow[i].GetHits();
+      auto wide_hits = packages[50 + i].GetHits();
+      REQUIRE(narrow_hits.size() == wide_hits.size());
+      for (const auto& hit_pair : wide_hits) {
+        REQUIRE(narrow_hits.at(hit_pair.first) == hit_pair.second);
+      }
+    }
+
+    // Tables are rebuilt for the wider frame again
+    engine.GetVision(std::cos(angle), std::sin(angle), 60, 550, frame);
+    REQUIRE(frame.StripCount() == 121);
+    for (size_t i = 0; i < packages.size(); ++i) {
+      REQUIRE(frame.StripHitCount(i) == packages[i].HitCount());
+    }
+  }
+}
@@ -236,4 +236,132 @@ TEST_CASE("Shift Back package") {
       REQUIRE(hits[8].hit_type_ == kWall);
     }
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Inline capacity overflow") {
+  HitPackage package;
+  // Added out of order, and past the inline capacity
+  size_t count{3 * HitPackage::kInlineCapacity};
+  for (size_t i = 0; i < count; ++i) {
+    package.AddHit({static_cast<float>((i * 7) % count), kWall, static_cast<float>(i)});
+  }
+
+  REQUIRE(package.HitCount() == count);
+
+  SECTION("Stays sorted") {
+    float distance{0};
+    for (const Hit& hit : package) {
+      REQUIRE(hit.hit_distance_ == distance);
+      ++distance;
+    }
+  }
+  SECTION("Merge with inline package") {
+    HitPackage other;
+    other.AddHit({0.5f, kPortal, 1});
+    other.AddHit({1, kRoomWall, 1});
+    other.AddHit({1000, kPortal, 1});
+
+    package.Merge(other);
+
+    REQUIRE(package.HitCount() == count + 2);
+    REQUIRE(package.begin()[1] == Hit(0.5f, kPortal, 1));
+    REQUIRE(package.begin()[2] == Hit(1, kRoomWall, 1));
+    REQUIRE((package.end() - 1)->hit_distance_ == 1000);
+  }
+  SECTION("Clear, then fill past the inline capacity again") {
+    package.ShiftHits(5);
+    package.Clear();
+    REQUIRE(package.HitCount() == 0);
+
+    package.AddHit({2, kWall, 0});
+    REQUIRE(package.begin()[0] == Hit(2, kWall, 0));
+    for (size_t i = 0; i < count; ++i) {
+      package.AddHit({static_cast<float>(count - i), kWall, 0});
+    }
+    REQUIRE(package.HitCount() == count);
+    float distance{1};
+    for (const Hit& hit : package) {
+      REQUIRE(hit.hit_distance_ == distance);
+      ++distance;
+    }
+  }
+}
+
+TEST_CASE("Scale package") {
+  HitPackage hitPackage;
+  hitPackage.AddHit({1, kWall, 5});
+  hitPackage.AddHit({2, kPortal, 5});
+  hitPackage.AddHit({3, kRoomWall, 5});
+
+  SECTION("Positive scale") {
+    hitPackage.ScaleDistances(2);
+
+    auto hits = hitPackage.GetHits();
+
+    REQUIRE(hits[2].hit_type_ == kWall);
+    REQUIRE(hits[4].hit_type_ == kPortal);
+    REQUIRE(hits[6].hit_type_ == kRoomWall);
+  }
+  SECTION("Negative scale keeps order") {
+    hitPackage.ScaleDistances(-1);
+
+    REQUIRE(hitPackage.HitCount() == 3);
+    REQUIRE(hitPackage.begin()[0] == Hit(-3, kRoomWall, 5));
+    REQUIRE(hitPackage.begin()[2] == Hit(-1, kWall, 5));
+  }
+  SECTION("Zero scale keeps highest priority") {
+    hitPackage.ScaleDistances(0);
+
+    REQUIRE(hitPackage.HitCount() == 1);
+    REQUIRE(*hitPackage.begin() == Hit(0, kRoomWall, 5));
+  }
+}
+
+TEST_CASE("Pending transform") {
+  HitPackage hitPackage;
+  hitPackage.AddHit({1, kWall, 5});
+  hitPackage.AddHit({2, kPortal, 5});
+  hitPackage.AddHit({3, kRoomWall, 5});
+
+  SECTION("Shift then scale compose") {
+    hitPackage.ShiftHits(1);
+    hitPackage.ScaleDistances(2);
+    hitPackage.ShiftHits(-1);
+
+    auto hits = hitPackage.GetHits();
+
+    REQUIRE(hits.size() == 3);
+    REQUIRE(hits[3].hit_type_ == kWall);
+    REQUIRE(hits[5].hit_type_ == kPortal);
+    REQUIRE(hits[7].hit_type_ == kRoomWall);
+  }
+  SECTION("Merge applies transform of other") {
+    HitPackage other;
+    other.AddHit({1, kRoomWall, 1});
+    other.AddHit({4, kPortal, 1});
+    other.ShiftHits(1);
+
+    hitPackage.Merge(other);
+
+    REQUIRE(hitPackage.HitCount() == 4);
+
+    auto hits = hitPackage.GetHits();
+
+    REQUIRE(hits[2].hit_type_ == kRoomWall);
+    REQUIRE(hits[2].texture_index_ == 1);
+    REQUIRE(hits[5].hit_type_ == kPortal);
+
+    // Other is left untouched, other than its own transform
+    REQUIRE(other.begin()[0] == Hit(2, kRoomWall, 1));
+  }
+  SECTION("Merge collapses other") {
+    HitPackage other;
+    other.AddHit({-1, kPortal, 1});
+    other.AddHit({-2, kWall, 1});
+    other.ScaleDistances(0);
+
+    hitPackage.Merge(other);
+
+    REQUIRE(hitPackage.HitCount() == 4);
+    REQUIRE(hitPackage.begin()[0] == Hit(0, kWall, 1));
+  }
+}
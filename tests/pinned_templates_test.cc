@@ -0,0 +1,88 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/pinned_templates.h>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace room_explorer;
+
+TEST_CASE("PinnedTemplates") {
+  PinnedTemplates pinned;
+  REQUIRE(pinned.Size() == 0);
+  REQUIRE(pinned.Find(0) == PinnedTemplates::kNoTemplate);
+
+  SECTION("Keys keep their first pin") {
+    REQUIRE(pinned.Pin(7, 2) == 2);
+    REQUIRE(pinned.Pin(7, 3) == 2);
+    REQUIRE(pinned.Find(7) == 2);
+    REQUIRE(pinned.Find(8) == PinnedTemplates::kNoTemplate);
+    REQUIRE(pinned.Size() == 1);
+  }
+
+  SECTION("Pins hold as the table grows") {
+    // Key 0 and consecutive keys, to probe past each other
+    const size_t key_count{1000};
+    for (RoomKey key = 0; key < key_count; ++key) {
+      REQUIRE(pinned.Pin(key, key % 5) == key % 5);
+    }
+    REQUIRE(pinned.Size() == key_count);
+    for (RoomKey key = 0; key < key_count; ++key) {
+      REQUIRE(pinned.Find(key) == key % 5);
+    }
+    REQUIRE(pinned.Find(key_count) == PinnedTemplates::kNoTemplate);
+  }
+
+  SECTION("Unpinned keys take a new pin") {
+    for (RoomKey key = 0; key < 100; ++key) {
+      pinned.Pin(key, 1);
+    }
+    pinned.Unpin({3, 50, 1000});
+    REQUIRE(pinned.Size() == 98);
+    REQUIRE(pinned.Find(3) == PinnedTemplates::kNoTemplate);
+    REQUIRE(pinned.Find(50) == PinnedTemplates::kNoTemplate);
+    REQUIRE(pinned.Find(4) == 1);
+
+    REQUIRE(pinned.Pin(3, 4) == 4);
+    REQUIRE(pinned.Find(3) == 4);
+  }
+
+  SECTION("Lookups race free with pins") {
+    // Readers look up keys while the writers pin them, growing the table under them
+    const size_t thread_count{4};
+    const RoomKey key_count{2000};
+    std::atomic<bool> start{false};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t) {
+      threads.emplace_back([&, t]() {
+        while (!start.load()) {
+          std::this_thread::yield();
+        }
+        for (RoomKey key = 0; key < key_count; ++key) {
+          if (t % 2 == 0) {
+            pinned.Pin(key, static_cast<size_t>(key % 3));
+          } else {
+            size_t found{pinned.Find(key)};
+            if (found != PinnedTemplates::kNoTemplate && found != key % 3) {
+              FAIL("Key found with another template");
+            }
+          }
+        }
+      });
+    }
+    start.store(true);
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    REQUIRE(pinned.Size() == key_count);
+    for (RoomKey key = 0; key < key_count; ++key) {
+      REQUIRE(pinned.Find(key) == key % 3);
+    }
+  }
+}
@@ -0,0 +1,99 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/predicates.h>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+
+using namespace room_explorer;
+
+TEST_CASE("CrossSign") {
+  SECTION("Turns") {
+    REQUIRE(CrossSign(glm::vec2(1, 0), glm::vec2(0, 1)) == 1);
+    REQUIRE(CrossSign(glm::vec2(0, 1), glm::vec2(1, 0)) == -1);
+  }
+  SECTION("Parallel") {
+    REQUIRE(CrossSign(glm::vec2(1, 2), glm::vec2(-2, -4)) == 0);
+    REQUIRE(CrossSign(glm::vec2(.1f, .3f), glm::vec2(.1f, .3f)) == 0);
+  }
+  SECTION("Zero Vector") {
+    REQUIRE(CrossSign(glm::vec2(0, 0), glm::vec2(3, 7)) == 0);
+  }
+  SECTION("Products below float precision") {
+    // Cross product is 1e-8 relative to its terms, which a float computation rounds to zero
+    float nudged{std::nextafter(3.f, 4.f)};
+    REQUIRE(CrossSign(glm::vec2(1, 3), glm::vec2(1, nudged)) == 1);
+    REQUIRE(CrossSign(glm::vec2(1, nudged), glm::vec2(1, 3)) == -1);
+  }
+}
+
+TEST_CASE("Orientation") {
+  SECTION("Turns") {
+    REQUIRE(Orientation(glm::vec2(0, 0), glm::vec2(1, 0), glm::vec2(1, 1)) == 1);
+    REQUIRE(Orientation(glm::vec2(0, 0), glm::vec2(1, 1), glm::vec2(1, 0)) == -1);
+  }
+  SECTION("Collinear") {
+    REQUIRE(Orientation(glm::vec2(.5f, .5f), glm::vec2(12, 12), glm::vec2(24, 24)) == 0);
+    REQUIRE(Orientation(glm::vec2(0, 10), glm::vec2(5, 10), glm::vec2(-3, 10)) == 0);
+  }
+  SECTION("Same points") {
+    REQUIRE(Orientation(glm::vec2(3, 4), glm::vec2(3, 4), glm::vec2(-1, 7)) == 0);
+    REQUIRE(Orientation(glm::vec2(3, 4), glm::vec2(3, 4), glm::vec2(3, 4)) == 0);
+  }
+
+  SECTION("Consistent on near-degenerate points") {
+    // Points a few float steps off the line y = x, where a float cross product decides inconsistently
+    glm::vec2 b(12, 12);
+    glm::vec2 c(24, 24);
+    for (int i = 0; i < 16; ++i) {
+      for (int j = 0; j < 16; ++j) {
+        glm::vec2 a(.5f, .5f);
+        for (int step = 0; step < i; ++step) {
+          a.x = std::nextafter(a.x, 1.f);
+        }
+        for (int step = 0; step < j; ++step) {
+          a.y = std::nextafter(a.y, 1.f);
+        }
+
+        int sign{Orientation(a, b, c)};
+        // Point above the line turns counterclockwise, below clockwise
+        REQUIRE(sign == (a.y > a.x) - (a.y < a.x));
+        // Same answer whatever the order of the points
+        REQUIRE(Orientation(b, c, a) == sign);
+        REQUIRE(Orientation(c, a, b) == sign);
+        REQUIRE(Orientation(b, a, c) == -sign);
+      }
+    }
+  }
+}
+
+TEST_CASE("SideOfLine") {
+  SECTION("Sides") {
+    REQUIRE(SideOfLine(glm::vec2(5, 1), glm::vec2(0, 0), glm::vec2(1, 0)) == 1);
+    REQUIRE(SideOfLine(glm::vec2(5, -1), glm::vec2(0, 0), glm::vec2(1, 0)) == -1);
+    REQUIRE(SideOfLine(glm::vec2(-5, 0), glm::vec2(0, 0), glm::vec2(1, 0)) == 0);
+  }
+  SECTION("Zero direction") {
+    REQUIRE(SideOfLine(glm::vec2(5, 1), glm::vec2(0, 0), glm::vec2(0, 0)) == 0);
+  }
+  SECTION("Agrees with Orientation") {
+    glm::vec2 line_pos(.5f, 1.25f);
+    glm::vec2 line_dir(3, 7);
+    for (float x = -4; x <= 4; x += .5f) {
+      for (float y = -4; y <= 4; y += .5f) {
+        glm::vec2 point(x, y);
+        REQUIRE(SideOfLine(point, line_pos, line_dir) == Orientation(line_pos, line_pos + line_dir, point));
+      }
+    }
+  }
+  SECTION("Point a float step off the line") {
+    glm::vec2 line_pos(.1f, .1f);
+    glm::vec2 line_dir(.3f, .3f);
+    REQUIRE(SideOfLine(glm::vec2(1.1f, 1.1f), line_pos, line_dir) == 0);
+    REQUIRE(SideOfLine(glm::vec2(std::nextafter(1.1f, 2.f), 1.1f), line_pos, line_dir) == -1);
+    REQUIRE(SideOfLine(glm::vec2(1.1f, std::nextafter(1.1f, 2.f)), line_pos, line_dir) == 1);
+  }
+}
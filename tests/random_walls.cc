@@ -0,0 +1,84 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include "random_walls.h"
+
+#include <catch2/catch.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <limits>
+
+using namespace room_explorer;
+
+RoomBounds MakeBounds(float width, float height) {
+  RoomBounds bounds;
+  bounds.width_ = width;
+  bounds.height_ = height;
+  return bounds;
+}
+
+std::set<Wall> MakeWalls(std::mt19937& generator, size_t count, int reach) {
+  std::uniform_int_distribution<int> coordinate(0, 200);
+  std::uniform_int_distribution<int> offset(-reach, reach);
+
+  std::set<Wall> walls;
+  for (size_t i = 0; i < count; ++i) {
+    glm::vec2 head(coordinate(generator), coordinate(generator));
+    glm::vec2 tail(head + glm::vec2(offset(generator), offset(generator)));
+    tail = glm::clamp(tail, glm::vec2(0), glm::vec2(200));
+    switch (i % 5) {
+      case 0: // Horizontal
+        tail.y = head.y;
+        break;
+      case 1: // Vertical
+        tail.x = head.x;
+        break;
+      default:
+        break;
+    }
+    walls.insert(Wall(head, tail));
+  }
+  // Point wall, collinear walls, and walls along the room edge
+  walls.insert(Wall({50, 50}, {50, 50}));
+  walls.insert(Wall({20, 120}, {60, 120}));
+  walls.insert(Wall({80, 120}, {140, 120}));
+  walls.insert(Wall({0, 0}, {0, 200}));
+  walls.insert(Wall({200, 40}, {200, 60}));
+  return walls;
+}
+
+float ExitDistance(const glm::vec2& pos, const glm::vec2& dir, float width, float height) {
+  float t{std::numeric_limits<float>::infinity()};
+  if (dir.x != 0) {
+    t = std::min(t, ((dir.x > 0 ? width : 0) - pos.x) / dir.x);
+  }
+  if (dir.y != 0) {
+    t = std::min(t, ((dir.y > 0 ? height : 0) - pos.y) / dir.y);
+  }
+  return t * glm::length(dir);
+}
+
+HitPackage LoopWallHits(const std::vector<Wall>& walls, const glm::vec2& pos, const glm::vec2& dir,
+                        float visible_range) {
+  HitPackage package;
+  for (const Wall& wall : walls) {
+    Hit hit{wall.GetWallHit(pos, dir)};
+    if (!hit.IsNoHit() && hit.WithinDistance(visible_range)) {
+      package.AddHit(hit);
+    }
+  }
+  return package;
+}
+
+void RequireSameHits(const HitPackage& expected, const HitPackage& actual) {
+  auto expected_hits = expected.GetHits();
+  auto actual_hits = actual.GetHits();
+  REQUIRE(expected_hits.size() == actual_hits.size());
+  for (const auto& hit_pair : expected_hits) {
+    REQUIRE(actual_hits.count(hit_pair.first) == 1);
+    REQUIRE(actual_hits.at(hit_pair.first) == hit_pair.second);
+  }
+}
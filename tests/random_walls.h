@@ -0,0 +1,56 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#ifndef NONEUCLIDEAN_RAY_CASTER_RANDOM_WALLS_H
+#define NONEUCLIDEAN_RAY_CASTER_RANDOM_WALLS_H
+
+#include <core/hit_package.h>
+#include <core/room_bounds.h>
+#include <core/wall.h>
+
+#include <glm/glm.hpp>
+
+#include <random>
+#include <set>
+#include <vector>
+
+// Walls and rooms shared by the tests of the wall partitions and batches, checked against every wall one by one.
+
+room_explorer::RoomBounds MakeBounds(float width, float height);
+
+/**
+ * Walls with integer end points within a 200 by 200 room, like the shipped templates, and a few degenerate ones:
+ *    a point wall, collinear walls, and walls along the room edge.
+ * @param reach How far a tail may lie from its head along each axis. Longer walls cross each other more.
+ */
+std::set<room_explorer::Wall> MakeWalls(std::mt19937& generator, size_t count, int reach);
+
+/**
+ * Distance at which a ray from within the room crosses the room edge.
+ */
+float ExitDistance(const glm::vec2& pos, const glm::vec2& dir, float width, float height);
+
+/**
+ * Hits of the ray with each wall in turn, within range. What every partition must give.
+ */
+room_explorer::HitPackage LoopWallHits(const std::vector<room_explorer::Wall>& walls, const glm::vec2& pos,
+                                       const glm::vec2& dir, float visible_range);
+
+/**
+ * Requires the packages to hold exactly the same hits.
+ */
+void RequireSameHits(const room_explorer::HitPackage& expected, const room_explorer::HitPackage& actual);
+
+/**
+ * Requires the partition to add exactly the hits of each wall in turn.
+ */
+template <typename Partition>
+void RequireSameHits(const std::vector<room_explorer::Wall>& walls, const Partition& partition, const glm::vec2& pos,
+                     const glm::vec2& dir, float visible_range, float exit_distance) {
+  room_explorer::HitPackage actual;
+  partition.AddWallHits(pos, dir, visible_range, exit_distance, actual);
+  RequireSameHits(LoopWallHits(walls, pos, dir, visible_range), actual);
+}
+
+#endif //NONEUCLIDEAN_RAY_CASTER_RANDOM_WALLS_H
@@ -0,0 +1,177 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/room.h>
+#include <core/room_arena.h>
+#include <core/room_factory.h>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace room_explorer;
+
+TEST_CASE("RoomArena Allocation") {
+  RoomArena arena;
+  REQUIRE(arena.RoomCount() == 0);
+
+  // Spans the first three chunks, so rooms on both sides of each chunk boundary are allocated
+  const size_t room_count{RoomArena::kFirstChunkSize * 7 + 3};
+  std::vector<Room*> rooms;
+  for (size_t i = 0; i < room_count; ++i) {
+    RoomId id{arena.Allocate()};
+    REQUIRE(id == i);
+    rooms.push_back(&arena.Get(id));
+  }
+  REQUIRE(arena.RoomCount() == room_count);
+
+  SECTION("Every id has its own room") {
+    std::set<Room*> distinct(rooms.begin(), rooms.end());
+    REQUIRE(distinct.size() == room_count);
+  }
+
+  SECTION("Released ids are reused") {
+    arena.Release(5);
+    arena.Release(RoomArena::kFirstChunkSize + 1);
+    REQUIRE(arena.RoomCount() == room_count - 2);
+    REQUIRE(arena.SlotCount() == room_count);
+
+    REQUIRE(arena.Allocate() == RoomArena::kFirstChunkSize + 1);
+    REQUIRE(arena.Allocate() == 5);
+    REQUIRE(arena.Allocate() == room_count);
+    REQUIRE(arena.RoomCount() == room_count + 1);
+  }
+
+  SECTION("Rooms stay in place as the arena grows") {
+    for (size_t i = 0; i < RoomArena::kFirstChunkSize * 8; ++i) {
+      arena.Allocate();
+    }
+    for (size_t i = 0; i < room_count; ++i) {
+      REQUIRE(&arena.Get(static_cast<RoomId>(i)) == rooms[i]);
+    }
+  }
+
+  SECTION("Ids race free across threads") {
+    // Threads allocate past the current chunks and release half of their ids, for the others to pop at once
+    const size_t thread_count{4};
+    const size_t step_count{RoomArena::kFirstChunkSize * 4};
+    std::vector<std::vector<RoomId>> held(thread_count);
+    std::atomic<bool> start{false};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t) {
+      threads.emplace_back([&, t]() {
+        while (!start.load()) {
+          std::this_thread::yield();
+        }
+        for (size_t i = 0; i < step_count; ++i) {
+          RoomId id{arena.Allocate()};
+          if (i % 2 == 0) {
+            arena.Release(id);
+          } else {
+            held[t].push_back(id);
+          }
+        }
+      });
+    }
+    start.store(true);
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    // No id is handed to two threads at once
+    std::set<RoomId> distinct;
+    for (const std::vector<RoomId>& ids : held) {
+      distinct.insert(ids.begin(), ids.end());
+    }
+    REQUIRE(distinct.size() == thread_count * step_count / 2);
+    REQUIRE(arena.RoomCount() == room_count + distinct.size());
+    for (RoomId id : distinct) {
+      REQUIRE(id < arena.SlotCount());
+    }
+  }
+}
+
+TEST_CASE("Factory rooms live in its arena") {
+  RoomFactory factory = R"aa(
+  {
+    "room_dimension" : {
+      "width" : 100,
+      "height" : 100,
+      "ns_door_width" : 20,
+      "ew_door_width" : 20
+    },
+    "rooms" : {
+      "default" : {
+        "walls" : []
+      }
+    }
+  })aa"_json;
+  REQUIRE(factory.GeneratedRoomCount() == 0);
+
+  Room* first{factory.GenerateRoom("default")};
+  REQUIRE(factory.GeneratedRoomCount() == 1);
+
+  SECTION("Unknown ids take no room") {
+    REQUIRE(factory.GenerateRoom("unknown") == nullptr);
+    REQUIRE(factory.GeneratedRoomCount() == 1);
+  }
+
+  SECTION("Links hold across chunks") {
+    // Walk north far enough for the path to cross several chunks
+    std::vector<Room*> path{first};
+    for (size_t i = 0; i < RoomArena::kFirstChunkSize * 3; ++i) {
+      path.push_back(path.back()->GetConnectedRoom(kNorth));
+    }
+    REQUIRE(factory.GeneratedRoomCount() == path.size());
+
+    for (size_t i = 1; i < path.size(); ++i) {
+      REQUIRE(path[i - 1]->IsConnectedWith(path[i], kNorth));
+      REQUIRE(path[i]->IsConnectedWith(path[i - 1], kSouth));
+      REQUIRE(path[i]->GetConnectedRoom(kSouth) == path[i - 1]);
+    }
+    REQUIRE(factory.GeneratedRoomCount() == path.size());
+  }
+
+  SECTION("Links race free across threads") {
+    // Threads walk the same rooms, all linking them for the first time at once
+    const size_t thread_count{4};
+    const size_t step_count{RoomArena::kFirstChunkSize};
+    std::vector<std::vector<Room*>> paths(thread_count);
+    std::atomic<bool> start{false};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t) {
+      threads.emplace_back([&, t]() {
+        while (!start.load()) {
+          std::this_thread::yield();
+        }
+        Room* room{first};
+        for (size_t i = 0; i < step_count; ++i) {
+          room = room->GetConnectedRoom(i % 2 == 0 ? kNorth : kEast);
+          paths[t].push_back(room);
+        }
+      });
+    }
+    start.store(true);
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    // Every thread got the room of whichever linked first, and the rooms of the others were given back
+    for (size_t t = 1; t < thread_count; ++t) {
+      REQUIRE(paths[t] == paths[0]);
+    }
+    REQUIRE(factory.GeneratedRoomCount() == step_count + 1);
+
+    Room* previous{first};
+    for (size_t i = 0; i < step_count; ++i) {
+      Direction direction{i % 2 == 0 ? kNorth : kEast};
+      REQUIRE(previous->IsConnectedWith(paths[0][i], direction));
+      REQUIRE(paths[0][i]->IsConnectedWith(previous, !direction));
+      previous = paths[0][i];
+    }
+  }
+}
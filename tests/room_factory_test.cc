@@ -2,10 +2,19 @@
 // Created by Jack Lee on 2020/11/18.
 //
 
+#include "allocation_counter.h"
+
 #include <core/room_factory.h>
 
 #include <catch2/catch.hpp>
 
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace room_explorer;
 
 TEST_CASE("Room Factory Sanity Check") {
@@ -425,7 +434,8 @@ TEST_CASE("Generate New Room from template") {
       REQUIRE(room->GetWidth() == 500);
       REQUIRE(room->GetHeight() == 200);
 
-      REQUIRE(room->GetWallCount() == 2);
+      // Both walls lie on the same line and overlap, so they are joined into one
+      REQUIRE(room->GetWallCount() == 1);
     }
 
   }
@@ -443,4 +453,331 @@ TEST_CASE("Generate New Room from template") {
 
     REQUIRE(room1->GetWallCount() != room2->GetWallCount());
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Seeded room generation") {
+  json json = R"aa(
+    {
+      "room_dimension" : {
+        "width" : 100,
+        "height" : 100,
+        "ns_door_width" : 20,
+        "ew_door_width" : 20
+      },
+      "seed" : 7,
+      "room_capacity" : 8,
+      "rooms" : {
+        "entry" : { "walls" : [] },
+        "one" : { "walls" : [ { "head_x" : 10, "head_y" : 10, "tail_x" : 20, "tail_y" : 20 } ] },
+        "two" : { "walls" : [ { "head_x" : 10, "head_y" : 10, "tail_x" : 20, "tail_y" : 20 },
+                              { "head_x" : 30, "head_y" : 10, "tail_x" : 40, "tail_y" : 20 } ] }
+      }
+    })aa"_json;
+  RoomFactory factory = json;
+  REQUIRE(factory.GetSeed() == 7);
+  REQUIRE(factory.GetRoomCapacity() == 8);
+
+  const Direction path[] = {kNorth, kEast, kEast, kNorth, kWest, kNorth, kNorth, kEast, kSouth, kEast};
+
+  SECTION("Keys step back to where they came from") {
+    for (RoomKey key : {RoomKey{0}, RoomKey{1}, ~RoomKey{0}, RoomKey{0x0123456789ABCDEF}}) {
+      REQUIRE(UnmixKey(MixKey(key)) == key);
+      REQUIRE(Room::NeighbourKey(Room::NeighbourKey(key, kNorth), kSouth) == key);
+      REQUIRE(Room::NeighbourKey(Room::NeighbourKey(key, kSouth), kNorth) == key);
+      REQUIRE(Room::NeighbourKey(Room::NeighbourKey(key, kEast), kWest) == key);
+      REQUIRE(Room::NeighbourKey(Room::NeighbourKey(key, kWest), kEast) == key);
+      REQUIRE(Room::NeighbourKey(key, kNorth) != Room::NeighbourKey(key, kEast));
+    }
+  }
+
+  SECTION("Same seed, same rooms") {
+    RoomFactory other_factory = json;
+    Room* room{factory.GenerateRoom("entry")};
+    Room* other_room{other_factory.GenerateRoom("entry")};
+    for (const Direction& direction : path) {
+      room = room->GetConnectedRoom(direction);
+      other_room = other_room->GetConnectedRoom(direction);
+      REQUIRE(room->GetKey() == other_room->GetKey());
+      REQUIRE(room->GetWallCount() == other_room->GetWallCount());
+    }
+    REQUIRE(factory.RandomId() == other_factory.RandomId());
+  }
+
+  SECTION("Evicted rooms come back the same") {
+    Room* room{factory.GenerateRoom("entry")};
+    RoomKey entry_key{room->GetKey()};
+
+    std::vector<RoomKey> keys;
+    std::vector<const std::vector<Wall>*> walls;
+    for (size_t i = 0; i < 40; ++i) {
+      room = room->GetConnectedRoom(kNorth);
+      factory.EvictDistantRooms(room);
+      REQUIRE(factory.GeneratedRoomCount() <= factory.GetRoomCapacity());
+      keys.push_back(room->GetKey());
+      walls.push_back(&room->GetWalls());
+    }
+
+    for (size_t i = 40; i-- > 1;) {
+      room = room->GetConnectedRoom(kSouth);
+      factory.EvictDistantRooms(room);
+      REQUIRE(factory.GeneratedRoomCount() <= factory.GetRoomCapacity());
+      REQUIRE(room->GetKey() == keys[i - 1]);
+      REQUIRE(&room->GetWalls() == walls[i - 1]);
+    }
+
+    // Entry room was generated from an explicit template, and keeps it
+    room = room->GetConnectedRoom(kSouth);
+    REQUIRE(room->GetKey() == entry_key);
+    REQUIRE(room->GetWallCount() == 0);
+    REQUIRE(factory.TemplateIdOf(entry_key) == "entry");
+    REQUIRE(factory.PinnedKeyCount() == 1);
+  }
+
+  SECTION("Keys keep the first template pinned to them") {
+    Room* first{factory.GenerateRoom("one", 12345)};
+    Room* second{factory.GenerateRoom("two", 12345)};
+    REQUIRE(first->GetWallCount() == 1);
+    REQUIRE(second->GetWallCount() == 1);
+    REQUIRE(factory.TemplateIdOf(12345) == "one");
+  }
+
+  SECTION("Pins of rooms no one can walk back to are dropped") {
+    Room* center{factory.GenerateRoom("entry")};
+    center->GetConnectedRoom(kNorth, "two");
+    for (size_t i = 0; i < 20; ++i) {
+      factory.GenerateRoom("one");
+    }
+    REQUIRE(factory.PinnedKeyCount() == 22);
+
+    factory.EvictDistantRooms(center);
+    REQUIRE(factory.PinnedKeyCount() == 2);
+    REQUIRE(factory.TemplateIdOf(center->GetKey()) == "entry");
+    REQUIRE(factory.TemplateIdOf(Room::NeighbourKey(center->GetKey(), kNorth)) == "two");
+  }
+}
+
+TEST_CASE("Weighted and fitted templates") {
+  json json = R"aa(
+    {
+      "room_dimension" : {
+        "width" : 100,
+        "height" : 100,
+        "ns_door_width" : 20,
+        "ew_door_width" : 20
+      },
+      "rooms" : {
+        "plain" : { "walls" : [], "weight" : 3 },
+        "hall" : { "walls" : [ { "head_x" : 10, "head_y" : 10, "tail_x" : 20, "tail_y" : 20 } ],
+                   "neighbours" : { "north" : [ "plain" ] } },
+        "never" : { "walls" : [ { "head_x" : 10, "head_y" : 10, "tail_x" : 20, "tail_y" : 20 },
+                                { "head_x" : 30, "head_y" : 10, "tail_x" : 40, "tail_y" : 20 } ],
+                    "weight" : 0 }
+      }
+    })aa"_json;
+  RoomFactory factory = json;
+
+  SECTION("Draws follow the weights") {
+    size_t plain_count{0};
+    for (size_t i = 0; i < 4000; ++i) {
+      const std::string& id = factory.RandomId();
+      REQUIRE(id != "never");
+      plain_count += id == "plain";
+    }
+    REQUIRE(plain_count / 4000.0 == Approx(.75).margin(.05));
+  }
+
+  SECTION("Rooms north of a hall are plain") {
+    // Wall count tells the templates apart
+    Room* room{factory.GenerateRandomRoom()};
+    const Direction path[] = {kNorth, kEast, kNorth, kNorth, kWest, kSouth, kWest, kNorth};
+    size_t hall_count{0};
+    for (size_t i = 0; i < 400; ++i) {
+      Room* next{room->GetConnectedRoom(path[i % 8])};
+      if (room->GetWallCount() == 1) {
+        ++hall_count;
+        REQUIRE(room->GetConnectedRoom(kNorth)->GetWallCount() == 0);
+      }
+      if (next->GetWallCount() == 1 && path[i % 8] == kSouth) {
+        REQUIRE(room->GetWallCount() == 0);
+      }
+      REQUIRE(next->GetWallCount() != 2);
+      room = next;
+    }
+    REQUIRE(hall_count > 0);
+  }
+
+  SECTION("Fitted templates are picked without allocating") {
+    // Warmed up first, should anything be set up on first use
+    factory.TemplateIdOf(0, true);
+    size_t allocations{AllocationCount()};
+    size_t hall_count{0};
+    for (RoomKey key = 1; key < 1000; ++key) {
+      hall_count += factory.TemplateIdOf(key, true) == "hall";
+    }
+    REQUIRE(AllocationCount() == allocations);
+    REQUIRE(hall_count > 0);
+  }
+
+  SECTION("Unknown neighbours and sides") {
+    nlohmann::json unknown_id = json;
+    unknown_id["rooms"]["hall"]["neighbours"]["north"] = {"nowhere"};
+    REQUIRE_THROWS_AS(RoomFactory(unknown_id), exceptions::NoRoomTemplateException);
+
+    nlohmann::json unknown_side = json;
+    unknown_side["rooms"]["plain"]["open_sides"] = {"up"};
+    REQUIRE_THROWS_AS(RoomFactory(unknown_side), exceptions::InvalidDirectionException);
+  }
+
+  SECTION("Weights without a share") {
+    nlohmann::json negative = json;
+    negative["rooms"]["plain"]["weight"] = -1;
+    REQUIRE_THROWS_AS(RoomFactory(negative), exceptions::InvalidTemplateWeightException);
+
+    // Too large for a float, so infinite once read
+    nlohmann::json infinite = json;
+    infinite["rooms"]["plain"]["weight"] = 1e39;
+    REQUIRE_THROWS_AS(RoomFactory(infinite), exceptions::InvalidTemplateWeightException);
+  }
+}
+
+TEST_CASE("TemplateAdjacency Compilation") {
+  std::vector<TemplateAdjacency::TemplateSides> sides(3);
+  // Template 1 only takes template 0 to its north. Template 2 has only its east and west doors open.
+  sides[1].ruled_[kNorth] = true;
+  sides[1].allowed_[kNorth] = {0};
+  sides[2].open_[kNorth] = false;
+  sides[2].open_[kSouth] = false;
+  TemplateAdjacency adjacency(sides);
+
+  SECTION("Rules hold both ways") {
+    REQUIRE(adjacency.Allows(1, kNorth, 0));
+    REQUIRE(!adjacency.Allows(1, kNorth, 1));
+    REQUIRE(!adjacency.Allows(1, kSouth, 1));
+    REQUIRE(adjacency.Allows(0, kSouth, 1));
+    REQUIRE(adjacency.Allows(1, kEast, 1));
+  }
+
+  SECTION("Doors match") {
+    REQUIRE(!adjacency.Allows(0, kNorth, 2));
+    REQUIRE(adjacency.Allows(2, kNorth, 2));
+    REQUIRE(adjacency.Allows(0, kEast, 2));
+  }
+
+  SECTION("Restriction never empties the mask") {
+    std::vector<uint64_t> mask{adjacency.FullMask()};
+    REQUIRE(mask[0] == 7);
+    REQUIRE(adjacency.Restrict(mask, 1, kNorth));
+    REQUIRE(mask[0] == 1);
+    REQUIRE(!adjacency.Restrict(mask, 2, kSouth));
+    REQUIRE(mask[0] == 1);
+  }
+
+  SECTION("Fitted picks keep to the restriction") {
+    // North of template 1 leaves only template 0. South of template 2 would leave none, so it is skipped.
+    const size_t only_first[] = {1, 2, 0, 0};
+    const size_t only_first_sides[] = {kNorth, kSouth, kEast, kWest};
+    for (uint64_t i = 0; i < 100; ++i) {
+      REQUIRE(adjacency.PickFitted(only_first, only_first_sides, {1, 1, 1}, MixKey(i)) == 0);
+    }
+
+    // Every template may sit east and west of template 0, so the weights alone decide
+    const size_t any[] = {0, 0, 0, 0};
+    const size_t any_sides[] = {kEast, kWest, kEast, kWest};
+    std::set<size_t> picked;
+    for (uint64_t i = 0; i < 100; ++i) {
+      REQUIRE(adjacency.PickFitted(any, any_sides, {0, 1, 0}, MixKey(i)) == 1);
+      picked.insert(adjacency.PickFitted(any, any_sides, {0, 0, 0}, MixKey(i)));
+    }
+    REQUIRE(picked.size() == 3);
+  }
+}
+
+TEST_CASE("Lazy JSON loading") {
+  // Braces within strings must not end the templates early
+  const std::string map_text = R"aa(
+    {
+      "entry_y" : 30,
+      "room_dimension" : { "width" : 100, "height" : 80, "ns_door_width" : 20, "ew_door_width" : 30 },
+      "seed" : 5,
+      "rooms" : {
+        "entry" : { "walls" : [] },
+        "hall {" : {
+          "walls" : [
+            { "head_x" : 10, "head_y" : 20, "tail_x" : 90, "tail_y" : 20 },
+            { "head_x" : 10.5, "head_y" : 60.25, "tail_x" : 90, "tail_y" : 60 }
+          ],
+          "wall_partition" : "bsp",
+          "weight" : 3,
+          "neighbours" : { "north" : [ "entry" ] }
+        },
+        "nook" : {
+          "open_sides" : [ "east", "west" ],
+          "walls" : [ { "head_x" : 50, "head_y" : 0, "tail_x" : 50, "tail_y" : 80 } ]
+        }
+      }
+    })aa";
+  RoomFactory eager_factory = json::parse(map_text);
+  RoomFactory lazy_factory;
+  std::istringstream map_stream(map_text);
+  lazy_factory.LoadJsonLazily(map_stream);
+
+  SECTION("Every field but the walls is loaded up front") {
+    REQUIRE(lazy_factory.GetAvailableIds() == eager_factory.GetAvailableIds());
+    REQUIRE(lazy_factory.GetEntryPosition() == glm::vec2(50, 30));
+    REQUIRE(lazy_factory.GetSeed() == 5);
+    REQUIRE(lazy_factory.GetEWPortalBegin() == eager_factory.GetEWPortalBegin());
+    for (const std::string& id : lazy_factory.GetAvailableIds()) {
+      REQUIRE(!lazy_factory.IsMaterialized(id));
+      REQUIRE(eager_factory.IsMaterialized(id));
+    }
+    REQUIRE(!lazy_factory.IsMaterialized("unknown"));
+  }
+
+  SECTION("Templates are materialized as rooms of them are generated") {
+    Room* room{lazy_factory.GenerateRoom("hall {")};
+    REQUIRE(room->GetWalls().size() == 2);
+    REQUIRE(lazy_factory.IsMaterialized("hall {"));
+    REQUIRE(!lazy_factory.IsMaterialized("nook"));
+
+    // Same weights and rules pick the same rooms
+    Room* eager_room{eager_factory.GenerateRoom("hall {")};
+    const Direction path[] = {kNorth, kEast, kEast, kSouth, kWest, kNorth, kNorth, kWest};
+    for (const Direction& direction : path) {
+      room = room->GetConnectedRoom(direction);
+      eager_room = eager_room->GetConnectedRoom(direction);
+      REQUIRE(room->GetWalls().size() == eager_room->GetWalls().size());
+      REQUIRE(room->GetPrimaryWallHit({30, 40}, {0, 1}) == eager_room->GetPrimaryWallHit({30, 40}, {0, 1}));
+    }
+  }
+
+  SECTION("Templates are materialized in the background") {
+    lazy_factory.MaterializeInBackground();
+    for (const std::string& id : lazy_factory.GetAvailableIds()) {
+      while (!lazy_factory.IsMaterialized(id)) {
+        std::this_thread::yield();
+      }
+    }
+    REQUIRE(lazy_factory.GenerateRoom("nook")->GetWalls().size() == 1);
+  }
+
+  SECTION("Malformed maps are refused") {
+    RoomFactory factory;
+    std::istringstream no_walls(R"aa({ "room_dimension" : { "width" : 1, "height" : 1, "ns_door_width" : 1,
+                                       "ew_door_width" : 1 }, "rooms" : { "a" : { "weight" : 1 } } })aa");
+    REQUIRE_THROWS_AS(factory.LoadJsonLazily(no_walls), json::out_of_range);
+
+    std::istringstream no_rooms(R"aa({ "room_dimension" : {} })aa");
+    REQUIRE_THROWS_AS(factory.LoadJsonLazily(no_rooms), json::out_of_range);
+
+    std::istringstream not_object(R"aa({ "rooms" : { "a" : [] } })aa");
+    REQUIRE_THROWS_AS(factory.LoadJsonLazily(not_object), json::type_error);
+
+    std::istringstream cut_short(map_text.substr(0, map_text.size() / 2));
+    REQUIRE_THROWS_AS(factory.LoadJsonLazily(cut_short), json::parse_error);
+
+    // Numbers too large for a double are out of range rather than malformed, as the eager loader has them
+    std::istringstream overflowing(R"aa({ "room_dimension" : { "width" : 1, "height" : 1, "ns_door_width" : 1,
+                                          "ew_door_width" : 1 },
+                                          "rooms" : { "a" : { "walls" : [ { "head_x" : 1e500 } ] } } })aa");
+    REQUIRE_THROWS_AS(factory.LoadJsonLazily(overflowing), json::out_of_range);
+  }
+}
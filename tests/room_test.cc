@@ -5,7 +5,12 @@
 #include <core/room.h>
 #include <core/room_factory.h>
 
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
 #include <string>
+#include <vector>
 #include <catch2/catch.hpp>
 
 using namespace room_explorer;
@@ -111,34 +116,11 @@ TEST_CASE("Correct Members generated") {
   }
 
   SECTION("Walls") {
-    REQUIRE(room.GetWallCount() == 2);
+    // Both walls lie on the same line and overlap, so they are joined into one spanning both
+    REQUIRE(room.GetWallCount() == 1);
 
     SECTION("Correct Walls") {
-      auto walls_iterator = room.GetWalls().begin();
-//      {
-//          "head_x" : 10,
-//          "head_y" : 10,
-//          "tail_x" : 100,
-//          "tail_y" : 100
-//        },
-//        {
-//          "head_x" : 11,
-//          "head_y" : 11,
-//          "tail_x" : 101,
-//          "tail_y" : 101
-//        }
-      bool flag_wall1 = *walls_iterator == Wall(glm::vec2(10, 10), glm::vec2(100, 100));
-      bool flag_wall2 = *walls_iterator == Wall(glm::vec2(11, 11), glm::vec2(101, 101));
-      REQUIRE( (flag_wall1 || flag_wall2) );
-
-      ++walls_iterator;
-
-      // Require wall is different but of either kind of walls
-      bool flag_wall3 = *walls_iterator == Wall(glm::vec2(10, 10), glm::vec2(100, 100));
-      bool flag_wall4 = *walls_iterator == Wall(glm::vec2(11, 11), glm::vec2(101, 101));
-      REQUIRE( (flag_wall3 != flag_wall1) );
-      REQUIRE( (flag_wall4 != flag_wall2) );
-      REQUIRE( (flag_wall3 || flag_wall4) );
+      REQUIRE(*room.GetWalls().begin() == Wall(glm::vec2(10, 10), glm::vec2(101, 101)));
     }
   }
 }
@@ -540,6 +522,36 @@ TEST_CASE("Room hit Diretion") {
   }
 }
 
+TEST_CASE("No-throw Room hit Direction") {
+  Room room = *factory.GenerateRandomRoom();
+  // (500, 200)
+
+  SECTION("Matches throwing version") {
+    REQUIRE(room.TryGetSideHit(glm::vec2(20, 100), glm::vec2(0, 1)) == kNorth);
+    REQUIRE(room.TryGetSideHit(glm::vec2(20, 200), glm::vec2(0, -1), false) == kSouth);
+    REQUIRE(room.TryGetSideHit(glm::vec2(1, 200), glm::vec2(1, 0), false) == kNorth);
+  }
+  SECTION("Pointing out of the room") {
+    REQUIRE(room.TryGetSideHit(glm::vec2(5, 200), glm::vec2(0, 1), false) == kUndefined);
+    REQUIRE(room.TryGetSideHit(glm::vec2(500, 20), glm::vec2(1, 0), false) == kUndefined);
+  }
+  SECTION("Outside of the room") {
+    REQUIRE(room.TryGetSideHit(glm::vec2(-1000, 0), glm::vec2(-1, -1), false) == kUndefined);
+  }
+  SECTION("Zero ray") {
+    REQUIRE(room.TryGetSideHit(glm::vec2(20, 100), glm::vec2(0, 0)) == kUndefined);
+  }
+  SECTION("Head and tail") {
+    glm::vec2 point{-1, -1};
+    REQUIRE_FALSE(room.TryGetHead(kUndefined, true, point));
+    REQUIRE_FALSE(room.TryGetTail(kUndefined, false, point));
+    REQUIRE(point == glm::vec2(-1, -1));
+
+    REQUIRE(room.TryGetHead(kNorth, true, point));
+    REQUIRE(point == room.GetHead(kNorth, true));
+  }
+}
+
 TEST_CASE("Room Wall Hit Distance") {
   Room room = *factory.GenerateRandomRoom();
   SECTION("North") {
@@ -1272,6 +1284,77 @@ TEST_CASE("Room Primary Hit") {
   }
 }
 
+TEST_CASE("Exit kernel matches side-hit rules") {
+  Room room = *factory.GenerateRandomRoom();
+  // (500, 200)
+
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<float> unit(0, 1);
+  std::uniform_real_distribution<float> angle(0, 6.2831853f);
+
+  auto check = [&](const glm::vec2& pos, const glm::vec2& dir, bool inclusive) {
+    Direction direction;
+    Hit hit = room.GetPrimaryWallHit(pos, dir, direction, inclusive);
+
+    Direction expected_direction{room.TryGetSideHit(pos, dir, inclusive)};
+    REQUIRE(direction == expected_direction);
+    if (expected_direction == kUndefined) {
+      REQUIRE(hit.IsNoHit());
+      return;
+    }
+
+    bool is_portal{room.RayHitsPortal(direction, pos, dir)};
+    REQUIRE(hit.hit_type_ == (is_portal ? kPortal : kRoomWall));
+    REQUIRE(hit.hit_distance_ == Approx(room.GetRoomWallHitDistance(direction, pos, dir)).margin(0.001));
+
+    // Texture index of the helpers loses precision on grazing rays, so it is checked in double precision instead
+    double length{std::hypot(double(dir.x), double(dir.y))};
+    double exit_x{pos.x + dir.x / length * hit.hit_distance_};
+    double exit_y{pos.y + dir.y / length * hit.hit_distance_};
+    glm::vec2 head{room.GetHead(direction, is_portal)};
+    REQUIRE(hit.texture_index_ == Approx(std::hypot(exit_x - head.x, exit_y - head.y)).margin(0.001));
+  };
+
+  SECTION("From inside") {
+    for (size_t i = 0; i < 2000; ++i) {
+      float theta{angle(generator)};
+      glm::vec2 pos(1 + 498 * unit(generator), 1 + 198 * unit(generator));
+      check(pos, {std::cos(theta), std::sin(theta)}, i % 2 == 0);
+    }
+  }
+  SECTION("Entering across an edge") {
+    for (size_t i = 0; i < 2000; ++i) {
+      float theta{angle(generator)};
+      glm::vec2 dir(std::cos(theta), std::sin(theta));
+      glm::vec2 pos;
+      switch (i % 4) {
+        case 0:
+          pos = {1 + 498 * unit(generator), 200};
+          break;
+        case 1:
+          pos = {1 + 498 * unit(generator), 0};
+          break;
+        case 2:
+          pos = {500, 1 + 198 * unit(generator)};
+          break;
+        default:
+          pos = {0, 1 + 198 * unit(generator)};
+          break;
+      }
+      check(pos, dir, false);
+    }
+  }
+  SECTION("Axis aligned and into corners") {
+    check({250, 100}, {1, 0}, false);
+    check({250, 100}, {0, -1}, false);
+    check({250, 100}, {250, 100}, false);
+    check({250, 100}, {-250, -100}, false);
+    check({250, 100}, {250, -100}, false);
+    check({250, 100}, {-250, 100}, false);
+    check({0, 100}, {250, 100}, false);
+  }
+}
+
 TEST_CASE("Single Room HitPackage") {
 
   SECTION("Empty room") {
@@ -1559,4 +1642,108 @@ TEST_CASE("Connected Room HitPackage") {
       REQUIRE(hits[600].hit_type_ == kPortal);
     }
   }
-}
\ No newline at end of file
+  SECTION("Portal depth budget") {
+    PortalBudget budget;
+    budget.max_portal_depth = 1;
+
+    HitPackage package = room.GetVisible(glm::vec2(250, 0), glm::vec2(0, 5), 600, budget);
+
+    // Stops at the second portal, which is left as the furthest hit
+    REQUIRE(package.HitCount() == 5);
+
+    auto hits = package.GetHits();
+
+    REQUIRE(hits[200].hit_type_ == kPortal);
+    REQUIRE(hits[300].hit_type_ == kWall);
+    REQUIRE(hits[400].hit_type_ == kPortal);
+  }
+  SECTION("Budget of one ray does not depend on another") {
+    PortalBudget budget;
+    budget.max_portal_depth = 1;
+
+    HitPackage first = room.GetVisible(glm::vec2(250, 0), glm::vec2(0, 5), 600, budget);
+    HitPackage second = room.GetVisible(glm::vec2(250, 0), glm::vec2(0, 5), 600, budget);
+
+    REQUIRE(first.HitCount() == 5);
+    REQUIRE(second.HitCount() == 5);
+  }
+  SECTION("Frame rooms are shared out among the rays") {
+    // Fewer rooms than rays, as for a small budget over a wide view
+    PortalBudget budget;
+    budget.frame_rooms = 1000;
+    budget.frame_ray_count = 1921;
+    size_t total{0};
+    for (size_t ray = 0; ray < budget.frame_ray_count; ++ray) {
+      REQUIRE(budget.RayPortalDepth(ray) <= 1);
+      total += budget.RayPortalDepth(ray);
+    }
+    REQUIRE(total == 1000);
+
+    // Calls on a slice of the frame see the shares of its rays
+    budget.frame_rooms = 5000;
+    total = 0;
+    for (size_t ray = 0; ray < budget.frame_ray_count; ++ray) {
+      PortalBudget slice_budget{budget};
+      slice_budget.first_ray = ray;
+      REQUIRE(slice_budget.RayPortalDepth(0) == budget.RayPortalDepth(ray));
+      REQUIRE((budget.RayPortalDepth(ray) == 2 || budget.RayPortalDepth(ray) == 3));
+      total += budget.RayPortalDepth(ray);
+    }
+    REQUIRE(total == 5000);
+
+    // Ray with a single room of the frame passes a single portal
+    budget.frame_rooms = 1;
+    budget.frame_ray_count = 2;
+    budget.first_ray = budget.RayPortalDepth(0) == 1 ? 0 : 1;
+    HitPackage package = room.GetVisible(glm::vec2(250, 0), glm::vec2(0, 5), 600, budget);
+    REQUIRE(package.HitCount() == 5);
+
+    budget.max_portal_depth = 0;
+    package = room.GetVisible(glm::vec2(250, 0), glm::vec2(0, 5), 600, budget);
+    REQUIRE(package.HitCount() < 5);
+  }
+}
+TEST_CASE("Ray Packet HitPackage") {
+  std::ifstream map_file("resources/room_templates/tight_map.json");
+  RoomFactory factory = json::parse(map_file);
+  Room* room{factory.GenerateRoom("entry")};
+  glm::vec2 position{factory.GetEntryPosition()};
+
+  // Fan of neighbouring rays, more than fit in a single packet, so that packets split and rays stop at random depths
+  std::vector<glm::vec2> directions;
+  for (size_t i = 0; i < 3 * Room::kMaxPacketWidth + 5; ++i) {
+    float angle{.4f + .002f * static_cast<float>(i)};
+    directions.emplace_back(std::cos(angle), std::sin(angle));
+  }
+  // Rays straight along the axes, and a degenerate one
+  directions.emplace_back(1, 0);
+  directions.emplace_back(0, -1);
+  directions.emplace_back(0, 0);
+
+  auto require_same_packages = [&](const PortalBudget& budget) {
+    std::vector<HitPackage> packages(directions.size());
+    room->GetVisible(position, directions.data(), directions.size(), 2000, budget, packages.data());
+
+    for (size_t i = 0; i < directions.size(); ++i) {
+      HitPackage expected{room->GetVisible(position, directions[i], 2000, budget)};
+      REQUIRE(packages[i].HitCount() == expected.HitCount());
+      const Hit* hit{packages[i].begin()};
+      for (const Hit& expected_hit : expected) {
+        REQUIRE(hit->hit_distance_ == expected_hit.hit_distance_);
+        REQUIRE(hit->hit_type_ == expected_hit.hit_type_);
+        REQUIRE(hit->texture_index_ == expected_hit.texture_index_);
+        ++hit;
+      }
+    }
+  };
+
+  SECTION("Same hits as each ray alone") {
+    require_same_packages(PortalBudget());
+  }
+
+  SECTION("Same hits under a portal depth budget") {
+    PortalBudget budget;
+    budget.max_portal_depth = 3;
+    require_same_packages(budget);
+  }
+}
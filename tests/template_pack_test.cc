@@ -0,0 +1,152 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/room.h>
+#include <core/room_factory.h>
+#include <core/template_pack.h>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace room_explorer;
+
+namespace {
+
+const char* kPackPath = "template_pack_test.pack";
+
+typedef std::tuple<float, float, float, float> WallTuple;
+
+/**
+ * Walls of the room in a fixed order, since set order follows addresses.
+ */
+std::vector<WallTuple> SortedWalls(const Room& room) {
+  std::vector<WallTuple> walls;
+  for (const Wall& wall : room.GetWalls()) {
+    walls.emplace_back(wall.GetHead().x, wall.GetHead().y, wall.GetTail().x, wall.GetTail().y);
+  }
+  std::sort(walls.begin(), walls.end());
+  return walls;
+}
+
+} // namespace
+
+TEST_CASE("Template pack round trip") {
+  json template_json = R"aa(
+    {
+      "entry_x" : 20,
+      "room_dimension" : {
+        "width" : 100,
+        "height" : 80,
+        "ns_door_width" : 20,
+        "ew_door_width" : 30
+      },
+      "seed" : 11,
+      "room_capacity" : 64,
+      "rooms" : {
+        "entry" : { "walls" : [] },
+        "hall" : {
+          "walls" : [
+            { "head_x" : 10, "head_y" : 20, "tail_x" : 90, "tail_y" : 20 },
+            { "head_x" : 10.5, "head_y" : 60.25, "tail_x" : 90, "tail_y" : 60 }
+          ],
+          "wall_partition" : "bsp",
+          "weight" : 2.5,
+          "open_sides" : [ "north", "south" ],
+          "neighbours" : { "north" : [ "entry", "hall" ], "east" : [] }
+        }
+      }
+    })aa"_json;
+  RoomFactory json_factory = template_json;
+  {
+    std::ofstream pack_file(kPackPath, std::ios::binary);
+    json_factory.WritePack(pack_file);
+  }
+
+  SECTION("Pack is told apart from JSON") {
+    REQUIRE(TemplatePack::IsPack(kPackPath));
+    REQUIRE(!TemplatePack::IsPack("resources/room_templates/tight_map.json"));
+    REQUIRE(!TemplatePack::IsPack("no_such_file.pack"));
+  }
+
+  SECTION("Pack holds the templates") {
+    TemplatePack pack(kPackPath);
+    REQUIRE(pack.GetHeader().template_count_ == 2);
+    REQUIRE(pack.GetHeader().wall_count_ == 2);
+    REQUIRE(pack.GetId(0) == "entry");
+    REQUIRE(pack.GetId(1) == "hall");
+    REQUIRE(pack.GetEntry(1).flags_ & TemplatePack::kUsesBspFlag);
+    REQUIRE(pack.GetEntry(1).neighbour_count_[kNorth] == 2);
+    REQUIRE(pack.GetEntry(1).neighbour_count_[kEast] == 0);
+    REQUIRE(pack.GetEntry(1).flags_ & TemplatePack::RuledSideFlag(kEast));
+  }
+
+  SECTION("Factory loaded from pack matches factory loaded from JSON") {
+    RoomFactory pack_factory;
+    pack_factory.LoadPack(TemplatePack(kPackPath));
+
+    REQUIRE(pack_factory.RoomWidth() == 100);
+    REQUIRE(pack_factory.RoomHeight() == 80);
+    REQUIRE(pack_factory.GetEWPortalBegin() == json_factory.GetEWPortalBegin());
+    REQUIRE(pack_factory.GetEntryPosition() == glm::vec2(20, 40));
+    REQUIRE(pack_factory.GetSeed() == 11);
+    REQUIRE(pack_factory.GetRoomCapacity() == 64);
+    REQUIRE(pack_factory.GetAvailableIds() == json_factory.GetAvailableIds());
+
+    // Same templates, weights and rules pick the same rooms
+    Room* json_room{json_factory.GenerateRoom("entry")};
+    Room* pack_room{pack_factory.GenerateRoom("entry")};
+    const Direction path[] = {kNorth, kNorth, kEast, kSouth, kWest, kWest, kNorth, kEast};
+    for (const Direction& direction : path) {
+      json_room = json_room->GetConnectedRoom(direction);
+      pack_room = pack_room->GetConnectedRoom(direction);
+      REQUIRE(SortedWalls(*json_room) == SortedWalls(*pack_room));
+    }
+  }
+
+  SECTION("Damaged packs are refused") {
+    std::ifstream pack_file(kPackPath, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(pack_file)), std::istreambuf_iterator<char>());
+    const char* damaged_path = "template_pack_test_damaged.pack";
+
+    std::ofstream(damaged_path, std::ios::binary).write(bytes.data(), bytes.size() - 1);
+    REQUIRE_THROWS_AS(TemplatePack(damaged_path), exceptions::InvalidTemplatePackException);
+
+    std::string wrong_version{bytes};
+    wrong_version[sizeof(TemplatePack::kMagic)] ^= 1;
+    std::ofstream(damaged_path, std::ios::binary).write(wrong_version.data(), wrong_version.size());
+    REQUIRE_THROWS_AS(TemplatePack(damaged_path), exceptions::InvalidTemplatePackException);
+
+    std::remove(damaged_path);
+    REQUIRE_THROWS_AS(TemplatePack(damaged_path), exceptions::InvalidTemplatePackException);
+  }
+
+  SECTION("Packs with weights without a share are refused") {
+    std::ifstream pack_file(kPackPath, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(pack_file)), std::istreambuf_iterator<char>());
+    const char* weighted_path = "template_pack_test_weighted.pack";
+    size_t weight_offset{sizeof(TemplatePackHeader) + sizeof(TemplatePackEntry) + offsetof(TemplatePackEntry, weight_)};
+
+    for (float weight : {-1.0f, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()}) {
+      std::string weighted{bytes};
+      std::memcpy(&weighted[weight_offset], &weight, sizeof(weight));
+      std::ofstream(weighted_path, std::ios::binary).write(weighted.data(), weighted.size());
+
+      RoomFactory pack_factory;
+      REQUIRE_THROWS_AS(pack_factory.LoadPack(TemplatePack(weighted_path)), exceptions::InvalidTemplatePackException);
+    }
+    std::remove(weighted_path);
+  }
+
+  std::remove(kPackPath);
+}
@@ -6,6 +6,8 @@
 
 #include <core/game_engine.h>
 
+#include <iostream>
+
 bool KnuthApprox(float actual, float expected, float epsilon) {
   float diff = actual - expected;
   if (diff < epsilon || diff > epsilon) {
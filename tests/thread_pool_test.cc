@@ -0,0 +1,181 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include "allocation_counter.h"
+
+#include <core/game_engine.h>
+#include <core/thread_pool.h>
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace room_explorer;
+
+TEST_CASE("ParallelFor") {
+  WorkStealingPool pool(3);
+
+  SECTION("Thread Count") {
+    REQUIRE(pool.ThreadCount() == 3);
+  }
+
+  SECTION("Every index visited exactly once") {
+    std::vector<std::atomic<int>> visits(1000);
+    for (auto& visit : visits) {
+      visit = 0;
+    }
+
+    pool.ParallelFor(visits.size(), 7, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        ++visits[i];
+      }
+    });
+
+    for (auto& visit : visits) {
+      REQUIRE(visit == 1);
+    }
+  }
+
+  SECTION("Chunks never exceed grain") {
+    std::atomic<bool> oversized{false};
+    pool.ParallelFor(100, 8, [&](size_t begin, size_t end) {
+      if (end - begin > 8 || end <= begin) {
+        oversized = true;
+      }
+    });
+    REQUIRE_FALSE(oversized);
+  }
+
+  SECTION("Empty range") {
+    bool called{false};
+    pool.ParallelFor(0, 4, [&](size_t, size_t) { called = true; });
+    REQUIRE_FALSE(called);
+  }
+
+  SECTION("Repeated jobs on the same pool") {
+    std::atomic<size_t> total{0};
+    for (size_t job = 0; job < 50; ++job) {
+      pool.ParallelFor(64, 1, [&](size_t begin, size_t end) {
+        total += end - begin;
+      });
+    }
+    REQUIRE(total == 50 * 64);
+  }
+
+  SECTION("Uneven work is still completed") {
+    // Early indices are far more expensive, so other threads must steal them to finish
+    std::vector<double> results(64);
+    pool.ParallelFor(results.size(), 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        double sum{0};
+        size_t cost{i < 8 ? 200000u : 10u};
+        for (size_t k = 0; k < cost; ++k) {
+          sum += 1.0 / (k + 1);
+        }
+        results[i] = sum;
+      }
+    });
+    for (double result : results) {
+      REQUIRE(result > 0);
+    }
+  }
+
+  SECTION("Exception is passed to the caller") {
+    REQUIRE_THROWS_AS(pool.ParallelFor(32, 1, [](size_t begin, size_t) {
+      if (begin == 17) {
+        throw std::runtime_error("strip failed");
+      }
+    }), std::runtime_error);
+
+    // Pool remains usable afterwards
+    std::atomic<size_t> total{0};
+    pool.ParallelFor(32, 4, [&](size_t begin, size_t end) { total += end - begin; });
+    REQUIRE(total == 32);
+  }
+
+  SECTION("Repeated jobs allocate nothing") {
+    // Captures more than std::function holds inline
+    std::atomic<size_t> total{0};
+    size_t a{1}, b{2}, c{3}, d{4};
+    auto task = [&](size_t begin, size_t end) { total += (end - begin) * (a + b + c + d) / 10; };
+    pool.ParallelFor(1000, 3, task);
+
+    size_t before{AllocationCount()};
+    for (size_t i = 0; i < 10; ++i) {
+      pool.ParallelFor(1000, 3, task);
+    }
+    REQUIRE(AllocationCount() == before);
+    REQUIRE(total == 11000);
+  }
+}
+
+TEST_CASE("Pool without workers") {
+  WorkStealingPool pool(0);
+  size_t total{0};
+  pool.ParallelFor(10, 3, [&](size_t begin, size_t end) { total += end - begin; });
+  REQUIRE(total == 10);
+}
+
+TEST_CASE("Parallel Vision") {
+  GameEngine engine("resources/room_templates/small_maze.json");
+
+  float angle{0.02f};
+
+  SECTION("Thread count") {
+    REQUIRE(engine.GetVisionThreadCount() == 1);
+    engine.SetVisionThreadCount(4);
+    REQUIRE(engine.GetVisionThreadCount() == 4);
+    engine.SetVisionThreadCount(0);
+    REQUIRE(engine.GetVisionThreadCount() == 1);
+  }
+
+  SECTION("Matches single-threaded vision") {
+    engine.SetVisionThreadCount(4);
+    std::vector<HitPackage> parallel{engine.GetVision(std::cos(angle), std::sin(angle), 60, 550)};
+
+    // Every room the rays reach is generated by now, so single-threaded vision sees the exact same map
+    engine.SetVisionThreadCount(1);
+    std::vector<HitPackage> serial{engine.GetVision(std::cos(angle), std::sin(angle), 60, 550)};
+
+    REQUIRE(parallel.size() == 121);
+    REQUIRE(serial.size() == 121);
+    for (size_t i = 0; i < serial.size(); ++i) {
+      auto serial_hits = serial[i].GetHits();
+      auto parallel_hits = parallel[i].GetHits();
+
+      REQUIRE(serial_hits.size() == parallel_hits.size());
+      auto serial_it = serial_hits.begin();
+      auto parallel_it = parallel_hits.begin();
+      for (; serial_it != serial_hits.end(); ++serial_it, ++parallel_it) {
+        REQUIRE(serial_it->first == parallel_it->first);
+        REQUIRE(serial_it->second == parallel_it->second);
+      }
+    }
+  }
+  SECTION("Room budget smaller than the strip count") {
+    // Strips that enter no room see only the walls of the current one
+    engine.SetMaxPortalDepth(0);
+    std::vector<HitPackage> no_portals{engine.GetVision(std::cos(angle), std::sin(angle), 60, 550)};
+
+    // 50 rooms for 121 strips still lets up to 50 strips through a portal, whatever the threads and schedule
+    engine.SetMaxPortalDepth(DEFAULT_MAX_PORTAL_DEPTH);
+    engine.SetMaxRoomsPerFrame(50);
+    std::vector<HitPackage> budgeted{engine.GetVision(std::cos(angle), std::sin(angle), 60, 550)};
+    size_t through_portal{0};
+    for (size_t i = 0; i < budgeted.size(); ++i) {
+      through_portal += budgeted[i].HitCount() != no_portals[i].HitCount();
+    }
+    REQUIRE(through_portal > 0);
+    REQUIRE(through_portal <= 50);
+
+    engine.SetVisionThreadCount(4);
+    engine.SetVisionSchedule(kPacketSchedule);
+    std::vector<HitPackage> parallel{engine.GetVision(std::cos(angle), std::sin(angle), 60, 550)};
+    for (size_t i = 0; i < budgeted.size(); ++i) {
+      REQUIRE(parallel[i].HitCount() == budgeted[i].HitCount());
+    }
+  }
+}
@@ -0,0 +1,54 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include "allocation_counter.h"
+
+#include <core/room_factory.h>
+#include <core/vision_wavefront.h>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+using namespace room_explorer;
+
+TEST_CASE("Vision casting allocations") {
+  std::ifstream map_file("resources/room_templates/tight_map.json");
+  RoomFactory factory = json::parse(map_file);
+  Room* room{factory.GenerateRoom("entry")};
+  glm::vec2 position{factory.GetEntryPosition()};
+
+  // Rays all around, as the strips of a few frames looking every way
+  std::vector<glm::vec2> directions;
+  for (size_t i = 0; i < 480; ++i) {
+    float angle{.0130900f * static_cast<float>(i) + .001f};
+    directions.emplace_back(std::cos(angle), std::sin(angle));
+  }
+  std::vector<HitPackage> packages(directions.size());
+  PortalBudget budget;
+
+  SECTION("Ray packets allocate nothing once the rooms are generated") {
+    auto cast = [&]() {
+      for (size_t first = 0; first < directions.size(); first += 8) {
+        room->GetVisible(position, &directions[first], 8, 2000, budget, &packages[first]);
+      }
+    };
+    cast();
+
+    size_t before{AllocationCount()};
+    cast();
+    REQUIRE(AllocationCount() == before);
+  }
+
+  SECTION("Wavefront allocates nothing once its queues have grown") {
+    VisionWavefront wavefront;
+    wavefront.Cast(room, position, directions.data(), directions.size(), 2000, budget, packages.data());
+
+    size_t before{AllocationCount()};
+    wavefront.Cast(room, position, directions.data(), directions.size(), 2000, budget, packages.data());
+    REQUIRE(AllocationCount() == before);
+  }
+}
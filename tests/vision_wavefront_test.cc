@@ -0,0 +1,65 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/room_factory.h>
+#include <core/vision_wavefront.h>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+using namespace room_explorer;
+
+TEST_CASE("Vision Wavefront") {
+  std::ifstream map_file("resources/room_templates/tight_map.json");
+  RoomFactory factory = json::parse(map_file);
+  Room* room{factory.GenerateRoom("entry")};
+  glm::vec2 position{factory.GetEntryPosition()};
+
+  // Rays all around, so that waves spread over many rooms, and rays stop at every depth
+  std::vector<glm::vec2> directions;
+  for (size_t i = 0; i < 360; ++i) {
+    float angle{.0174533f * static_cast<float>(i) + .001f};
+    directions.emplace_back(std::cos(angle), std::sin(angle));
+  }
+  // Rays straight along the axes, and a degenerate one
+  directions.emplace_back(1, 0);
+  directions.emplace_back(0, -1);
+  directions.emplace_back(0, 0);
+
+  VisionWavefront wavefront;
+  auto require_same_packages = [&](const PortalBudget& budget) {
+    std::vector<HitPackage> packages(directions.size());
+    wavefront.Cast(room, position, directions.data(), directions.size(), 2000, budget, packages.data());
+
+    for (size_t i = 0; i < directions.size(); ++i) {
+      HitPackage expected{room->GetVisible(position, directions[i], 2000, budget)};
+      REQUIRE(packages[i].HitCount() == expected.HitCount());
+      const Hit* hit{packages[i].begin()};
+      for (const Hit& expected_hit : expected) {
+        REQUIRE(hit->hit_distance_ == expected_hit.hit_distance_);
+        REQUIRE(hit->hit_type_ == expected_hit.hit_type_);
+        REQUIRE(hit->texture_index_ == expected_hit.texture_index_);
+        ++hit;
+      }
+    }
+  };
+
+  SECTION("Same hits as each ray alone") {
+    require_same_packages(PortalBudget());
+  }
+
+  SECTION("Same hits under a portal depth budget") {
+    PortalBudget budget;
+    budget.max_portal_depth = 3;
+    require_same_packages(budget);
+  }
+
+  SECTION("Same hits when the wavefront is cast again") {
+    require_same_packages(PortalBudget());
+    require_same_packages(PortalBudget());
+  }
+}
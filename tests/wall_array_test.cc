@@ -0,0 +1,101 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/wall_array.h>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace room_explorer;
+
+namespace {
+
+bool CacheAligned(const float* array) {
+  return reinterpret_cast<uintptr_t>(array) % CacheAlignedAllocator<float>::kAlignment == 0;
+}
+
+} // namespace
+
+TEST_CASE("Wall Array Layout") {
+  std::vector<Wall> walls{Wall({0, 0}, {3, 4}), Wall({10, 20}, {10, 5}), Wall({7, 7}, {7, 7})};
+  WallArray array(walls);
+
+  SECTION("Walls keep their order") {
+    REQUIRE(array.Size() == 3);
+    REQUIRE(array.GetWalls() == walls);
+  }
+
+  SECTION("Arrays are aligned and padded") {
+    REQUIRE(array.PaddedSize() == WallArray::kPaddingWidth);
+    for (const float* values : {array.HeadX(), array.HeadY(), array.TailX(), array.TailY(),
+                                array.DirectionX(), array.DirectionY(), array.Length()}) {
+      REQUIRE(CacheAligned(values));
+      for (size_t i = array.Size(); i < array.PaddedSize(); ++i) {
+        REQUIRE(values[i] == 0);
+      }
+    }
+  }
+
+  SECTION("Derived data is precomputed") {
+    REQUIRE(array.HeadY()[1] == 20);
+    REQUIRE(array.TailX()[0] == 3);
+    REQUIRE(array.DirectionX()[1] == 0);
+    REQUIRE(array.DirectionY()[1] == -15);
+    REQUIRE(array.Length()[0] == 5);
+    REQUIRE(array.Length()[2] == 0);
+  }
+
+  SECTION("No walls") {
+    WallArray empty{std::vector<Wall>()};
+    REQUIRE(empty.Size() == 0);
+    REQUIRE(empty.PaddedSize() == 0);
+  }
+}
+
+TEST_CASE("Wall Array Hits") {
+  std::mt19937 generator(21);
+  std::uniform_int_distribution<int> coordinate(0, 100);
+  std::uniform_real_distribution<float> position(-10, 110);
+  std::uniform_real_distribution<float> angle(0, 6.2831853f);
+
+  std::vector<Wall> walls;
+  for (size_t i = 0; i < 50; ++i) {
+    glm::vec2 head(coordinate(generator), coordinate(generator));
+    glm::vec2 tail(coordinate(generator), coordinate(generator));
+    if (i % 3 == 0) {
+      tail.y = head.y;
+    }
+    walls.emplace_back(head, tail);
+  }
+  WallArray array(walls);
+
+  // Rays from anywhere, from wall ends, and along walls, against every wall
+  std::vector<std::pair<glm::vec2, glm::vec2>> rays;
+  for (size_t i = 0; i < 200; ++i) {
+    float theta{angle(generator)};
+    rays.emplace_back(glm::vec2(position(generator), position(generator)), glm::vec2(std::cos(theta), std::sin(theta)));
+  }
+  for (const Wall& wall : walls) {
+    rays.emplace_back(wall.GetHead(), (wall.GetTail() - wall.GetHead()) * 3.f);
+  }
+
+  for (const auto& ray : rays) {
+    float ray_length{glm::length(ray.second)};
+    for (size_t i = 0; i < walls.size(); ++i) {
+      Hit expected{walls[i].GetWallHit(ray.first, ray.second)};
+      Hit hit{array.GetWallHit(i, ray.first, ray.second, ray_length)};
+      REQUIRE(hit.IsNoHit() == expected.IsNoHit());
+      if (!expected.IsNoHit()) {
+        // Bitwise, not approximately
+        REQUIRE(hit.hit_distance_ == expected.hit_distance_);
+        REQUIRE(hit.texture_index_ == expected.texture_index_);
+        REQUIRE(hit.hit_type_ == expected.hit_type_);
+      }
+    }
+  }
+}
@@ -0,0 +1,109 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include "random_walls.h"
+
+#include <core/wall_batch.h>
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace room_explorer;
+
+namespace {
+
+/**
+ * Rays from random points, from wall end-points, and along walls.
+ */
+std::vector<std::pair<glm::vec2, glm::vec2>> MakeRays(std::mt19937& generator, const std::set<Wall>& walls) {
+  std::uniform_real_distribution<float> coordinate(0, 200);
+  std::uniform_real_distribution<float> angle(0, 6.2831853f);
+
+  std::vector<std::pair<glm::vec2, glm::vec2>> rays;
+  for (size_t i = 0; i < 300; ++i) {
+    float theta{angle(generator)};
+    rays.emplace_back(glm::vec2(coordinate(generator), coordinate(generator)),
+                      glm::vec2(std::cos(theta), std::sin(theta)));
+  }
+  for (const Wall& wall : walls) {
+    float theta{angle(generator)};
+    rays.emplace_back(wall.GetHead(), glm::vec2(std::cos(theta), std::sin(theta)));
+    rays.emplace_back(wall.GetTail(), wall.GetHead() - wall.GetTail()); // Along the wall, not normalized
+    rays.emplace_back(wall.GetHead() + glm::vec2(5, 0), glm::vec2(-1, 0)); // Axis aligned
+  }
+  return rays;
+}
+
+} // namespace
+
+TEST_CASE("WallBatch Construction") {
+  SECTION("Empty") {
+    WallBatch batch(std::set<Wall>{});
+    REQUIRE(batch.WallCount() == 0);
+
+    HitPackage package;
+    batch.AddWallHits({1, 1}, {1, 0}, 100, package);
+    REQUIRE(package.HitCount() == 0);
+  }
+
+  SECTION("Keeps set order") {
+    std::mt19937 generator(1);
+    std::set<Wall> walls{MakeWalls(generator, 40, 200)};
+    WallBatch batch(walls);
+
+    REQUIRE(batch.WallCount() == walls.size());
+    size_t i{0};
+    for (const Wall& wall : walls) {
+      REQUIRE(batch.GetWalls()[i] == wall);
+      ++i;
+    }
+  }
+}
+
+TEST_CASE("WallBatch matches scalar wall hits") {
+  WallKernel original{WallBatch::GetActiveKernel()};
+
+  std::mt19937 generator(7);
+  std::set<Wall> walls{MakeWalls(generator, 37, 200)}; // Not a multiple of block width, so padding is exercised
+  std::vector<Wall> ordered_walls(walls.begin(), walls.end());
+  WallBatch batch(walls);
+  std::vector<std::pair<glm::vec2, glm::vec2>> rays{MakeRays(generator, walls)};
+
+  for (WallKernel kernel : {kScalarKernel, kSSE2Kernel, kAVX2Kernel, kAVX512Kernel}) {
+    if (!WallBatch::SetActiveKernel(kernel)) {
+      continue;
+    }
+
+    for (const auto& ray : rays) {
+      // No hit may be rejected by the kernel
+      for (size_t block = 0; block < batch.WallCount(); block += WallBatch::kBlockWidth) {
+        uint32_t mask{batch.CandidateMask(block, ray.first, ray.second)};
+        for (size_t i = block; i < std::min(block + WallBatch::kBlockWidth, batch.WallCount()); ++i) {
+          if (!batch.GetWalls()[i].GetWallHit(ray.first, ray.second).IsNoHit()) {
+            REQUIRE((mask >> (i - block) & 1u) == 1u);
+          }
+        }
+      }
+
+      HitPackage actual;
+      batch.AddWallHits(ray.first, ray.second, 150, actual);
+      RequireSameHits(LoopWallHits(ordered_walls, ray.first, ray.second, 150), actual);
+    }
+  }
+
+  WallBatch::SetActiveKernel(original);
+}
+
+TEST_CASE("Kernel Selection") {
+  REQUIRE(WallBatch::KernelSupported(kScalarKernel));
+  REQUIRE(WallBatch::KernelSupported(WallBatch::GetActiveKernel()));
+
+  WallKernel original{WallBatch::GetActiveKernel()};
+  REQUIRE(WallBatch::SetActiveKernel(kScalarKernel));
+  REQUIRE(WallBatch::GetActiveKernel() == kScalarKernel);
+  WallBatch::SetActiveKernel(original);
+}
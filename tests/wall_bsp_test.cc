@@ -0,0 +1,208 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include "random_walls.h"
+
+#include <core/room.h>
+#include <core/room_factory.h>
+#include <core/wall_bsp.h>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace room_explorer;
+
+namespace {
+
+/**
+ * Hits of the tree against hits of every wall.
+ *    Distances and types match exactly. Between walls hit at exactly the same distance,
+ *    the tree may keep another one than the loop, so its texture index only has to be that of one of them.
+ */
+void RequireSameBspHits(const std::vector<Wall>& walls, const WallBsp& bsp, const glm::vec2& pos, const glm::vec2& dir,
+                        float visible_range, float exit_distance) {
+  HitPackage expected{LoopWallHits(walls, pos, dir, visible_range)};
+  std::vector<Hit> every_hit;
+  for (const Wall& wall : walls) {
+    Hit hit{wall.GetWallHit(pos, dir)};
+    if (!hit.IsNoHit() && hit.WithinDistance(visible_range)) {
+      every_hit.push_back(hit);
+    }
+  }
+
+  HitPackage actual;
+  bsp.AddWallHits(pos, dir, visible_range, exit_distance, actual);
+
+  auto expected_hits = expected.GetHits();
+  auto actual_hits = actual.GetHits();
+  REQUIRE(expected_hits.size() == actual_hits.size());
+  for (const auto& hit_pair : expected_hits) {
+    REQUIRE(actual_hits.count(hit_pair.first) == 1);
+    const Hit& hit{actual_hits.at(hit_pair.first)};
+    REQUIRE(hit.hit_type_ == hit_pair.second.hit_type_);
+    if (!(hit == hit_pair.second)) {
+      bool tied{false};
+      for (const Hit& other : every_hit) {
+        tied = tied || other == hit;
+      }
+      REQUIRE(tied);
+    }
+  }
+
+  Hit nearest{bsp.NearestWallHit(pos, dir, visible_range)};
+  if (expected.HitCount() == 0) {
+    REQUIRE(nearest.IsNoHit());
+  } else {
+    REQUIRE(nearest == *expected.begin());
+  }
+}
+
+} // namespace
+
+TEST_CASE("WallBsp Construction") {
+  SECTION("Empty") {
+    WallBsp bsp(std::set<Wall>{}, MakeBounds(100, 100));
+    REQUIRE(bsp.WallCount() == 0);
+    REQUIRE(bsp.NodeCount() == 0);
+
+    HitPackage package;
+    bsp.AddWallHits({1, 1}, {1, 0}, 100, 99, package);
+    REQUIRE(package.HitCount() == 0);
+    REQUIRE(bsp.NearestWallHit({1, 1}, {1, 0}, 100).IsNoHit());
+  }
+
+  SECTION("Point walls only") {
+    std::set<Wall> walls{Wall({10, 10}, {10, 10}), Wall({20, 10}, {20, 10})};
+    WallBsp bsp(walls, MakeBounds(100, 100));
+    REQUIRE(bsp.NodeCount() == 1);
+
+    HitPackage package;
+    bsp.AddWallHits({0, 10}, {1, 0}, 100, 100, package);
+    REQUIRE(package.HitCount() == 2);
+    REQUIRE(package.begin()->hit_distance_ == Approx(10));
+  }
+
+  SECTION("Keeps set order") {
+    std::mt19937 generator(1);
+    std::set<Wall> walls{MakeWalls(generator, 100, 40)};
+    WallBsp bsp(walls, MakeBounds(200, 200));
+
+    REQUIRE(bsp.WallCount() == walls.size());
+    size_t i{0};
+    for (const Wall& wall : walls) {
+      REQUIRE(bsp.GetWalls()[i] == wall);
+      ++i;
+    }
+  }
+
+  SECTION("Crossing walls are split") {
+    std::set<Wall> walls{Wall({0, 50}, {100, 50}), Wall({50, 0}, {50, 100}),
+                         Wall({10, 10}, {90, 90}), Wall({10, 90}, {90, 10})};
+    WallBsp bsp(walls, MakeBounds(100, 100));
+    REQUIRE(bsp.FragmentCount() > bsp.WallCount());
+
+    // Texture index runs along the whole wall, not along the piece it is split into
+    for (const Wall& wall : walls) {
+      glm::vec2 target{wall.GetHead() + (wall.GetTail() - wall.GetHead()) * .8f};
+      glm::vec2 pos{target.x + 3, target.y - 7};
+      Hit hit{bsp.NearestWallHit(pos, target - pos, 1000)};
+      REQUIRE(hit == wall.GetWallHit(pos, target - pos));
+    }
+  }
+}
+
+TEST_CASE("WallBsp matches every wall hit") {
+  std::mt19937 generator(12);
+  std::set<Wall> walls{MakeWalls(generator, 300, 40)};
+  WallBsp bsp(walls, MakeBounds(200, 200));
+  REQUIRE(bsp.FragmentCount() > bsp.WallCount());
+  const std::vector<Wall>& ordered_walls{bsp.GetWalls()};
+
+  std::uniform_real_distribution<float> coordinate(0, 200);
+  std::uniform_real_distribution<float> angle(0, 6.2831853f);
+
+  SECTION("Random rays") {
+    for (size_t i = 0; i < 2000; ++i) {
+      float theta{angle(generator)};
+      glm::vec2 pos(coordinate(generator), coordinate(generator));
+      glm::vec2 dir(std::cos(theta), std::sin(theta));
+      RequireSameBspHits(ordered_walls, bsp, pos, dir, 150, ExitDistance(pos, dir, 200, 200));
+      RequireSameBspHits(ordered_walls, bsp, pos, dir * 3.f, 1000, std::numeric_limits<float>::infinity());
+    }
+  }
+
+  SECTION("Rays from walls and along walls") {
+    for (const Wall& wall : ordered_walls) {
+      float theta{angle(generator)};
+      glm::vec2 dir(std::cos(theta), std::sin(theta));
+      RequireSameBspHits(ordered_walls, bsp, wall.GetHead(), dir, 1000, ExitDistance(wall.GetHead(), dir, 200, 200));
+      RequireSameBspHits(ordered_walls, bsp, wall.GetTail(), wall.GetHead() - wall.GetTail(), 1000,
+                      std::numeric_limits<float>::infinity());
+    }
+  }
+
+  SECTION("Axis aligned rays on the room edge") {
+    for (float along = 0; along <= 200; along += 12.5f) {
+      RequireSameBspHits(ordered_walls, bsp, {0, along}, {1, 0}, 1000, 200);
+      RequireSameBspHits(ordered_walls, bsp, {along, 200}, {0, -1}, 1000, 200);
+      RequireSameBspHits(ordered_walls, bsp, {0, along}, {0, 1}, 1000, 200 - along);
+    }
+  }
+
+  SECTION("Degenerate rays") {
+    RequireSameBspHits(ordered_walls, bsp, {50, 50}, {0, 0}, 1000, 0);
+    RequireSameBspHits(ordered_walls, bsp, {-50, 300}, {1, -1}, 1000, std::numeric_limits<float>::infinity());
+  }
+}
+
+TEST_CASE("Template asks for the tree") {
+  RoomFactory factory = R"aa(
+  {
+    "room_dimension" : {
+      "width" : 100,
+      "height" : 100,
+      "ns_door_width" : 20,
+      "ew_door_width" : 20
+    },
+    "rooms" : {
+      "grid" : {
+        "walls" : [
+          { "head_x" : 10, "head_y" : 20, "tail_x" : 90, "tail_y" : 20 },
+          { "head_x" : 50, "head_y" : 5, "tail_x" : 50, "tail_y" : 95 },
+          { "head_x" : 10, "head_y" : 10, "tail_x" : 90, "tail_y" : 90 }
+        ]
+      },
+      "bsp" : {
+        "walls" : [
+          { "head_x" : 10, "head_y" : 20, "tail_x" : 90, "tail_y" : 20 },
+          { "head_x" : 50, "head_y" : 5, "tail_x" : 50, "tail_y" : 95 },
+          { "head_x" : 10, "head_y" : 10, "tail_x" : 90, "tail_y" : 90 }
+        ],
+        "wall_partition" : "bsp"
+      }
+    }
+  })aa"_json;
+
+  Room* grid_room{factory.GenerateRoom("grid")};
+  Room* bsp_room{factory.GenerateRoom("bsp")};
+
+  for (float theta = 0; theta < 6.28f; theta += .05f) {
+    glm::vec2 pos(30, 60);
+    glm::vec2 dir(std::cos(theta), std::sin(theta));
+
+    auto grid_hits = grid_room->CurrentRoomPackage(pos, dir, 500, true).GetHits();
+    auto bsp_hits = bsp_room->CurrentRoomPackage(pos, dir, 500, true).GetHits();
+    REQUIRE(grid_hits.size() == bsp_hits.size());
+    for (const auto& hit_pair : grid_hits) {
+      REQUIRE(bsp_hits.count(hit_pair.first) == 1);
+      REQUIRE(bsp_hits.at(hit_pair.first) == hit_pair.second);
+    }
+  }
+
+}
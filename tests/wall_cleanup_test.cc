@@ -0,0 +1,167 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include <core/room_factory.h>
+#include <core/wall_cleanup.h>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace room_explorer;
+
+namespace {
+
+/**
+ * Room of 100 by 100, with doors from 40 to 60 on every edge.
+ */
+RoomBounds MakeBounds() {
+  RoomBounds bounds;
+  bounds.width_ = 100;
+  bounds.height_ = 100;
+  bounds.ns_door_begin_ = bounds.ew_door_begin_ = 40;
+  bounds.ns_door_end_ = bounds.ew_door_end_ = 60;
+  return bounds;
+}
+
+std::vector<Wall> CleanUp(const std::vector<Wall>& walls, WallCleanupReport& report) {
+  return CleanUpWalls(walls, MakeBounds(), report);
+}
+
+float NearestHitDistance(const std::vector<Wall>& walls, const glm::vec2& pos, const glm::vec2& dir) {
+  float nearest{std::numeric_limits<float>::infinity()};
+  for (const Wall& wall : walls) {
+    Hit hit{wall.GetWallHit(pos, dir)};
+    if (!hit.IsNoHit()) {
+      nearest = std::min(nearest, hit.hit_distance_);
+    }
+  }
+  return nearest;
+}
+
+} // namespace
+
+TEST_CASE("Wall Cleanup") {
+  WallCleanupReport report;
+
+  SECTION("Walls of no length are dropped") {
+    std::vector<Wall> walls{CleanUp({Wall({10, 10}, {10, 10}), Wall({20, 20}, {20, 20.0001f}),
+                                     Wall({30, 30}, {40, 30})}, report)};
+    REQUIRE(walls.size() == 1);
+    REQUIRE(report.degenerate_count_ == 2);
+    REQUIRE(report.OutputCount() == 1);
+  }
+
+  SECTION("Walls hidden by the room edge are dropped") {
+    std::vector<Wall> walls{CleanUp({Wall({0, 5}, {0, 40}), Wall({60, 100}, {95, 100}), Wall({100, 0}, {100, 20}),
+                                     Wall({0, 30}, {0, 50}), Wall({45, 0}, {55, 0}), Wall({1, 5}, {1, 40})}, report)};
+    REQUIRE(report.boundary_count_ == 3);
+    // Walls covering a door, and walls off the edge, are kept
+    REQUIRE(walls.size() == 3);
+  }
+
+  SECTION("Duplicates are removed") {
+    std::vector<Wall> walls{CleanUp({Wall({10, 10}, {50, 30}), Wall({10, 10}, {50, 30}), Wall({50, 30}, {10, 10}),
+                                     Wall({10.0002f, 10}, {50, 30.0002f}), Wall({30, 20}, {40, 25})}, report)};
+    REQUIRE(walls.size() == 1);
+    REQUIRE(report.duplicate_count_ == 4);
+    REQUIRE(report.merged_count_ == 0);
+  }
+
+  SECTION("Touching and overlapping walls on a line are joined") {
+    std::vector<Wall> walls{CleanUp({Wall({30, 50}, {60, 50}), Wall({10, 50}, {30, 50}), Wall({55, 50}, {80, 50}),
+                                     Wall({90, 50}, {95, 50})}, report)};
+    REQUIRE(walls.size() == 2);
+    REQUIRE(report.merged_count_ == 2);
+    REQUIRE(std::count(walls.begin(), walls.end(), Wall({10, 50}, {80, 50})) == 1);
+    REQUIRE(std::count(walls.begin(), walls.end(), Wall({90, 50}, {95, 50})) == 1);
+  }
+
+  SECTION("Joined walls run the way the longest of them does") {
+    std::vector<Wall> walls{CleanUp({Wall({20, 70}, {20, 10}), Wall({20, 70}, {20, 80})}, report)};
+    REQUIRE(walls.size() == 1);
+    REQUIRE(walls.front() == Wall({20, 80}, {20, 10}));
+  }
+
+  SECTION("Parallel walls are not joined") {
+    std::vector<Wall> walls{CleanUp({Wall({10, 50}, {30, 50}), Wall({30, 50.1f}, {60, 50.1f}),
+                                     Wall({10, 10}, {20, 20}), Wall({20, 21}, {30, 31})}, report)};
+    REQUIRE(walls.size() == 4);
+    REQUIRE(report.OutputCount() == 4);
+  }
+
+  SECTION("Order of the walls makes no difference") {
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<int> coordinate(1, 19);
+    std::vector<Wall> given;
+    for (size_t i = 0; i < 60; ++i) {
+      // Few distinct lines, so that many walls join
+      float x{coordinate(generator) * 5.f};
+      float y{coordinate(generator) * 5.f};
+      given.push_back(i % 2 == 0 ? Wall({x, 25}, {y, 25}) : Wall({45, x}, {45, y}));
+    }
+    std::vector<Wall> expected{CleanUp(given, report)};
+    REQUIRE(report.OutputCount() == expected.size());
+    REQUIRE(expected.size() < given.size());
+
+    for (size_t i = 0; i < 5; ++i) {
+      std::shuffle(given.begin(), given.end(), generator);
+      REQUIRE(CleanUp(given, report) == expected);
+    }
+
+    // Rays meet the cleaned walls where they met the given ones
+    std::uniform_real_distribution<float> position(0, 100);
+    std::uniform_real_distribution<float> angle(0, 6.2831853f);
+    for (size_t i = 0; i < 500; ++i) {
+      glm::vec2 pos(position(generator), position(generator));
+      float theta{angle(generator)};
+      glm::vec2 dir(std::cos(theta), std::sin(theta));
+      float given_distance{NearestHitDistance(given, pos, dir)};
+      float cleaned_distance{NearestHitDistance(expected, pos, dir)};
+      if (std::isinf(given_distance)) {
+        REQUIRE(std::isinf(cleaned_distance));
+      } else {
+        REQUIRE(cleaned_distance == Approx(given_distance).margin(.001));
+      }
+    }
+  }
+}
+
+TEST_CASE("Factory cleans up template walls") {
+  RoomFactory factory = R"aa(
+  {
+    "room_dimension" : {
+      "width" : 100,
+      "height" : 100,
+      "ns_door_width" : 20,
+      "ew_door_width" : 20
+    },
+    "rooms" : {
+      "entry" : {
+        "walls" : [
+          { "head_x" : 10, "head_y" : 20, "tail_x" : 90, "tail_y" : 20 },
+          { "head_x" : 10, "head_y" : 20, "tail_x" : 90, "tail_y" : 20 },
+          { "head_x" : 90, "head_y" : 20, "tail_x" : 95, "tail_y" : 20 },
+          { "head_x" : 50, "head_y" : 50, "tail_x" : 50, "tail_y" : 50 },
+          { "head_x" : 0, "head_y" : 0, "tail_x" : 0, "tail_y" : 30 }
+        ]
+      },
+      "empty" : {
+        "walls" : []
+      }
+    }
+  })aa"_json;
+
+  REQUIRE(factory.GenerateRoom("entry")->GetWalls().size() == 1);
+  WallCleanupReport report{factory.GetWallCleanupReport()};
+  REQUIRE(report.input_count_ == 5);
+  REQUIRE(report.duplicate_count_ == 1);
+  REQUIRE(report.merged_count_ == 1);
+  REQUIRE(report.degenerate_count_ == 1);
+  REQUIRE(report.boundary_count_ == 1);
+}
@@ -0,0 +1,108 @@
+//
+// Created by Jack Lee on 2026/10/17.
+//
+
+#include "random_walls.h"
+
+#include <core/wall_grid.h>
+
+#include <catch2/catch.hpp>
+
+#include <limits>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace room_explorer;
+
+TEST_CASE("WallGrid Construction") {
+  SECTION("Empty") {
+    WallGrid grid(std::set<Wall>{}, MakeBounds(100, 100));
+    REQUIRE(grid.WallCount() == 0);
+    REQUIRE(grid.CellsX() == 1);
+    REQUIRE(grid.WallsInsideRoom());
+
+    HitPackage package;
+    grid.AddWallHits({1, 1}, {1, 0}, 100, 99, package);
+    REQUIRE(package.HitCount() == 0);
+  }
+
+  SECTION("Small template keeps a single cell") {
+    std::mt19937 generator(1);
+    std::set<Wall> walls{MakeWalls(generator, 40, 20)};
+    WallGrid grid(walls, MakeBounds(200, 200));
+
+    REQUIRE(grid.CellsX() == 1);
+    REQUIRE(grid.CellsY() == 1);
+  }
+
+  SECTION("Keeps set order") {
+    std::mt19937 generator(1);
+    std::set<Wall> walls{MakeWalls(generator, WallGrid::kMinGridWalls, 20)};
+    WallGrid grid(walls, MakeBounds(200, 200));
+
+    REQUIRE(grid.WallCount() == walls.size());
+    REQUIRE(grid.CellsX() > 1);
+    size_t i{0};
+    for (const Wall& wall : walls) {
+      REQUIRE(grid.GetWalls()[i] == wall);
+      ++i;
+    }
+  }
+
+  SECTION("Wall outside of room") {
+    std::set<Wall> walls{Wall({10, 10}, {20, 10}), Wall({90, 50}, {120, 50})};
+    WallGrid grid(walls, MakeBounds(100, 100));
+    REQUIRE_FALSE(grid.WallsInsideRoom());
+
+    // Exit distance is ignored, as the outer wall is past the room edge
+    HitPackage package;
+    grid.AddWallHits({50, 50}, {1, 0}, 1000, 50, package);
+    REQUIRE(package.HitCount() == 1);
+    REQUIRE(package.begin()->hit_distance_ == Approx(40));
+  }
+}
+
+TEST_CASE("WallGrid matches every wall hit") {
+  std::mt19937 generator(11);
+  std::set<Wall> walls{MakeWalls(generator, 2 * WallGrid::kMinGridWalls, 20)};
+  WallGrid grid(walls, MakeBounds(200, 200));
+  REQUIRE(grid.CellsX() > 1);
+  const std::vector<Wall>& ordered_walls{grid.GetWalls()};
+
+  std::uniform_real_distribution<float> coordinate(0, 200);
+  std::uniform_real_distribution<float> angle(0, 6.2831853f);
+
+  SECTION("Random rays") {
+    for (size_t i = 0; i < 2000; ++i) {
+      float theta{angle(generator)};
+      glm::vec2 pos(coordinate(generator), coordinate(generator));
+      glm::vec2 dir(std::cos(theta), std::sin(theta));
+      RequireSameHits(ordered_walls, grid, pos, dir, 150, ExitDistance(pos, dir, 200, 200));
+      RequireSameHits(ordered_walls, grid, pos, dir * 3.f, 1000, std::numeric_limits<float>::infinity());
+    }
+  }
+
+  SECTION("Rays from walls and along walls") {
+    for (const Wall& wall : ordered_walls) {
+      float theta{angle(generator)};
+      glm::vec2 dir(std::cos(theta), std::sin(theta));
+      RequireSameHits(ordered_walls, grid, wall.GetHead(), dir, 1000, ExitDistance(wall.GetHead(), dir, 200, 200));
+      RequireSameHits(ordered_walls, grid, wall.GetTail(), wall.GetHead() - wall.GetTail(), 1000,
+                      std::numeric_limits<float>::infinity());
+    }
+  }
+
+  SECTION("Axis aligned rays on the room edge") {
+    for (float along = 0; along <= 200; along += 12.5f) {
+      RequireSameHits(ordered_walls, grid, {0, along}, {1, 0}, 1000, 200);
+      RequireSameHits(ordered_walls, grid, {along, 200}, {0, -1}, 1000, 200);
+      RequireSameHits(ordered_walls, grid, {0, along}, {0, 1}, 1000, 200 - along);
+    }
+  }
+
+  SECTION("Degenerate rays") {
+    RequireSameHits(ordered_walls, grid, {50, 50}, {0, 0}, 1000, 0);
+    RequireSameHits(ordered_walls, grid, {-50, 300}, {1, -1}, 1000, std::numeric_limits<float>::infinity());
+  }
+}
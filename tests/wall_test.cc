@@ -6,6 +6,9 @@
 
 #include <catch2/catch.hpp>
 
+#include <iostream>
+#include <set>
+
 using namespace room_explorer;
 
 TEST_CASE("Sanity Check Wall") {
@@ -423,4 +426,46 @@ TEST_CASE("Hit") {
       }
     }
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Hit agrees with Distance and Texture Index") {
+  Wall wall(glm::vec2(0, 1), glm::vec2(1, 0));
+  Wall point_wall(glm::vec2(1, 1), glm::vec2(1, 1));
+
+  auto check = [](const Wall& wall, const glm::vec2& pos, const glm::vec2& dir) {
+    Hit hit = wall.GetWallHit(pos, dir);
+    float distance{wall.Distance(pos, dir)};
+
+    REQUIRE(hit.IsNoHit() == (distance == -1));
+    if (!hit.IsNoHit()) {
+      REQUIRE(FloatApproximation(hit.hit_distance_, distance));
+      REQUIRE(FloatApproximation(hit.texture_index_, wall.TextureIndex(pos, dir)));
+    }
+  };
+
+  SECTION("In-Line") {
+    check(wall, glm::vec2(-1, 2), glm::vec2(1, -1)); // Towards head
+    check(wall, glm::vec2(2, -1), glm::vec2(-1, 1)); // Towards tail
+    check(wall, glm::vec2(2, -1), glm::vec2(1, -1)); // Away
+    check(wall, glm::vec2(.25f, .75f), glm::vec2(-1, 1)); // On wall, along towards head
+    check(wall, glm::vec2(.25f, .75f), glm::vec2(1, -1)); // On wall, along towards tail
+  }
+  SECTION("Collinear, not along") {
+    check(wall, glm::vec2(-1, 2), glm::vec2(1, 0));
+    check(wall, glm::vec2(.25f, .75f), glm::vec2(0, 1));
+  }
+  SECTION("Parallel, not collinear") {
+    check(wall, glm::vec2(0, 0), glm::vec2(1, -1));
+  }
+  SECTION("Point wall") {
+    check(point_wall, glm::vec2(1, 1), glm::vec2(1, 0));
+    check(point_wall, glm::vec2(0, 0), glm::vec2(1, 1));
+    check(point_wall, glm::vec2(0, 0), glm::vec2(-1, -1));
+    check(point_wall, glm::vec2(0, 0), glm::vec2(1, 0));
+  }
+  SECTION("End-points") {
+    check(wall, glm::vec2(0, 0), glm::vec2(0, 1));
+    check(wall, glm::vec2(0, 0), glm::vec2(1, 0));
+    check(wall, glm::vec2(0, 1), glm::vec2(-1, 0));
+    check(wall, glm::vec2(1, 0), glm::vec2(0, -1));
+  }
+}